@@ -23,12 +23,14 @@
 
 #include "TypeSystem.h"
 #include "Tools.h"
+#include "NandCheckpoint.h"
 #include "ParamManager.h"
 #include "IoCompletion.h"
 
 #include "Plane.h"
 #include "Die.h"
 #include "NandLogger.h"
+#include <memory.h>
 
 #define COMMAND_LETCH_TIME                 (NFS_GET_PARAM(ITV_tWP) +\
                                              NFS_GET_PARAM(ITV_tDS) +\
@@ -37,16 +39,34 @@
 #define ADDRESS_LETCH_TIME(_nNumsAccess)   ((NFS_GET_PARAM(ITV_tCS) - NFS_GET_PARAM(ITV_tDS)) +\
                                              (NFS_GET_PARAM(ITV_tDS) + NFS_GET_PARAM(ITV_tDH)) * _nNumsAccess)
 
-#define DATA_OUT_TIME(_nNumsAccess)        (NFS_GET_PARAM(ITV_tRR) +\
-                                             NFS_GET_PARAM(ITV_tRC) * _nNumsAccess)
+// DDR interfaces (NV-DDR, NV-DDR2/3 and Toggle) transfer data on both edges of DQS at SYS.DATA_RATE (MT/s) 
+// with preamble and postamble, whereas command and address cycles are still latched with SDR timings.
+#define DDR_INTERFACE                      (NFS_GET_PARAM(ISV_INTERFACE_MODE) != NAND_IF_SDR)
 
-#define DATA_IN_TIME(_nNumsAccess)         (NFS_GET_PARAM(ITV_tWC)*_nNumsAccess)
+#define DDR_TRANSFER_TIME(_nNumsAccess)    (((UINT64)(_nNumsAccess) * 1000 + NFS_GET_PARAM(ISV_DATA_RATE) - 1) / NFS_GET_PARAM(ISV_DATA_RATE))
+
+#define DATA_OUT_TIME(_nNumsAccess)        ((DDR_INTERFACE) ?\
+                                            (NFS_GET_PARAM(ITV_tRR) +\
+                                             NFS_GET_PARAM(ITV_tRPRE) + DDR_TRANSFER_TIME(_nNumsAccess) + NFS_GET_PARAM(ITV_tRPST)) :\
+                                            (NFS_GET_PARAM(ITV_tRR) +\
+                                             NFS_GET_PARAM(ITV_tRC) * _nNumsAccess))
+
+#define DATA_IN_TIME(_nNumsAccess)         ((DDR_INTERFACE) ?\
+                                            (NFS_GET_PARAM(ITV_tWPRE) + DDR_TRANSFER_TIME(_nNumsAccess) + NFS_GET_PARAM(ITV_tWPST)) :\
+                                            (NFS_GET_PARAM(ITV_tWC)*_nNumsAccess))
 
 #define READ_STATUS_TIME                   (NFS_GET_PARAM(ITV_tDS) +\
                                              NFS_GET_PARAM(ITV_tWHR) +\
                                              NFS_GET_PARAM(ITV_tREA) +\
                                              NFS_GET_PARAM(ITV_tRC))
 
+// ONFI multi-LUN: Read Status Enhanced (78h with row address) selects the die again on the shared bus.
+#define LUN_SELECT_TIME                    (COMMAND_LETCH_TIME + ADDRESS_LETCH_TIME(3) + READ_STATUS_TIME)
+
+#define NAND_CMD_IS_RANDOM_DATA_IN(_nCmd)  (_nCmd == NAND_CMD_PROG_RANDOM || _nCmd == NAND_CMD_PROG_RANDOM_FIN ||\
+                                            _nCmd == NAND_CMD_PROG_MULTIPLANE_RANDOM || _nCmd == NAND_CMD_PROG_MULTIPLANE_RANDOM_DUMMY ||\
+                                            _nCmd == NAND_CMD_PROG_MULTIPLANE_FIN_RANDOM)
+
 #define NAND_PLANE_WRAPAROUND(_nCol, _stDevConfig)        (_nCol % _nNumsPlane)
 
 namespace NANDFlashSim {
@@ -56,7 +76,8 @@ Die::Die(UINT64 nSystemClock, NandDeviceConfig &devConfig ) :
         _vctAccumulatedTime(NAND_FSM_MAX,0),
         _vctColRegister(devConfig._nNumsPlane, NULL_SIG(UINT16)),
         _vctRowRegister(devConfig._nNumsPlane, NULL_SIG(UINT32)),
-        _vctRandomBytes(devConfig._nNumsPlane, 0)
+        _vctRandomBytes(devConfig._nNumsPlane, 0),
+        _vctRandomDataIn(devConfig._nNumsPlane, false)
 {
     _stDevConfig    = devConfig;
     // build multi-plane
@@ -64,7 +85,7 @@ Die::Die(UINT64 nSystemClock, NandDeviceConfig &devConfig ) :
 
     for(UINT8 nIdx = 0; nIdx < devConfig._nNumsPlane; ++nIdx)
     {
-        boost::shared_array<UINT8> sharedCacheReg(new UINT8[_stDevConfig._nPgSize]);
+        boost::shared_array<UINT8> sharedCacheReg(new UINT8[NAND_FULL_PAGE_SIZE(_stDevConfig)]);
         _vctpCacheRegister[nIdx]    = sharedCacheReg;
 #ifndef WITHOUT_PLANE_STATS
         _vctPlanes.push_back(Plane(devConfig));
@@ -79,6 +100,9 @@ Die::Die(UINT64 nSystemClock, NandDeviceConfig &devConfig ) :
 
     _eUpdatedState = NAND_FSM_MAX;
     _nUpdatedAccTime = 0;
+    _nStatReadRetry  = 0;
+
+    loadPageTypeTable();
     
     SoftReset();
 }
@@ -130,6 +154,11 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                     _bNeedReset = true;
                     NV_ERROR("Row address for read(multplane mode) has invalid (there is no plane selection in row address)");
                 }
+                if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY && _vctRowRegister[nPlane] != stPacket._nRow)
+                {
+                    _bNeedReset = true;
+                    NV_ERROR("Row address for cache read(multplane mode) is not the page in cache register");
+                }
                 _vctRowRegister[nPlane]   = stPacket._nRow;
             }
 
@@ -152,7 +181,8 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             {
                 _nLastAleBytes      = 3;
             }
-            else if (_nCommandRegister == NAND_CMD_READ_RANDOM)
+            else if (_nCommandRegister == NAND_CMD_READ_RANDOM ||
+                     (NAND_CMD_IS_RANDOM_DATA_IN(_nCommandRegister) && _vctRandomDataIn[nPlane] == true))
             {
                 // random i/o employs open row address.            
                _nLastAleBytes       = 2;
@@ -197,6 +227,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             case NAND_CMD_READ_MULTIPLANE :
             case NAND_CMD_READ_MULTIPLANE_INIT :
             case NAND_CMD_READ_MULTIPLANE_INIT_FIN :
+            case NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY :
             case NAND_CMD_READ_INTERNAL :
             case NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN :
                 nNextStage  = NAND_STAGE_CLE;
@@ -222,7 +253,15 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
         {
             _nCommandRegister                   = stPacket._nCommand;
             _nNextActivate                      = COMMAND_LETCH_TIME;
-            
+
+            if(_nCommandRegister != NAND_CMD_READ_MULTIPLANE_CACHE &&
+               _nCommandRegister != NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY &&
+               _nCommandRegister != NAND_CMD_READ_MULTIPLANE_CACHE_CONF)
+            {
+                // any other command ends the sequential cache read (multi-plane mode).
+                _nArrayBusyTime                 = NULL_SIG(UINT64);
+            }
+
             _eUpdatedState = NAND_FSM_CLE;
             _vctAccumulatedTime[_eUpdatedState] += _nNextActivate; 
             _nUpdatedAccTime = _vctAccumulatedTime[_eUpdatedState];
@@ -230,6 +269,20 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             _bLeakDc                            = false;
             _bNandBusy                          = false;
 
+            if(_nProgBusyTime != NULL_SIG(UINT64) &&
+               _nCommandRegister != NAND_CMD_PROG_CACHE && _nCommandRegister != NAND_CMD_PROG_CACHE_CONF &&
+               _nCommandRegister != NAND_CMD_PROG_MULTIPLANE && _nCommandRegister != NAND_CMD_PROG_MULTIPLANE_CONF &&
+               _nCommandRegister != NAND_CMD_PROG_MULTIPLANE_CACHE && _nCommandRegister != NAND_CMD_PROG_MULTIPLANE_CACHE_CONF &&
+               _nCommandRegister != NAND_CMD_PROG_MULTIPLANE_CACHE_FIN && _nCommandRegister != NAND_CMD_PROG_MULTIPLANE_CACHE_FIN_CONF)
+            {
+                // the array is still programming the last page of cache program, so that the commands 
+                // except loading the cache registers wait for it.
+                _nNextActivate                  += _nProgBusyTime;
+                _vctAccumulatedTime[NAND_FSM_TIN] += _nProgBusyTime;
+                _bNandBusy                      = (_nProgBusyTime != 0);
+                _nProgBusyTime                  = NULL_SIG(UINT64);
+            }
+
             switch(_nCommandRegister)
             {
 
@@ -252,6 +305,12 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             case NAND_CMD_PROG_MULTIPLANE_RANDOM :
             case NAND_CMD_PROG_INTERNAL_MULTIPLANE :
             case NAND_CMD_PROG_MULTIPLANE_RANDOM_DUMMY :
+                if(NAND_CMD_IS_RANDOM_DATA_IN(_nCommandRegister) && _vctRandomDataIn[nPlane] == true)
+                {
+                    // change write column (85h) doesn't address another plane.
+                    nNextStage      = NAND_STAGE_ALE;
+                    break;
+                }
                 if(_nNxCommandCnt == NULL_SIG(UINT8))
                 {
                     _nNxCommandCnt = 0;
@@ -312,6 +371,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             case NAND_CMD_READ_MULTIPLANE :
             case NAND_CMD_READ_MULTIPLANE_INIT :
             case NAND_CMD_READ_MULTIPLANE_INIT_FIN :
+            case NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY :
             case NAND_CMD_READ_INTERNAL_MULTIPLANE :
             case NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN :
             case NAND_CMD_READ_RANDOM :
@@ -322,6 +382,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 break;
                 // confirmation command class
             case NAND_CMD_READ_MULTIPLANE_CONF :
+            case NAND_CMD_READ_MULTIPLANE_CACHE_CONF :
             case NAND_CMD_READ_RANDOM_CONF:
                 nNextStage          = NAND_STAGE_TOR;
                 break;
@@ -337,7 +398,6 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             case NAND_CMD_READ_INTERNAL_CONF:
             case NAND_CMD_READ_MULTIPLANE_INIT_FIN_CONF :
             case NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN_CONF:
-            case NAND_CMD_READ_MULTIPLANE_CACHE_CONF :
                 nNextStage                          = NAND_STAGE_TON;
                 break;
             case NAND_CMD_READ_CACHE :
@@ -352,17 +412,28 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                     assert(_vctRowRegister[nPlane] != NULL_SIG(UINT32));
                     // cache read right after normal read doesn't have address.
                     _vctColRegister[nPlane] = 0;
-                    _vctRandomBytes[nPlane] = _stDevConfig._nPgSize;
+                    _vctRandomBytes[nPlane] = NAND_FULL_PAGE_SIZE(_stDevConfig);
                 }
                 nNextStage      = NAND_STAGE_TON;
                 break;
             case NAND_CMD_READ_MULTIPLANE_CACHE :
-                _nNextActivate                      += nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tDCBSYR1);
-                _vctAccumulatedTime[NAND_FSM_CLE]   += nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tDCBSYR1); 
-
-                _eUpdatedState = NAND_FSM_CLE;
-                _nUpdatedAccTime = _vctAccumulatedTime[_eUpdatedState];
+                {
+                    // sequential cache read (31h) works on the rows which multi-plane read has addressed.
+                    bool bAddressed = false;
+                    for(UINT8 nPlaneIdx = 0; nPlaneIdx < _stDevConfig._nNumsPlane; nPlaneIdx++)
+                    {
+                        bAddressed |= (_vctRowRegister[nPlaneIdx] != NULL_SIG(UINT32));
+                        _vctColRegister[nPlaneIdx] = 0;
+                        _vctRandomBytes[nPlaneIdx] = NAND_FULL_PAGE_SIZE(_stDevConfig);
+                    }
 
+                    if(bAddressed == false || (_nCurrentStage != NAND_STAGE_TON && _nCurrentStage != NAND_STAGE_TOR))
+                    {
+                        // cache read should follow multi-plane read or the previous cache read
+                        _bNeedReset = true;
+                        NV_ERROR("NAND command chain is massed up");
+                    }
+                }
                 nNextStage                          = NAND_STAGE_TON;
                 break;
             //////////////////////////////////////////////////////////////////////////
@@ -439,11 +510,25 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             {
                 assert(stPacket._nRandomBytes != NULL_SIG(UINT32));
 #ifndef     NO_STORAGE
+                UINT8   nPlaneIdx       = NAND_PLN_PARSE_REGISTER(_vctRowRegister[nPlane]);
+                UINT8   *pCacheReg      = _vctpCacheRegister[nPlaneIdx].get();
+#ifndef WITHOUT_PLANE_STATS
+                // the previous program of this plane may still be draining the register.
+                _vctPlanes[nPlaneIdx].WaitIo();
+#endif
+                if(_nCommandRegister == NAND_CMD_PROG_PAGE || _nCommandRegister == NAND_CMD_PROG_CACHE ||
+                   _nCommandRegister == NAND_CMD_PROG_MULTIPLANE || _nCommandRegister == NAND_CMD_PROG_MULTIPLANE_FIN ||
+                   _nCommandRegister == NAND_CMD_PROG_MULTIPLANE_CACHE || _nCommandRegister == NAND_CMD_PROG_MULTIPLANE_CACHE_FIN ||
+                   (NAND_CMD_IS_RANDOM_DATA_IN(_nCommandRegister) && _vctRandomDataIn[nPlane] == false))
+                {
+                    // serial data input (80h) clears the page register, so that the bytes 
+                    // (e.g., spare area) which host doesn't transfer are programmed as erased.
+                    memset(pCacheReg, 0x0, NAND_FULL_PAGE_SIZE(_stDevConfig));
+                }
+
                 if(stPacket._pData != NULL)
                 {
                     assert(_vctColRegister[nPlane]    != NULL_SIG(UINT16));
-                    UINT8   nPlaneIdx       = (0xF << BITS_NAND_PAGE_ADDR) & _vctRowRegister[nPlane];
-                    UINT8   *pCacheReg      = _vctpCacheRegister[nPlaneIdx].get();
                     memcpy(pCacheReg + _vctColRegister[nPlane], stPacket._pData + _vctColRegister[nPlane], _vctRandomBytes[nPlane]);
                 }
 #endif
@@ -452,9 +537,10 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 _vctPowerTime[NAND_DC_PROG]     += _nNextActivate;
                 _bStanbyDc                      = false;
 
-                if (_nCommandRegister == NAND_CMD_PROG_RANDOM || _nCommandRegister == NAND_CMD_PROG_RANDOM_FIN)
+                if (NAND_CMD_IS_RANDOM_DATA_IN(_nCommandRegister))
                 {
                     _nNextActivate  += NFS_GET_PARAM(ITV_tADL) - NFS_GET_PARAM(ITV_tWC);
+                    _vctRandomDataIn[nPlane] = true;
                 }
                 
                 _eUpdatedState = NAND_FSM_TIR;
@@ -500,32 +586,25 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
 #endif
                 // program
 #ifndef WITHOUT_PLANE_STATS
-                _vctPlanes[nPlane].Write(_vctColRegister[nPlane], _vctRowRegister[nPlane], pCacheReg);
+                // the page assembled by random data input is programmed from the first column.
+                _vctPlanes[nPlane].Write((_vctRandomDataIn[nPlane]) ? 0 : _vctColRegister[nPlane], _vctRowRegister[nPlane], pCacheReg);
+                _vctPlanes[nPlane].ProgramTime(NAND_PBN_PARSE_REGISTER(_vctRowRegister[nPlane]), stPacket._nArrivalCycle);
 #endif
                 _vctPowerTime[NAND_DC_PROG]     += nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tPROG);
 
                 _bStanbyDc                      = false;
                 if(nStage == NAND_STAGE_TIN_CACHE)
                 {
-                    // NANDFlashSim doesn't use tCBSY typical value.
-                    // Instead, it doesn't deduct tPROG time for the page before the last page.
-
-                    _nNextActivate  = nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tPROG);
-                    //_nNextActivate  = nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tCBSY);
-
-                    // In cache mode write operation, NAND bus is enable to TIR during TIN.
-                    // Thus, TIR and TIN can be overlapped.
-                    UINT32 nTirandLatchTime = DATA_IN_TIME(_vctRandomBytes[nPlane] / (_stDevConfig._nNumsIoPins / 8)) + COMMAND_LETCH_TIME + ADDRESS_LETCH_TIME(5);
-                    if(_nNextActivate > nTirandLatchTime)
-                    {
-                        _nNextActivate -= nTirandLatchTime;
-                    }
-                    else
-                    {
-                        _nNextActivate = nTirandLatchTime - _nNextActivate;
-                    }
- 
-                    nNextStage      = NAND_STAGE_IDLE;
+                    // Cache program: the data register programs the previous page while the cache register 
+                    // takes the next page. The page moves to the data register when the previous program 
+                    // completes, and the die is busy until then (tCBSY).
+                    // The maximum tCBSY of datasheets includes this wait, so that the typical value is 
+                    // used for the register transfer.
+                    UINT64 nRemainTime  = (_nProgBusyTime != NULL_SIG(UINT64)) ? _nProgBusyTime : 0;
+                    UINT64 nTransTime   = NFS_GET_PARAM(IMV_tCBSY);
+                    _nNextActivate      = (nRemainTime > nTransTime) ? nRemainTime : nTransTime;
+                    _nProgBusyTime      = _nNextActivate + nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tPROG);
+                    nNextStage          = NAND_STAGE_IDLE;
                 }
                 else if (nStage == NAND_STAGE_TIN_DUMMY)
                 {
@@ -534,9 +613,10 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 }
                 else if(nStage   == NAND_STAGE_TIN_TAIL)
                 {
-                    assert(_vctRandomBytes[nPlane] != NULL_SIG(UINT32));
-                    assert(_nLastAleBytes  != NULL_SIG(UINT8));
-                    _nNextActivate  = /*nandArrayTimeParam(_vctRowRegister[nPlane]-1, ITV_tPROG) +*/ nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tPROG) - COMMAND_LETCH_TIME - ADDRESS_LETCH_TIME(_nLastAleBytes) - DATA_IN_TIME(_vctRandomBytes[nPlane]);
+                    // the last page of cache program waits for the previous page, and then it is programmed.
+                    UINT64 nRemainTime  = (_nProgBusyTime != NULL_SIG(UINT64)) ? _nProgBusyTime : 0;
+                    _nNextActivate  = nRemainTime + nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tPROG);
+                    _nProgBusyTime  = NULL_SIG(UINT64);
                     _nLastAleBytes  = NULL_SIG(UINT8);
                     nNextStage      = NAND_STAGE_READ_STATUS;
                 }
@@ -552,6 +632,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
 
                 // reset DATA IN CYCLE
                 _vctRandomBytes[nPlane]             = NULL_SIG(UINT32);
+                _vctRandomDataIn[nPlane]            = false;
             }
             else
             {
@@ -564,6 +645,12 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             _bNandBusy      = false;
 
             _nNextActivate  = READ_STATUS_TIME;
+            if(_bLunReselect == true)
+            {
+                // 78h and row address instead of 70h
+                _nNextActivate  += ADDRESS_LETCH_TIME(3);
+                _bLunReselect   = false;
+            }
 
             _eUpdatedState = NAND_FSM_TOR;
             _vctAccumulatedTime[_eUpdatedState] += _nNextActivate; 
@@ -604,7 +691,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             }
 
             // PHYSICAL READ
-            if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_INIT_FIN_CONF)
+            if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_INIT_FIN_CONF || _nCommandRegister == NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN_CONF)
             {
                 // in the multi-plane mode, NANDFlashSim read data from NAND at delta time.
                 for(UINT16 nPlaneIdx = 0; nPlaneIdx < _stDevConfig._nNumsPlane; nPlaneIdx++)
@@ -625,6 +712,41 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 }
 
             }
+            else if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_CACHE)
+            {
+                // The pages which multi-plane read has sensed are already in the registers at the first cache read.
+                // After that, each cache read brings the next pages which have been sensed in background.
+                if(_nArrayBusyTime != NULL_SIG(UINT64))
+                {
+                    for(UINT16 nPlaneIdx = 0; nPlaneIdx < _stDevConfig._nNumsPlane; nPlaneIdx++)
+                    {
+                        if(_vctRowRegister[nPlaneIdx] == NULL_SIG(UINT32))
+                        {
+                            continue;
+                        }
+
+                        if ((UINT32)NAND_PGO_PARSE_REGISTER(_vctRowRegister[nPlaneIdx]) + 1 >= _stDevConfig._nNumsPgPerBlk)
+                        {
+                            _bNeedReset = true;
+                            NV_ERROR("cache read is allowed only if ascending order read in a block");
+
+                            _nCurrentStage     = nStage;
+                            _nExpectedStage = NAND_STAGE_READ_STATUS;
+                            return _nExpectedStage ;
+                        }
+
+                        _vctRowRegister[nPlaneIdx]++;
+#ifndef     NO_STORAGE
+                        pCacheReg   = _vctpCacheRegister[nPlaneIdx].get();
+#else
+                        pCacheReg   = NULL;
+#endif            
+#ifndef WITHOUT_PLANE_STATS
+                        _vctPlanes[nPlaneIdx].Read(0 , _vctRowRegister[nPlaneIdx], pCacheReg);
+#endif
+                    }
+                }
+            }
             else if(_nCommandRegister != NAND_CMD_READ_CACHE_ADDR_INIT_CONF)
             {
                 // In cache read mode, reading data from virtual blocks is executed in DCBSYR.
@@ -640,8 +762,14 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
 #endif
             }
             
+            // array read time depends on the page type of the row (planes of multi-plane read share a page offset).
+            UINT64 nReadTime                = nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tR);
+            // worn, aged or disturbed pages need read-retries and ECC decoding before the data can go out.
+            UINT64 nRetryTime               = readRetryTime(nPlane, stPacket._nArrivalCycle, nReadTime);
+            nReadTime                       += nRetryTime;
+
             // Even though read cycle for cache, nx can be overlapped, there is no difference on power cycles for each plane.
-            _vctPowerTime[NAND_DC_READ]     += NFS_GET_PARAM(ITV_tR);
+            _vctPowerTime[NAND_DC_READ]     += nReadTime;
             _bStanbyDc                      = false;
             if(_nCommandRegister    == NAND_CMD_READ_CACHE )
             {
@@ -649,18 +777,18 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 // NANDFlashSim leverages typical stat timing param for register access latency
                 if(_bCacheNohideTon == true)
                 {
-                    _nNextActivate      = NFS_GET_PARAM(ITV_tR);
+                    _nNextActivate      = nReadTime;
                 }
                 else
                 {
                     if(_bCacheLoadFirst == true)
                     {
-                        _nNextActivate      = NFS_GET_PARAM(IMV_tDCBSYR1) + NFS_GET_PARAM(ITV_tRR);
+                        _nNextActivate      = NFS_GET_PARAM(IMV_tDCBSYR1) + NFS_GET_PARAM(ITV_tRR) + nRetryTime;
                         _bCacheLoadFirst    = false;
                     }
                     else
                     {
-                        _nNextActivate      = NFS_GET_PARAM(IMV_tDCBSYR2) + NFS_GET_PARAM(ITV_tRR);
+                        _nNextActivate      = NFS_GET_PARAM(IMV_tDCBSYR2) + NFS_GET_PARAM(ITV_tRR) + nRetryTime;
                     }
                 }
 
@@ -669,9 +797,26 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
                 UINT16  nPpo = NAND_PGO_PARSE_REGISTER(_vctRowRegister[nPlane]);
                 _vctRowRegister[nPlane]++;
             }
+            else if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_CACHE)
+            {
+                // data movement to the cache registers hides the array read time of the next pages
+                // unless the previous data out is shorter than the array read.
+                _nNextActivate      = nandArrayTimeParam(_vctRowRegister[nPlane], ITV_tDCBSYR1);
+                if(_nArrayBusyTime != NULL_SIG(UINT64) && _nArrayBusyTime > _nNextActivate)
+                {
+                    _nNextActivate  = _nArrayBusyTime;
+                }
+                _nNextActivate      += nRetryTime;
+                UINT32 nNextRow     = _vctRowRegister[nPlane];
+                if((UINT32)NAND_PGO_PARSE_REGISTER(nNextRow) + 1 < _stDevConfig._nNumsPgPerBlk)
+                {
+                    nNextRow++;
+                }
+                _nArrayBusyTime     = _nNextActivate + nandArrayTimeParam(nNextRow, ITV_tR);
+            }
             else
             {
-                _nNextActivate      = NFS_GET_PARAM(ITV_tR);
+                _nNextActivate      = nReadTime;
             }
 
             _eUpdatedState = NAND_FSM_TON;
@@ -688,6 +833,7 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
 
             }
             else if(_nCommandRegister == NAND_CMD_READ_MULTIPLANE_INIT_FIN_CONF ||
+               _nCommandRegister == NAND_CMD_READ_MULTIPLANE_CACHE ||
                _nCommandRegister == NAND_CMD_READ_INTERNAL_CONF ||
                _nCommandRegister == NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN_CONF)
             {
@@ -709,15 +855,25 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
             {
                 assert(_vctColRegister[nPlane] != NULL_SIG(UINT16));
                 assert(_vctRandomBytes[nPlane] != NULL_SIG(UINT32));
-                assert(_vctRandomBytes[nPlane] + _vctColRegister[nPlane] <= _stDevConfig._nPgSize);
+                assert(_vctRandomBytes[nPlane] + _vctColRegister[nPlane] <= NAND_FULL_PAGE_SIZE(_stDevConfig));
 #ifndef     NO_STORAGE
                 if(stPacket._pData != NULL)
                 {
                     UINT8   *pCacheReg  = _vctpCacheRegister[nPlane].get();
+#ifndef WITHOUT_PLANE_STATS
+                    // data has been fetched in background during the array time.
+                    _vctPlanes[nPlane].WaitIo();
+#endif
                     memcpy(stPacket._pData + _vctColRegister[nPlane], pCacheReg + _vctColRegister[nPlane], sizeof(UINT8) * _vctRandomBytes[nPlane]);
                 }
 #endif
                 _nNextActivate = DATA_OUT_TIME(_vctRandomBytes[nPlane] / (_stDevConfig._nNumsIoPins / 8));
+                if(_bLunReselect == true)
+                {
+                    // another die has driven the bus, so 78h and 00h are needed before data out.
+                    _nNextActivate  += LUN_SELECT_TIME + COMMAND_LETCH_TIME;
+                    _bLunReselect   = false;
+                }
 
                 _eUpdatedState = NAND_FSM_TOR;
                 _vctAccumulatedTime[_eUpdatedState] += _nNextActivate; 
@@ -772,6 +928,8 @@ NAND_STAGE Die::TransitStage(NAND_STAGE nStage, NandStagePacket &stPacket)
 void Die::Update( UINT64 nTime )
 {
     _nCurrentTime += nTime;
+
+    UpdateArray(nTime);
     
     // update cycle
     if(_nNextActivate >= nTime)
@@ -796,6 +954,148 @@ void Die::Update( UINT64 nTime )
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    UpdateArray
+// FullName:  Die::UpdateArray
+// Access:    public 
+// Returns:   void
+// Parameter: UINT64 nTime
+//
+// Descriptions -
+// Array operations in background (cache read and cache program) progress even 
+// while the die waits for the next command. The logical unit gives such idle 
+// time to this, and Update does the same for the busy time.
+//////////////////////////////////////////////////////////////////////////////
+void Die::UpdateArray( UINT64 nTime )
+{
+    if(_nArrayBusyTime != NULL_SIG(UINT64))
+    {
+        _nArrayBusyTime = (_nArrayBusyTime > nTime) ? _nArrayBusyTime - nTime : 0;
+    }
+
+    if(_nProgBusyTime != NULL_SIG(UINT64))
+    {
+        _nProgBusyTime  = (_nProgBusyTime > nTime) ? _nProgBusyTime - nTime : 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    ArrayCurrent
+// FullName:  Die::ArrayCurrent
+// Access:    public 
+// Returns:   UINT32
+//
+// Descriptions -
+// The current (ICC1, ICC2 or ICC3) which the array of this die draws now, 
+// including the array operations in background. 0 if the array is idle.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 Die::ArrayCurrent()
+{
+    if(_nNextActivate != 0)
+    {
+        if(_nCurrentStage == NAND_STAGE_TON)
+        {
+            return NFS_GET_PARAM(IDV_ICC1);
+        }
+        if(_nCurrentStage == NAND_STAGE_TIN || _nCurrentStage == NAND_STAGE_TIN_CACHE || _nCurrentStage == NAND_STAGE_TIN_TAIL)
+        {
+            return NFS_GET_PARAM(IDV_ICC2);
+        }
+        if(_nCurrentStage == NAND_STAGE_CLE)
+        {
+            if(_nCommandRegister == NAND_CMD_BLOCK_ERASE_CONF || _nCommandRegister == NAND_CMD_BLOCK_MULTIPLANE_ERASE_FIN_CONF)
+            {
+                return NFS_GET_PARAM(IDV_ICC3);
+            }
+            if(_bNandBusy == true)
+            {
+                // the command waits for the page program of cache program.
+                return NFS_GET_PARAM(IDV_ICC2);
+            }
+        }
+    }
+
+    if(_nProgBusyTime != NULL_SIG(UINT64) && _nProgBusyTime != 0)
+    {
+        return NFS_GET_PARAM(IDV_ICC2);
+    }
+    if(_nArrayBusyTime != NULL_SIG(UINT64) && _nArrayBusyTime != 0)
+    {
+        return NFS_GET_PARAM(IDV_ICC1);
+    }
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    ArrayBusyTime
+// FullName:  Die::ArrayBusyTime
+// Access:    public 
+// Returns:   UINT64
+//
+// Descriptions -
+// The time after which the current of the array may change (see ArrayCurrent).
+// 0 if the array is idle.
+//////////////////////////////////////////////////////////////////////////////
+UINT64 Die::ArrayBusyTime()
+{
+    if(ArrayCurrent() == 0)
+    {
+        return 0;
+    }
+
+    UINT64 nTime = (_nNextActivate != 0) ? _nNextActivate : NULL_SIG(UINT64);
+    if(_nProgBusyTime != NULL_SIG(UINT64) && _nProgBusyTime != 0 && _nProgBusyTime < nTime)
+    {
+        nTime = _nProgBusyTime;
+    }
+    if(_nArrayBusyTime != NULL_SIG(UINT64) && _nArrayBusyTime != 0 && _nArrayBusyTime < nTime)
+    {
+        nTime = _nArrayBusyTime;
+    }
+
+    return nTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    ArrayCurrentDemand
+// FullName:  Die::ArrayCurrentDemand
+// Access:    public 
+// Returns:   UINT32
+// Parameter: NAND_STAGE nStage
+// Parameter: NAND_COMMAND nCommand
+//
+// Descriptions -
+// The current which the array of this die will draw if it transits to nStage
+// with nCommand. 0 if the stage doesn't start an array operation.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 Die::ArrayCurrentDemand(NAND_STAGE nStage, NAND_COMMAND nCommand)
+{
+    switch(nStage)
+    {
+    case NAND_STAGE_TON :
+        return NFS_GET_PARAM(IDV_ICC1);
+    case NAND_STAGE_TIN :
+    case NAND_STAGE_TIN_CACHE :
+    case NAND_STAGE_TIN_TAIL :
+        return NFS_GET_PARAM(IDV_ICC2);
+    case NAND_STAGE_CLE :
+        if(nCommand == NAND_CMD_BLOCK_ERASE_CONF || nCommand == NAND_CMD_BLOCK_MULTIPLANE_ERASE_FIN_CONF)
+        {
+            return NFS_GET_PARAM(IDV_ICC3);
+        }
+        break;
+    default :
+        break;
+    }
+
+    return 0;
+}
+
 void Die::Poweron()
 {
     _bPowerSupply   = true;
@@ -808,6 +1108,7 @@ void Die::resetRegisters()
         _vctColRegister[nIter]       = NULL_SIG(UINT16);
         _vctRowRegister[nIter]       = NULL_SIG(UINT32);
         _vctRandomBytes[nIter]       = NULL_SIG(UINT32);
+        _vctRandomDataIn[nIter]      = false;
     }
     _nCommandRegister   = NAND_CMD_NOT_DETERMINED;
 }
@@ -827,6 +1128,9 @@ void Die::SoftReset()
     _bNandBusy          = false;
     _bCacheLoadFirst    = false;
     _bCacheNohideTon    = false;
+    _nArrayBusyTime     = NULL_SIG(UINT64);
+    _nProgBusyTime      = NULL_SIG(UINT64);
+    _bLunReselect       = false;
 }
 
 UINT64 Die::GetAccumulatedFSMTime(NAND_FSM_STATE nFsmState)
@@ -870,6 +1174,34 @@ UINT64 Die::nandArrayTimeParam(UINT32 nRow, INI_DEVICE_VALUE eName)
 	}
 #endif
 
+#ifndef WITHOUT_PLANE_STATS
+    if(nRow != NULL_SIG(UINT32) && _vctPlanes[NAND_PLN_PARSE_REGISTER(nRow)].BlockMode(NAND_PBN_PARSE_REGISTER(nRow)) == NAND_BLOCK_SLC)
+    {
+        // SLC mode blocks have their own timing, which doesn't depend on the page type.
+        nTimeParam = 0;
+        switch(eName)
+        {
+        case ITV_tPROG:
+        case IMV_tPROG:
+            nTimeParam = NFS_GET_PARAM(IBV_SLC_tPROG);
+            break;
+        case ITV_tR:
+            nTimeParam = NFS_GET_PARAM(IBV_SLC_tR);
+            break;
+        case ITV_tBERS:
+        case IMV_tBERS:
+            nTimeParam = NFS_GET_PARAM(IBV_SLC_tBERS);
+            break;
+        default:
+            break;
+        }
+        if(nTimeParam != 0)
+        {
+            return nTimeParam;
+        }
+    }
+#endif
+
     if(NFS_GET_ENV(IEV_PARAM_BASED_SIMULATION) == 1)
     {
         // worst case
@@ -898,9 +1230,39 @@ UINT64 Die::nandArrayTimeParam(UINT32 nRow, INI_DEVICE_VALUE eName)
         case ITV_tDBSY:
             eName = IMV_tDBSY;
             break;
+        default:
+            break;
         }
         nTimeParam = NFS_GET_PARAM(eName);
     }
+    else if (_vctPgTypeMap.empty() == false)
+    {
+        // page type latency table (LSB, CSB, MSB, TSB) given by device ini file.
+        UINT32 nPgo = NAND_PGO_PARSE_REGISTER(nRow);
+        assert(nPgo < _vctPgTypeMap.size());
+        UINT32 nType = _vctPgTypeMap[nPgo];
+        switch(eName)
+        {
+        case ITV_tPROG:
+            if(_bOneShotProg == true && nType + 1 < _vctPgTypeProgTime.size())
+            {
+                // one-shot program: lower pages of a word line are only latched into the page buffer,
+                // and the highest page type programs all pages of the word line in a single tPROG.
+                nTimeParam = NFS_GET_PARAM(ITV_tDBSY);
+            }
+            else
+            {
+                nTimeParam = _vctPgTypeProgTime[nType];
+            }
+            break;
+        case ITV_tR:
+            nTimeParam = _vctPgTypeReadTime[nType];
+            break;
+        default:
+            nTimeParam = NFS_GET_PARAM(eName);
+            break;
+        }
+    }
     else if (NFS_GET_ENV(IEV_CMLC_STYLE_VARIATION) == 1)
     {
         UINT32 nPgo = NAND_PGO_PARSE_REGISTER(nRow);
@@ -927,6 +1289,8 @@ UINT64 Die::nandArrayTimeParam(UINT32 nRow, INI_DEVICE_VALUE eName)
             case ITV_tDBSY:
                 eName = IMV_tDBSY;
                 break;
+            default:
+                break;
             }
             nTimeParam = NFS_GET_PARAM(eName);
         }
@@ -961,6 +1325,8 @@ UINT64 Die::nandArrayTimeParam(UINT32 nRow, INI_DEVICE_VALUE eName)
             case ITV_tDBSY:
                 eName = IMV_tDBSY;
                 break;
+            default:
+                break;
             }
             nTimeParam = NFS_GET_PARAM(eName);
         }
@@ -1006,6 +1372,7 @@ void Die::HardReset(UINT32 nSystemClock, NandDeviceConfig &stDevConfig)
     {
         _vctAccumulatedTime[nIdx] = 0;
     }
+    _nStatReadRetry         = 0;
 
     for(UINT8 nIdx = 0; nIdx < _stDevConfig._nNumsPlane; ++nIdx)
     {
@@ -1017,8 +1384,377 @@ void Die::HardReset(UINT32 nSystemClock, NandDeviceConfig &stDevConfig)
 #endif
     }
 
+    loadPageTypeTable();
+
     SoftReset();
 
 }
 
-}
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Precondition
+// FullName:  Die::Precondition
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT8 nPlane
+// Parameter: UINT16 nPbn
+// Parameter: UINT32 nProgrammedPgs
+// Parameter: UINT32 nEc
+// Parameter: UINT8 * pSignature
+//
+// Descriptions -
+// Hand a block preconditioning request over to the plane without going through
+// the FSM. Without plane statistics, there is no block state to initialize.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Die::Precondition( UINT8 nPlane, UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature )
+{
+    if(nPlane >= _stDevConfig._nNumsPlane)
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+#ifndef WITHOUT_PLANE_STATS
+    return _vctPlanes[nPlane].Precondition(nPbn, nProgrammedPgs, nEc, pSignature);
+#else
+    (void)nPbn; (void)nProgrammedPgs; (void)nEc; (void)pSignature;
+    return NAND_SUCCESS;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    BlockMode
+// FullName:  Die::BlockMode
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT8 nPlane
+// Parameter: UINT16 nPbn
+// Parameter: NAND_BLOCK_MODE eMode
+//
+// Descriptions -
+// Choose the cell mode of a block (see Plane::BlockMode). Block modes are kept
+// in the plane statistics, so that all blocks are native without them.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Die::BlockMode( UINT8 nPlane, UINT16 nPbn, NAND_BLOCK_MODE eMode )
+{
+    if(nPlane >= _stDevConfig._nNumsPlane)
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+#ifndef WITHOUT_PLANE_STATS
+    return _vctPlanes[nPlane].BlockMode(nPbn, eMode);
+#else
+    (void)nPbn;
+    return (eMode == NAND_BLOCK_NATIVE) ? NAND_SUCCESS : NAND_PLANE_ERROR_BLOCK_MODE;
+#endif
+}
+
+NAND_BLOCK_MODE Die::BlockMode( UINT8 nPlane, UINT16 nPbn )
+{
+#ifndef WITHOUT_PLANE_STATS
+    return _vctPlanes[nPlane].BlockMode(nPbn);
+#else
+    (void)nPlane; (void)nPbn;
+    return NAND_BLOCK_NATIVE;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    EraseCount
+// FullName:  Die::EraseCount
+// Access:    public 
+// Returns:   UINT32
+// Parameter: UINT8 nPlane
+// Parameter: UINT16 nPbn
+//
+// Descriptions -
+// The erase count of a block. Erase counts are kept in the plane statistics,
+// so that all blocks look unworn without them.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 Die::EraseCount( UINT8 nPlane, UINT16 nPbn )
+{
+#ifndef WITHOUT_PLANE_STATS
+    return _vctPlanes[nPlane].EraseCount(nPbn);
+#else
+    (void)nPlane; (void)nPbn;
+    return 0;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Deallocate
+// FullName:  Die::Deallocate
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT8 nPlane
+// Parameter: UINT16 nPbn
+// Parameter: UINT32 nPgoff
+//
+// Descriptions -
+// Mark a page stale (see Plane::Deallocate). Stale pages are kept in the plane
+// statistics, so that the hint is ignored without them.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Die::Deallocate( UINT8 nPlane, UINT16 nPbn, UINT32 nPgoff )
+{
+    if(nPlane >= _stDevConfig._nNumsPlane)
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+#ifndef WITHOUT_PLANE_STATS
+    return _vctPlanes[nPlane].Deallocate(nPbn, nPgoff);
+#else
+    (void)nPbn; (void)nPgoff;
+    return NAND_SUCCESS;
+#endif
+}
+
+// reads of stale pages over the planes of the die
+UINT64 Die::GetStaleReadCount( void )
+{
+    UINT64 nCount = 0;
+#ifndef WITHOUT_PLANE_STATS
+    for(UINT8 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+    {
+        nCount += _vctPlanes[nPlane].StaleReadCount();
+    }
+#endif
+    return nCount;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Save
+// FullName:  Die::Save
+// Access:    public 
+// Returns:   void
+// Parameter: NandCheckpoint & ckpt
+//
+// Descriptions -
+// Serialize registers, FSM state and statistics of this die and its planes.
+// Cache registers are only meaningful (and saved) when storage is enabled.
+//////////////////////////////////////////////////////////////////////////////
+void Die::Save( NandCheckpoint &ckpt )
+{
+    ckpt.Put(_nCurrentTime);
+    ckpt.PutVector(_vctRowRegister);
+    ckpt.PutVector(_vctColRegister);
+    ckpt.PutVector(_vctRandomBytes);
+    ckpt.PutVector(_vctRandomDataIn);
+    ckpt.Put(_nCommandRegister);
+#ifndef NO_STORAGE
+    for(UINT8 nIdx = 0; nIdx < _stDevConfig._nNumsPlane; ++nIdx)
+    {
+#ifndef WITHOUT_PLANE_STATS
+        _vctPlanes[nIdx].WaitIo();
+#endif
+        ckpt.PutBytes(_vctpCacheRegister[nIdx].get(), NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+#endif
+
+    ckpt.Put(_bPowerSupply);
+    ckpt.Put(_bNeedReset);
+    ckpt.Put(_nCurrentStage);
+    ckpt.Put(_nExpectedStage);
+    ckpt.Put(_nNextActivate);
+    ckpt.Put(_nCurNandClockIdleTime);
+    ckpt.Put(_bNandBusy);
+    ckpt.Put(_nLastAleBytes);
+    ckpt.Put(_nNxCommandCnt);
+    ckpt.Put(_bStanbyDc);
+    ckpt.Put(_bLeakDc);
+    ckpt.Put(_bCacheLoadFirst);
+    ckpt.Put(_bCacheNohideTon);
+    ckpt.Put(_nArrayBusyTime);
+    ckpt.Put(_nProgBusyTime);
+    ckpt.Put(_nStatReadRetry);
+    ckpt.Put(_bLunReselect);
+
+    ckpt.PutVector(_vctAccumulatedTime);
+    ckpt.PutVector(_vctPowerTime);
+
+#ifndef WITHOUT_PLANE_STATS
+    for(std::vector<Plane>::iterator iPlane = _vctPlanes.begin(); iPlane != _vctPlanes.end(); ++iPlane)
+    {
+        iPlane->Save(ckpt);
+    }
+#endif
+}
+
+void Die::Restore( NandCheckpoint &ckpt )
+{
+    ckpt.Get(_nCurrentTime);
+    ckpt.GetVector(_vctRowRegister);
+    ckpt.GetVector(_vctColRegister);
+    ckpt.GetVector(_vctRandomBytes);
+    ckpt.GetVector(_vctRandomDataIn);
+    ckpt.Get(_nCommandRegister);
+#ifndef NO_STORAGE
+    for(UINT8 nIdx = 0; nIdx < _stDevConfig._nNumsPlane; ++nIdx)
+    {
+#ifndef WITHOUT_PLANE_STATS
+        _vctPlanes[nIdx].WaitIo();
+#endif
+        ckpt.GetBytes(_vctpCacheRegister[nIdx].get(), NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+#endif
+
+    ckpt.Get(_bPowerSupply);
+    ckpt.Get(_bNeedReset);
+    ckpt.Get(_nCurrentStage);
+    ckpt.Get(_nExpectedStage);
+    ckpt.Get(_nNextActivate);
+    ckpt.Get(_nCurNandClockIdleTime);
+    ckpt.Get(_bNandBusy);
+    ckpt.Get(_nLastAleBytes);
+    ckpt.Get(_nNxCommandCnt);
+    ckpt.Get(_bStanbyDc);
+    ckpt.Get(_bLeakDc);
+    ckpt.Get(_bCacheLoadFirst);
+    ckpt.Get(_bCacheNohideTon);
+    ckpt.Get(_nArrayBusyTime);
+    ckpt.Get(_nProgBusyTime);
+    ckpt.Get(_nStatReadRetry);
+    ckpt.Get(_bLunReselect);
+
+    ckpt.GetVector(_vctAccumulatedTime);
+    ckpt.GetVector(_vctPowerTime);
+
+    // logs for the last transition are not a part of the state.
+    _eUpdatedState      = NAND_FSM_MAX;
+    _nUpdatedAccTime    = 0;
+
+#ifndef WITHOUT_PLANE_STATS
+    for(std::vector<Plane>::iterator iPlane = _vctPlanes.begin(); iPlane != _vctPlanes.end(); ++iPlane)
+    {
+        iPlane->Restore(ckpt);
+    }
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    loadPageTypeTable
+// FullName:  Die::loadPageTypeTable
+// Access:    private 
+// Returns:   void
+//
+// Descriptions -
+// Build page offset to page type map and latency tables of each page type from [PAGETYPE] of device ini.
+// MAP which is shorter than pages per block is repeated over the rest of the block.
+// If the table is not given or invalid, the map is left empty and page offset patterns are used.
+//
+//////////////////////////////////////////////////////////////////////////////
+void Die::loadPageTypeTable()
+{
+    _vctPgTypeMap.clear();
+    _vctPgTypeProgTime.clear();
+    _vctPgTypeReadTime.clear();
+    _bOneShotProg   = (NFS_GET_PARAM(IPV_ONESHOT) != 0);
+
+    UINT32 nNumsTypes = NFS_GET_PARAM(IPV_NUMS_TYPES);
+    if(nNumsTypes == 0)
+    {
+        return;
+    }
+
+    std::vector<UINT32> vctPattern;
+    if(ParamManager::GetParamList(IPV_tPROG, _vctPgTypeProgTime) == false || _vctPgTypeProgTime.size() < nNumsTypes ||
+       ParamManager::GetParamList(IPV_tR, _vctPgTypeReadTime) == false   || _vctPgTypeReadTime.size() < nNumsTypes ||
+       ParamManager::GetParamList(IPV_MAP, vctPattern) == false)
+    {
+        NV_ERROR("page type table needs tPROG and tR for each page type and MAP, page offset patterns are used");
+        _vctPgTypeProgTime.clear();
+        _vctPgTypeReadTime.clear();
+        return;
+    }
+    _vctPgTypeProgTime.resize(nNumsTypes);
+    _vctPgTypeReadTime.resize(nNumsTypes);
+
+    for(UINT32 nPgo = 0; nPgo < _stDevConfig._nNumsPgPerBlk; nPgo++)
+    {
+        UINT32 nType = vctPattern[nPgo % vctPattern.size()];
+        if(nType >= nNumsTypes)
+        {
+            NV_ERROR("page type of MAP exceeds NUMS_TYPES, page offset patterns are used");
+            _vctPgTypeMap.clear();
+            _vctPgTypeProgTime.clear();
+            _vctPgTypeReadTime.clear();
+            return;
+        }
+        _vctPgTypeMap.push_back(nType);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    readRetryTime
+// FullName:  Die::readRetryTime
+// Access:    private 
+// Returns:   UINT64
+// Parameter: UINT8 nPlane
+// Parameter: UINT64 nTime
+// Parameter: UINT64 nSenseTime
+//
+// Descriptions -
+// Additional array time of a page read under the read-retry model of [RELIABILITY].
+// The number of retries grows with erase count, time since the block was programmed
+// and reads since the last erase (read disturb), and it is capped by MAX_RETRY.
+// Each retry senses the page again (nSenseTime) and decodes it (tECC).
+// Multi-plane reads wait for the plane which needs the most retries.
+// Without plane stats, there is no block information, so only the first decoding is charged.
+//
+//////////////////////////////////////////////////////////////////////////////
+UINT64 Die::readRetryTime(UINT8 nPlane, UINT64 nTime, UINT64 nSenseTime)
+{
+    if(NFS_GET_PARAM(ILV_READ_RETRY) == 0)
+    {
+        return 0;
+    }
+
+    UINT32 nRetry = 0;
+#ifndef WITHOUT_PLANE_STATS
+    bool bMultiPlane = (_nCommandRegister == NAND_CMD_READ_MULTIPLANE_INIT_FIN_CONF || _nCommandRegister == NAND_CMD_READ_MULTIPLANE_CACHE);
+    for(UINT16 nPlaneIdx = 0; nPlaneIdx < _stDevConfig._nNumsPlane; nPlaneIdx++)
+    {
+        if((bMultiPlane == false && nPlaneIdx != nPlane) || _vctRowRegister[nPlaneIdx] == NULL_SIG(UINT32))
+        {
+            continue;
+        }
+
+        Plane   &plane      = _vctPlanes[nPlaneIdx];
+        UINT16  nPbn        = NAND_PBN_PARSE_REGISTER(_vctRowRegister[nPlaneIdx]);
+        UINT32  nPlaneRetry = 0;
+        if(NFS_GET_PARAM(ILV_EC_PER_RETRY) != 0)
+        {
+            nPlaneRetry += plane.EraseCount(nPbn) / NFS_GET_PARAM(ILV_EC_PER_RETRY);
+        }
+        if(NFS_GET_PARAM(ILV_RETENTION_PER_RETRY) != 0 && plane.ProgramTime(nPbn) != NULL_SIG(UINT64) && nTime > plane.ProgramTime(nPbn))
+        {
+            // retention is given in ms
+            nPlaneRetry += (UINT32)(((nTime - plane.ProgramTime(nPbn)) / 1000000) / NFS_GET_PARAM(ILV_RETENTION_PER_RETRY));
+        }
+        if(NFS_GET_PARAM(ILV_READS_PER_RETRY) != 0)
+        {
+            nPlaneRetry += plane.ReadCount(nPbn) / NFS_GET_PARAM(ILV_READS_PER_RETRY);
+        }
+        if(nPlaneRetry > nRetry)
+        {
+            nRetry = nPlaneRetry;
+        }
+    }
+    if(nRetry > NFS_GET_PARAM(ILV_MAX_RETRY))
+    {
+        nRetry = NFS_GET_PARAM(ILV_MAX_RETRY);
+    }
+#else
+    (void)nPlane; (void)nTime;
+#endif
+    _nStatReadRetry += nRetry;
+
+    return NFS_GET_PARAM(ILV_tECC) + nRetry * (nSenseTime + NFS_GET_PARAM(ILV_tECC));
+}
+
+}
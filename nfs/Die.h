@@ -36,6 +36,8 @@
 
 namespace NANDFlashSim {
 
+class NandCheckpoint;
+
 class Die 
 {
     /************************************************************************/
@@ -54,6 +56,7 @@ class Die
     std::vector<UINT32> _vctRowRegister;
     std::vector<UINT16> _vctColRegister;
     std::vector<UINT32> _vctRandomBytes;
+    std::vector<bool>   _vctRandomDataIn;           // the page register of the plane is loaded by random data input, so 85h changes only the column.
     NAND_COMMAND        _nCommandRegister;
     // for simulation data/cache register, this simulation leverage cache register rather than both registers.
     // This enable this to remove unnecessary memory copy operation.
@@ -81,12 +84,24 @@ class Die
     /************************************************************************/
     bool                _bCacheLoadFirst;
     bool                _bCacheNohideTon;
+    bool                _bLunReselect;              // the die has to be selected by Read Status Enhanced before its next output
+    UINT64              _nArrayBusyTime;            // remaining time of the array read in background (multi-plane cache read). NULL_SIG if there is no such read.
+    UINT64              _nProgBusyTime;             // remaining time of the page program in background (cache program). NULL_SIG if there is no such program.
+
+    /************************************************************************/
+    /* page type latency                                                    */
+    /************************************************************************/
+    std::vector<UINT32> _vctPgTypeMap;              // page type (0:LSB, 1:CSB, 2:MSB, 3:TSB) of each page offset. empty if no table is given.
+    std::vector<UINT32> _vctPgTypeProgTime;
+    std::vector<UINT32> _vctPgTypeReadTime;
+    bool                _bOneShotProg;              // lower pages of a word line are programmed with the highest page type in a single tPROG
 
     /************************************************************************/
     /* statistics                                                           */
     /************************************************************************/
     std::vector<UINT64> _vctAccumulatedTime;
     std::vector<UINT64> _vctPowerTime;
+    UINT64              _nStatReadRetry;
 
     /************************************************************************/
     /* For Logs                                                             */
@@ -100,7 +115,16 @@ public :
 
     void                SoftReset();
     void                HardReset(UINT32 nSystemClock, NandDeviceConfig &stDevConfig);
+    void                Save(NandCheckpoint &ckpt);
+    void                Restore(NandCheckpoint &ckpt);
+    NV_RET              Precondition(UINT8 nPlane, UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature);
+    NV_RET              BlockMode(UINT8 nPlane, UINT16 nPbn, NAND_BLOCK_MODE eMode);
+    NAND_BLOCK_MODE     BlockMode(UINT8 nPlane, UINT16 nPbn);
+    UINT32              EraseCount(UINT8 nPlane, UINT16 nPbn);
+    NV_RET              Deallocate(UINT8 nPlane, UINT16 nPbn, UINT32 nPgoff);
+    UINT64              GetStaleReadCount(void);
     void                Update(UINT64 nTime);
+    void                UpdateArray(UINT64 nTime);
     void                Poweron();
     void                Poweroff();
     NAND_STAGE          TransitStage( NAND_STAGE nState, NandStagePacket &stPacket);
@@ -119,12 +143,19 @@ public :
     UINT32              ID() const { return _nId; }
     void                ID(UINT32 val);
     bool                CheckRb();
+    inline void         SelectLun()     { _bLunReselect = true; }
     inline bool         IsFree() { return (_nNextActivate == 0 && _nExpectedStage == NAND_STAGE_IDLE) ? true : false;}
     UINT64              GetCurNandClockIdleTime(void) { return _nCurNandClockIdleTime; }
+    UINT64              GetReadRetryCount(void) { return _nStatReadRetry; }
+    UINT32              ArrayCurrent();
+    UINT64              ArrayBusyTime();
+    UINT32              ArrayCurrentDemand(NAND_STAGE nStage, NAND_COMMAND nCommand);
 
 private :
     void                resetRegisters();
     UINT64              nandArrayTimeParam(UINT32 nRow, INI_DEVICE_VALUE eName);
+    void                loadPageTypeTable();
+    UINT64              readRetryTime(UINT8 nPlane, UINT64 nTime, UINT64 nSenseTime);
 };
 
 }
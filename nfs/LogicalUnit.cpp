@@ -24,6 +24,7 @@
 
 #include "TypeSystem.h"
 #include "Tools.h"
+#include "NandCheckpoint.h"
 #include "ParamManager.h"
 #include "IoCompletion.h"
 #include "Plane.h"
@@ -41,12 +42,21 @@ LogicalUnit::LogicalUnit(UINT64 nSystemClock, NandDeviceConfig &stDevConfig) :
     _vctIoCompletion(stDevConfig._nNumsDie, false),
     _vctNeedforCallback(stDevConfig._nNumsDie, false),
     _vctFirstArrivalCycleForInitialCommand(stDevConfig._nNumsDie, NULL_SIG(UINT64)),
-    _vctCurHostClockIdleTime(stDevConfig._nNumsDie, 0)
+    _vctCurHostClockIdleTime(stDevConfig._nNumsDie, 0),
+    _vctCompletionTime(stDevConfig._nNumsDie, NULL_SIG(UINT64)),
+    _vctInterleavedCmd(stDevConfig._nNumsDie, (UINT8)NAND_MULTIDIE_NONE),
+    _vctPowerStallStart(stDevConfig._nNumsDie, NULL_SIG(UINT64)),
+    _vctPowerStallTime(stDevConfig._nNumsDie, 0)
 {
     _nCurrentTime                   = nSystemClock;
     _nMinNextActivate               = 0;
     _bBusy                          = false;
     _nIoBusOwnerDieId               = NULL_SIG(UINT16);
+    _nSelectedDieId                 = NULL_SIG(UINT16);
+    _nStatLunSelect                 = 0;
+    _bHoldIoBus                     = false;
+    _bPowerThrottled                = false;
+    _nStatPowerThrottle             = 0;
 
     for (UINT32 nDieIdx = 0; nDieIdx < stDevConfig._nNumsDie; nDieIdx++)
     {
@@ -93,6 +103,8 @@ void LogicalUnit::Update(UINT64 nTime)
 
     _nCurrentTime     += nTime;
     _nMinNextActivate = NULL_SIG(UINT64);
+    _bHoldIoBus       = false;
+    _bPowerThrottled  = false;
 
     const UINT32 nClockPeriods = NFS_GET_PARAM(ISV_CLOCK_PERIODS);
     assert(nClockPeriods != 0);
@@ -120,6 +132,10 @@ void LogicalUnit::Update(UINT64 nTime)
             }
             
             iterDie->Update(nGivenTime);
+            if(nGivenTime < nTime)
+            {
+                iterDie->UpdateArray(nTime - nGivenTime);
+            }
         }
 
         // processing callback
@@ -148,6 +164,7 @@ void LogicalUnit::Update(UINT64 nTime)
             // clean up for active transaction packet from bus.
             _vctNandBus[nDieIdx].pop_front();
             _vctIoCompletion[nDieIdx] = false;
+            _vctCompletionTime[nDieIdx] = _nCurrentTime;
         }        
         
         // update IoBus lock state
@@ -187,6 +204,25 @@ void LogicalUnit::Update(UINT64 nTime)
         }
     }
 
+    if(_bHoldIoBus == true && nClockPeriods < _nMinNextActivate)
+    {
+        // wake up at the next clock even if the held die does not get its next command.
+        _nMinNextActivate = nClockPeriods;
+    }
+
+    if(_bPowerThrottled == true)
+    {
+        // wake up when an array task of another die releases its current.
+        UINT64 nWakeup = NULL_SIG(UINT64);
+        for(std::vector<Die>::iterator iterDie = _vctDies.begin(); iterDie != _vctDies.end(); ++iterDie)
+        {
+            UINT64 nBusyTime = iterDie->ArrayBusyTime();
+            if(nBusyTime != 0 && nBusyTime < nWakeup) nWakeup = nBusyTime;
+        }
+        if(nWakeup == NULL_SIG(UINT64)) nWakeup = nClockPeriods;
+        if(nWakeup < _nMinNextActivate) _nMinNextActivate = nWakeup;
+    }
+
     if(_nMinNextActivate == NULL_SIG(UINT64)) _nMinNextActivate = 0;
 }
 
@@ -211,6 +247,7 @@ bool LogicalUnit::transitStage(UINT8 nDieIdx, bool &bTransitFailed)
                     nNandStage  = NAND_STAGE_READ_STATUS;
                 }
                 else if ((scheduledPacket._nCommand == NAND_CMD_READ_MULTIPLANE_INIT 
+                    || scheduledPacket._nCommand == NAND_CMD_READ_MULTIPLANE_CACHE
                     || scheduledPacket._nCommand == NAND_CMD_READ_INTERNAL
                     || scheduledPacket._nCommand == NAND_CMD_READ_INTERNAL_MULTIPLANE
                     || scheduledPacket._nCommand == NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN
@@ -224,6 +261,15 @@ bool LogicalUnit::transitStage(UINT8 nDieIdx, bool &bTransitFailed)
                     _vctFirstArrivalCycleForInitialCommand[nDieIdx]   = scheduledPacket._nArrivalCycle;
                 }
 
+                if(nNandStage == NAND_STAGE_READ_STATUS && _vctInterleavedCmd[nDieIdx] != NAND_MULTIDIE_NONE &&
+                   _nSelectedDieId != NULL_SIG(UINT16) && _nSelectedDieId != nDieIdx)
+                {
+                    _vctDies[nDieIdx].SelectLun();
+                    _nStatLunSelect++;
+                }
+                // a command with row address selects the die.
+                _nSelectedDieId = nDieIdx;
+
                 // issue new state for current transaction
                 _vctDies[nDieIdx].TransitStage(nNandStage, scheduledPacket);
                 return true;
@@ -237,26 +283,55 @@ bool LogicalUnit::transitStage(UINT8 nDieIdx, bool &bTransitFailed)
             // this routine handles NAND I/O stage chain for a request which was already issued.
             // ;thus, there is no need to acquire I/O bus
             NandStagePacket &scheduledPacket     = _vctNandBus[nDieIdx].front();
+            NAND_COMMAND    nCommand            = scheduledPacket._nCommand;
 
             if(nNextExpectedState == NAND_STAGE_CLE)
             {
                 // this will be right after address latch
                 // transiting command chain
-                scheduledPacket._nCommand = getConfirmCommand(scheduledPacket._nCommand);
+                nCommand = getConfirmCommand(nCommand);
             }
 
+            if(admitArrayTask(nDieIdx, nNextExpectedState, nCommand) == false)
+            {
+                // the die keeps its state until the power budget allows its array task, and other dies can use the bus.
+                releaseIobus(nDieIdx);
+                return false;
+            }
+            scheduledPacket._nCommand = nCommand;
+
             bool bPermissionToTransit   = true;
             // if the next state is kind of stage using NAND bus, it requires to acquire lock
             if(nNextExpectedState < NAND_DELIMITER_STAGE_FOR_NAND_ARRAY_TASK)
             {
                 if(getBusOwnerDieId() != nDieIdx)
                 {
-                    acquireIoBus(nDieIdx);
-                    if(getBusOwnerDieId() != nDieIdx)
+                    if(getBusOwnerDieId() == NULL_SIG(UINT16) && yieldIoBus(nDieIdx) == true)
                     {
                         bPermissionToTransit = false;
                         bTransitFailed = true;
                     }
+                    else
+                    {
+                        acquireIoBus(nDieIdx);
+                        if(getBusOwnerDieId() != nDieIdx)
+                        {
+                            bPermissionToTransit = false;
+                            bTransitFailed = true;
+                        }
+                    }
+                }
+
+                if(bPermissionToTransit)
+                {
+                    // ONFI multi-LUN: once another die of the interleaved group has driven the bus, the output of this die needs LUN selection.
+                    if((nNextExpectedState == NAND_STAGE_TOR || nNextExpectedState == NAND_STAGE_READ_STATUS) &&
+                       _vctInterleavedCmd[nDieIdx] != NAND_MULTIDIE_NONE && _nSelectedDieId != NULL_SIG(UINT16) && _nSelectedDieId != nDieIdx)
+                    {
+                        _vctDies[nDieIdx].SelectLun();
+                        _nStatLunSelect++;
+                    }
+                    _nSelectedDieId = nDieIdx;
                 }
             }
             else 
@@ -282,6 +357,114 @@ bool LogicalUnit::transitStage(UINT8 nDieIdx, bool &bTransitFailed)
     return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    admitArrayTask
+// FullName:  LogicalUnit::admitArrayTask
+// Access:    private 
+// Returns:   bool
+// Parameter: UINT8 nDieIdx
+// Parameter: NAND_STAGE nStage
+// Parameter: NAND_COMMAND nCommand
+//
+// Descriptions -
+// Admission control for the peak power of a package. An array task (TON, TIN or
+// erase) of a die starts only if the currents of the other dies and the current 
+// of the task fit in DC.POWER_BUDGET; otherwise, the die waits until an array 
+// task of another die completes. A task starts anyway if no other die draws current.
+// The wait time is accounted as power capping stall of the die.
+//////////////////////////////////////////////////////////////////////////////
+bool LogicalUnit::admitArrayTask(UINT8 nDieIdx, NAND_STAGE nStage, NAND_COMMAND nCommand)
+{
+    UINT32 nBudget  = NFS_GET_PARAM(IDV_POWER_BUDGET);
+    UINT32 nDemand  = (nBudget != 0) ? _vctDies[nDieIdx].ArrayCurrentDemand(nStage, nCommand) : 0;
+    if(nDemand == 0)
+    {
+        return true;
+    }
+
+    UINT32 nCurrent = 0;
+    for(UINT8 nIdx = 0; nIdx < _vctDies.size(); nIdx++)
+    {
+        if(nIdx != nDieIdx) nCurrent += _vctDies[nIdx].ArrayCurrent();
+    }
+
+    if(nCurrent != 0 && nCurrent + nDemand > nBudget)
+    {
+        if(_vctPowerStallStart[nDieIdx] == NULL_SIG(UINT64))
+        {
+            _vctPowerStallStart[nDieIdx] = _nCurrentTime;
+            _nStatPowerThrottle++;
+        }
+        _bPowerThrottled = true;
+        return false;
+    }
+
+    if(_vctPowerStallStart[nDieIdx] != NULL_SIG(UINT64))
+    {
+        _vctPowerStallTime[nDieIdx]  += _nCurrentTime - _vctPowerStallStart[nDieIdx];
+        _vctPowerStallStart[nDieIdx] = NULL_SIG(UINT64);
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    yieldIoBus
+// FullName:  LogicalUnit::yieldIoBus
+// Access:    private 
+// Returns:   bool
+// Parameter: UINT8 nDieIdx
+//
+// Descriptions -
+// Bus arbitration for an interleaved die group (see NandController::formInterleavedGroup).
+// A member about to output data or status gives the free bus to another member which
+// (1) waits to start its command sequence, so that its array time overlaps this output,
+// (2) has just completed a command sequence at this time, so that the next command of 
+//     the member can be issued before the output (the bus is held for a clock at most), or
+// (3) is the selected die and has its own output ready, so that no LUN selection is needed.
+//
+//////////////////////////////////////////////////////////////////////////////
+bool LogicalUnit::yieldIoBus(UINT8 nDieIdx)
+{
+    NAND_STAGE nStage = _vctDies[nDieIdx].ExpectedNextStage();
+    if(_vctInterleavedCmd[nDieIdx] == NAND_MULTIDIE_NONE || (nStage != NAND_STAGE_TOR && nStage != NAND_STAGE_READ_STATUS))
+    {
+        return false;
+    }
+
+    for(UINT8 nOtherIdx = 0; nOtherIdx < _vctDies.size(); nOtherIdx++)
+    {
+        if(nOtherIdx == nDieIdx || _vctInterleavedCmd[nOtherIdx] == NAND_MULTIDIE_NONE ||
+           _vctDies[nOtherIdx].CheckFsmBusy() == true)
+        {
+            continue;
+        }
+
+        if(_vctNandBus[nOtherIdx].empty() == true)
+        {
+            if(_vctCompletionTime[nOtherIdx] == _nCurrentTime)
+            {
+                _bHoldIoBus = true;
+                return true;
+            }
+            continue;
+        }
+
+        NAND_STAGE nOtherStage = _vctDies[nOtherIdx].ExpectedNextStage();
+        if(nOtherStage == NAND_STAGE_IDLE)
+        {
+            return true;
+        }
+        if(nOtherIdx == _nSelectedDieId && (nOtherStage == NAND_STAGE_TOR || nOtherStage == NAND_STAGE_READ_STATUS))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool LogicalUnit::CheckBusy( UINT8 nDie )
 {
     bool bBusy  = false;
@@ -440,6 +623,9 @@ NAND_COMMAND LogicalUnit::getConfirmCommand(NAND_COMMAND nCommand)
     case NAND_CMD_READ_MULTIPLANE :
         nConfirm   = NAND_CMD_READ_MULTIPLANE_CONF;
         break;
+    case NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY :
+        nConfirm   = NAND_CMD_READ_MULTIPLANE_CACHE_CONF;
+        break;
     case NAND_CMD_PROG_MULTIPLANE :
         nConfirm   = NAND_CMD_PROG_MULTIPLANE_CONF;
         break;
@@ -497,6 +683,11 @@ void LogicalUnit::HardReset( UINT32 nSystemClock, NandDeviceConfig &stDevConfig
     _bBusy                          = false;
     _nIoBusOwnerDieId               = NULL_SIG(UINT16);
     _nTransactionBusDepth           = stDevConfig._nTransBusDepth; 
+    _nSelectedDieId                 = NULL_SIG(UINT16);
+    _nStatLunSelect                 = 0;
+    _bHoldIoBus                     = false;
+    _bPowerThrottled                = false;
+    _nStatPowerThrottle             = 0;
 
     for (UINT32 nDieId = 0; nDieId < stDevConfig._nNumsDie; nDieId++)
     {
@@ -506,8 +697,68 @@ void LogicalUnit::HardReset( UINT32 nSystemClock, NandDeviceConfig &stDevConfig
         _vctNeedforCallback[nDieId]     = false;
         _vctFirstArrivalCycleForInitialCommand[nDieId] = NULL_SIG(UINT64);
         _vctNandBus[nDieId].clear();
+        _vctInterleavedCmd[nDieId]      = (UINT8)NAND_MULTIDIE_NONE;
+        _vctCompletionTime[nDieId]      = NULL_SIG(UINT64);
+        _vctPowerStallStart[nDieId]     = NULL_SIG(UINT64);
+        _vctPowerStallTime[nDieId]      = 0;
         _vctDies[nDieId].HardReset(nSystemClock, stDevConfig);
     }
 }
 
-}
\ No newline at end of file
+void LogicalUnit::Save( NandCheckpoint &ckpt )
+{
+    ckpt.Put(_nCurrentTime);
+    ckpt.Put(_nMinNextActivate);
+    ckpt.Put(_nTransactionBusDepth);
+    ckpt.Put(_bBusy);
+    ckpt.Put(_nIoBusOwnerDieId);
+    ckpt.Put(_nSelectedDieId);
+    ckpt.Put(_nStatLunSelect);
+    ckpt.Put(_nStatPowerThrottle);
+
+    ckpt.PutVector(_vctRequestTraffic);
+    ckpt.PutVector(_vctIoCompletion);
+    ckpt.PutVector(_vctNeedforCallback);
+    ckpt.PutVector(_vctFirstArrivalCycleForInitialCommand);
+    ckpt.PutVector(_vctCurHostClockIdleTime);
+    ckpt.PutVector(_vctInterleavedCmd);
+    ckpt.PutVector(_vctCompletionTime);
+    ckpt.PutVector(_vctPowerStallStart);
+    ckpt.PutVector(_vctPowerStallTime);
+
+    for (UINT32 nDieId = 0; nDieId < _vctDies.size(); nDieId++)
+    {
+        ckpt.PutPackets(_vctNandBus[nDieId]);
+        _vctDies[nDieId].Save(ckpt);
+    }
+}
+
+void LogicalUnit::Restore( NandCheckpoint &ckpt )
+{
+    ckpt.Get(_nCurrentTime);
+    ckpt.Get(_nMinNextActivate);
+    ckpt.Get(_nTransactionBusDepth);
+    ckpt.Get(_bBusy);
+    ckpt.Get(_nIoBusOwnerDieId);
+    ckpt.Get(_nSelectedDieId);
+    ckpt.Get(_nStatLunSelect);
+    ckpt.Get(_nStatPowerThrottle);
+
+    ckpt.GetVector(_vctRequestTraffic);
+    ckpt.GetVector(_vctIoCompletion);
+    ckpt.GetVector(_vctNeedforCallback);
+    ckpt.GetVector(_vctFirstArrivalCycleForInitialCommand);
+    ckpt.GetVector(_vctCurHostClockIdleTime);
+    ckpt.GetVector(_vctInterleavedCmd);
+    ckpt.GetVector(_vctCompletionTime);
+    ckpt.GetVector(_vctPowerStallStart);
+    ckpt.GetVector(_vctPowerStallTime);
+
+    for (UINT32 nDieId = 0; nDieId < _vctDies.size(); nDieId++)
+    {
+        ckpt.GetPackets(_vctNandBus[nDieId]);
+        _vctDies[nDieId].Restore(ckpt);
+    }
+}
+
+}
@@ -45,8 +45,10 @@ typedef enum {
     NAND_MUTILDIE_PROG,
     NAND_MULTIDIE_MULTIPLANE_PROG,
     NAND_MULTIDIE_MULTIPLANE_CACHE_PROG,
+    NAND_MULTIDIE_NONE
 } NAND_INTERLEAVED_DIE_COMMAND;
 
+class NandCheckpoint;
 
 class LogicalUnit {
     UINT32              _nId;
@@ -55,6 +57,8 @@ class LogicalUnit {
     UINT32              _nTransactionBusDepth;
     bool                _bBusy;
     UINT16              _nIoBusOwnerDieId;
+    UINT16              _nSelectedDieId;            // the die (ONFI LUN) which drove the bus last
+    UINT64              _nStatLunSelect;
 
     std::vector<Die>    _vctDies;
     std::vector<UINT64> _vctRequestTraffic;
@@ -63,6 +67,13 @@ class LogicalUnit {
     std::vector<bool>   _vctNeedforCallback;
     std::vector<UINT64> _vctFirstArrivalCycleForInitialCommand;
     std::vector<UINT64> _vctCurHostClockIdleTime;
+    std::vector<UINT64> _vctCompletionTime;         // the last time a command sequence of each die was completed
+    bool                _bHoldIoBus;                // the bus is held for a group member at this time
+    std::vector<UINT8>  _vctInterleavedCmd;         // NAND_INTERLEAVED_DIE_COMMAND of each die, NAND_MULTIDIE_NONE if the die is not in a group
+    bool                _bPowerThrottled;           // an array task of a die waits for the power budget at this time
+    UINT64              _nStatPowerThrottle;
+    std::vector<UINT64> _vctPowerStallStart;        // the time when each die began to wait for the power budget, NULL_SIG if it doesn't wait
+    std::vector<UINT64> _vctPowerStallTime;
 
     
 public:
@@ -80,6 +91,14 @@ public:
     void                ID(UINT32 val);
     UINT64              AccumulatedTraffic();
     void                HardReset(UINT32 nSystemClock, NandDeviceConfig &stDevConfig);
+    void                Save(NandCheckpoint &ckpt);
+    void                Restore(NandCheckpoint &ckpt);
+    NV_RET              Precondition(UINT8 nDie, UINT8 nPlane, UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature)
+                                                            { return _vctDies[nDie].Precondition(nPlane, nPbn, nProgrammedPgs, nEc, pSignature); }
+    NV_RET              BlockMode(UINT8 nDie, UINT8 nPlane, UINT16 nPbn, NAND_BLOCK_MODE eMode) { return _vctDies[nDie].BlockMode(nPlane, nPbn, eMode); }
+    NAND_BLOCK_MODE     BlockMode(UINT8 nDie, UINT8 nPlane, UINT16 nPbn) { return _vctDies[nDie].BlockMode(nPlane, nPbn); }
+    UINT32              EraseCount(UINT8 nDie, UINT8 nPlane, UINT16 nPbn) { return _vctDies[nDie].EraseCount(nPlane, nPbn); }
+    NV_RET              Deallocate(UINT8 nDie, UINT8 nPlane, UINT16 nPbn, UINT32 nPgoff) { return _vctDies[nDie].Deallocate(nPlane, nPbn, nPgoff); }
     inline bool         IsIoBusActive()                     { return (_nIoBusOwnerDieId == NULL_SIG(UINT16)) ? false : true;}
 
     UINT64              CurrentTime(UINT8 nDie)             { return _vctDies[nDie].CurrentTime(); }
@@ -88,6 +107,15 @@ public:
     
     UINT64              GetRequestTraffic(UINT8 nDie)       { return _vctRequestTraffic[nDie]; }
     UINT64              GetAccumulatedFSMTime(NAND_FSM_STATE nFsmState, UINT8 nDie) { return _vctDies[nDie].GetAccumulatedFSMTime(nFsmState); }
+    UINT64              GetReadRetryCount(UINT8 nDie)       { return _vctDies[nDie].GetReadRetryCount(); }
+    UINT64              GetStaleReadCount(UINT8 nDie)       { return _vctDies[nDie].GetStaleReadCount(); }
+    UINT64              GetLunSelectCount()                 { return _nStatLunSelect; }
+    UINT64              GetPowerThrottleCount()             { return _nStatPowerThrottle; }
+    UINT64              GetPowerStallTime(UINT8 nDie)       { return _vctPowerStallTime[nDie]; }
+
+    void                JoinInterleavedGroup(UINT8 nDie, NAND_INTERLEAVED_DIE_COMMAND eCmd)  { _vctInterleavedCmd[nDie] = (UINT8)eCmd; }
+    void                LeaveInterleavedGroup(UINT8 nDie)   { _vctInterleavedCmd[nDie] = (UINT8)NAND_MULTIDIE_NONE; }
+    NAND_INTERLEAVED_DIE_COMMAND InterleavedGroup(UINT8 nDie) { return (NAND_INTERLEAVED_DIE_COMMAND)_vctInterleavedCmd[nDie]; }
 
 private :
     inline UINT16       getBusOwnerDieId()                  {return _nIoBusOwnerDieId;}
@@ -95,6 +123,8 @@ private :
     inline void         releaseIobus(UINT16 nDieId)         { if(_nIoBusOwnerDieId == nDieId) _nIoBusOwnerDieId = NULL_SIG(UINT16);}
     NAND_COMMAND        getConfirmCommand(NAND_COMMAND nCommand);
     bool                transitStage(UINT8 nDieIdx, bool &bTransitFailed);
+    bool                yieldIoBus(UINT8 nDieIdx);
+    bool                admitArrayTask(UINT8 nDieIdx, NAND_STAGE nStage, NAND_COMMAND nCommand);
 };
 
 }
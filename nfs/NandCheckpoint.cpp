@@ -0,0 +1,217 @@
+/****************************************************************************
+*	 NANDFlashSim: A Cycle Accurate NAND Flash Memory Simulator 
+*	 
+*	 Copyright (C) 2011   	Myoungsoo Jung (MJ)
+*
+*                           Pennsylvania State University
+*                           Microsystems Design Laboratory
+*                           I/O Group
+*
+*	 This program is free software: you can redistribute it and/or modify
+*	 it under the terms of the GNU Lesser General Public License as published by
+*	 the Free Software Foundation.
+*
+*	 This program is distributed in the hope that it will be useful,
+*	 but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	 MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	 GNU Lesser General Public License for more details.
+*
+*	 You should have received a copy of the GNU Lesser General Public License
+*	 along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*****************************************************************************/
+
+/********************************************************************
+	created:	2026/10/19
+	created:	19:10:2026   10:12
+	file base:	NandCheckpoint
+	file ext:	cpp
+	
+	purpose:	
+*********************************************************************/
+
+#include "TypeSystem.h"
+#include "Tools.h"
+#include "NandCheckpoint.h"
+#include <memory.h>
+
+namespace NANDFlashSim {
+
+NandCheckpoint::NandCheckpoint() 
+{
+    _nCursor    = 0;
+    _bBroken    = false;
+}
+
+void NandCheckpoint::PutBytes( const void *pSrc, size_t nBytes )
+{
+    const UINT8 *pBytes = (const UINT8 *) pSrc;
+    _vctImage.insert(_vctImage.end(), pBytes, pBytes + nBytes);
+}
+
+void NandCheckpoint::PutVector( const std::vector<bool> &vctValues )
+{
+    Put((UINT64)vctValues.size());
+    for(std::vector<bool>::const_iterator iValue = vctValues.begin(); iValue != vctValues.end(); ++iValue)
+    {
+        Put((UINT8)((*iValue) ? 1 : 0));
+    }
+}
+
+void NandCheckpoint::PutPackets( const std::list<NandStagePacket> &lstPackets )
+{
+    Put((UINT64)lstPackets.size());
+    for(std::list<NandStagePacket>::const_iterator iPacket = lstPackets.begin(); iPacket != lstPackets.end(); ++iPacket)
+    {
+        // host buffers cannot survive a checkpoint.
+        NandStagePacket stPacket    = *iPacket;
+        stPacket._pData             = NULL;
+        stPacket._pStatusData       = NULL;
+        Put(stPacket);
+    }
+}
+
+void NandCheckpoint::PutTransaction( const Transaction &stTrans )
+{
+    Transaction stImage     = stTrans;
+    stImage._pData          = NULL;
+    stImage._pStatusData    = NULL;
+    Put(stImage);
+}
+
+bool NandCheckpoint::GetBytes( void *pDst, size_t nBytes )
+{
+    if(_bBroken || _nCursor + nBytes > _vctImage.size())
+    {
+        _bBroken = true;
+        return false;
+    }
+
+    if(nBytes != 0)
+    {
+        memcpy(pDst, &_vctImage[_nCursor], nBytes);
+        _nCursor += nBytes;
+    }
+    return true;
+}
+
+bool NandCheckpoint::GetVector( std::vector<bool> &vctValues )
+{
+    UINT64 nSize = 0;
+    if(Get(nSize) == false || nSize != vctValues.size())
+    {
+        _bBroken = true;
+        return false;
+    }
+
+    for(std::vector<bool>::iterator iValue = vctValues.begin(); iValue != vctValues.end(); ++iValue)
+    {
+        UINT8 nValue = 0;
+        Get(nValue);
+        *iValue = (nValue != 0);
+    }
+    return !_bBroken;
+}
+
+bool NandCheckpoint::GetPackets( std::list<NandStagePacket> &lstPackets )
+{
+    UINT64 nSize = 0;
+    lstPackets.clear();
+    if(Get(nSize) == false)
+    {
+        return false;
+    }
+
+    for(UINT64 nIdx = 0; nIdx < nSize && _bBroken == false; nIdx++)
+    {
+        NandStagePacket stPacket(0, 0);
+        if(Get(stPacket))
+        {
+            lstPackets.push_back(stPacket);
+        }
+    }
+    return !_bBroken;
+}
+
+bool NandCheckpoint::GetTransaction( Transaction &stTrans )
+{
+    return Get(stTrans);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Store
+// FullName:  NandCheckpoint::Store
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: const char * szPath
+//
+// Descriptions -
+// Write the whole image to the given file with a single write.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandCheckpoint::Store( const char *szPath )
+{
+    std::ofstream   stream(szPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(stream.is_open() == false)
+    {
+        NV_ERROR("cannot create checkpoint : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+
+    if(_vctImage.empty() == false)
+    {
+        stream.write((const char *)&_vctImage[0], _vctImage.size());
+    }
+
+    if(stream.good() == false)
+    {
+        NV_ERROR("cannot write checkpoint : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+    return NAND_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Load
+// FullName:  NandCheckpoint::Load
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: const char * szPath
+//
+// Descriptions -
+// Read the whole image from the given file with a single read, and rewind
+// the cursor for deserialization.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandCheckpoint::Load( const char *szPath )
+{
+    std::ifstream   stream(szPath, std::ios::in | std::ios::binary);
+    if(stream.is_open() == false)
+    {
+        NV_ERROR("cannot open checkpoint : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+
+    stream.seekg(0, std::ios::end);
+    std::streamoff nSize = stream.tellg();
+    stream.seekg(0, std::ios::beg);
+
+    _vctImage.resize((size_t)nSize);
+    _nCursor    = 0;
+    _bBroken    = false;
+
+    if(nSize > 0)
+    {
+        stream.read((char *)&_vctImage[0], nSize);
+    }
+
+    if(nSize <= 0 || stream.gcount() != nSize)
+    {
+        NV_ERROR("cannot read checkpoint : " << szPath);
+        _bBroken = true;
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+    return NAND_SUCCESS;
+}
+
+}
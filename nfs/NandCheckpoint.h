@@ -0,0 +1,121 @@
+/****************************************************************************
+*	 NANDFlashSim: A Cycle Accurate NAND Flash Memory Simulator 
+*	 
+*	 Copyright (C) 2011   	Myoungsoo Jung (MJ)
+*
+*                           Pennsylvania State University
+*                           Microsystems Design Laboratory
+*                           I/O Group
+*
+*	 This program is free software: you can redistribute it and/or modify
+*	 it under the terms of the GNU Lesser General Public License as published by
+*	 the Free Software Foundation.
+*
+*	 This program is distributed in the hope that it will be useful,
+*	 but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	 MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	 GNU Lesser General Public License for more details.
+*
+*	 You should have received a copy of the GNU Lesser General Public License
+*	 along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*****************************************************************************/
+
+
+/********************************************************************
+	created:	2026/10/19
+	created:	19:10:2026   10:12
+	file base:	NandCheckpoint
+	file ext:	h
+	
+	purpose:	NandCheckpoint is a flat binary image used to save and
+    restore the whole state of a NAND flash system (plane metadata, 
+    stored data, die registers and FSM, controller queues and statistics).
+    Each component serializes itself in a fixed order, so the image has
+    no per-field tags; the header (magic, version, build features and
+    device geometry) is the only thing validated before restoring.
+
+    Host buffers referenced by in-flight transactions and stage packets
+    (_pData, _pStatusData) are not part of the image. Checkpoints are meant
+    to be taken at quiescent points (IsActiveMode() == false).
+*********************************************************************/
+
+#ifndef _NandCheckpoint_h__
+#define _NandCheckpoint_h__
+
+#define         NAND_CHECKPOINT_MAGIC               (0x4B43464E)    // "NFCK"
+#define         NAND_CHECKPOINT_VERSION             (12)
+
+// build options changing the layout of an image
+#define         NAND_CHECKPOINT_FEATURE_STORAGE     (0x1)
+#define         NAND_CHECKPOINT_FEATURE_PLANE       (0x2)
+
+namespace NANDFlashSim {
+
+class NandCheckpoint {
+    std::vector<UINT8>      _vctImage;
+    size_t                  _nCursor;
+    bool                    _bBroken;
+
+public :
+    NandCheckpoint();
+
+    //////////////////////////////////////////////////////////////////////////
+    // serialization
+    //////////////////////////////////////////////////////////////////////////
+    void                    PutBytes(const void *pSrc, size_t nBytes);
+    void                    PutVector(const std::vector<bool> &vctValues);
+    void                    PutPackets(const std::list<NandStagePacket> &lstPackets);
+    void                    PutTransaction(const Transaction &stTrans);
+
+    template <typename T>
+    void                    Put(const T &value)                     { PutBytes(&value, sizeof(T)); }
+
+    template <typename T>
+    void                    PutVector(const std::vector<T> &vctValues)
+    {
+        Put((UINT64)vctValues.size());
+        if(vctValues.empty() == false)
+        {
+            PutBytes(&vctValues[0], sizeof(T) * vctValues.size());
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // deserialization
+    // Containers sized by the device geometry are restored in place, so the 
+    // stored length has to match the current one.
+    //////////////////////////////////////////////////////////////////////////
+    bool                    GetBytes(void *pDst, size_t nBytes);
+    bool                    GetVector(std::vector<bool> &vctValues);
+    bool                    GetPackets(std::list<NandStagePacket> &lstPackets);
+    bool                    GetTransaction(Transaction &stTrans);
+
+    template <typename T>
+    bool                    Get(T &value)                           { return GetBytes(&value, sizeof(T)); }
+
+    template <typename T>
+    bool                    GetVector(std::vector<T> &vctValues)
+    {
+        UINT64 nSize = 0;
+        if(Get(nSize) == false || nSize != vctValues.size())
+        {
+            _bBroken = true;
+            return false;
+        }
+        return (nSize == 0) ? true : GetBytes(&vctValues[0], sizeof(T) * vctValues.size());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // image management
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET                  Store(const char *szPath);
+    NV_RET                  Load(const char *szPath);
+    inline bool             IsBroken()                              { return _bBroken; }
+    inline void             Invalidate()                            { _bBroken = true; }
+    inline size_t           Size()                                  { return _vctImage.size(); }
+};
+
+}
+
+#endif // _NandCheckpoint_h__
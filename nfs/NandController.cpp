@@ -24,6 +24,7 @@
 
 #include "TypeSystem.h"
 #include "Tools.h"
+#include "NandCheckpoint.h"
 #include "ParamManager.h"
 #include "IoCompletion.h"
 #include "Plane.h"
@@ -167,6 +168,10 @@ void NandController::Update(UINT64 nTime)
                 {
                     UINT64 nCycles = _vctCommandChains[nBusIdx].front()._nArrivalCycle;
                     _vctCommandChains[nBusIdx].pop_front();
+                    if(_vctCommandChains[nBusIdx].empty())
+                    {
+                        _vctLuns[nLunIdx].LeaveInterleavedGroup(nDieIdx);
+                    }
                     // interrupt service routine
                     if(_pIsr != NULL && _vctCommandChains[nBusIdx].empty())
                     {
@@ -286,7 +291,51 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
         }
         break;
 
+    case NAND_OP_READ_SPARE:
+        if(_stDevConfig._nSpareSize == 0)
+        {
+            nRet |= NAND_CTRL_ERROR_INVALID_PARAM;
+            break;
+        }
+        nRet |= _stageBuilder.ReadSpare(stagePacket, stTrans._nAddr, stTrans._pData);
+        if(nRet == NAND_SUCCESS)
+        {
+            _vctCommandChains[nBusId].push_back(stagePacket);
+            _vctReadReqStat[nLunId][nBusId]++;
+        }
+        break;
+
+    case NAND_OP_READ_RANDOM:
+        if(_vctnPrevTransOp[nBusId] != NAND_OP_READ_RANDOM)
+        {
+            invalidateOpenAddr(nBusId);
+        }
+
+        if(_vctOpenAddress[nBusId] != stTrans._nAddr)
+        {
+            // the page is sensed first, and then the requested bytes are carried out.
+            nRet |= _stageBuilder.ReadPage(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._nNumsByte);
+        }
+        else
+        {
+            // the page is already in the register, so only the column is changed (05h-E0h) without tR.
+            nRet |= _stageBuilder.ReadRandomColSelection(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._nNumsByte);
+        }
+
+        if(nRet == NAND_SUCCESS)
+        {
+            _vctCommandChains[nBusId].push_back(stagePacket);
+            _vctOpenAddress[nBusId]    = stTrans._nAddr;
+            _vctReadReqStat[nLunId][nBusId]++;
+        }
+        break;
+
     case NAND_OP_READ_CACHE:
+        if(_vctnPrevTransOp[nBusId] != NAND_OP_READ_CACHE)
+        {
+            invalidateOpenAddr(nBusId);
+        }
+
         if(_vctOpenAddress[nBusId] != stTrans._nAddr)
         {
             // start addressing
@@ -322,11 +371,36 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
         if(nRet == NAND_SUCCESS)
         {
             _vctCommandChains[nBusId].push_back(stagePacket);
-            _vctOpenAddress[nBusId]    = stTrans._nAddr + 1;
+            // the cache read can not go on over the last page of the block.
+            _vctOpenAddress[nBusId]    = ((stTrans._nAddr % _stDevConfig._nNumsPgPerBlk) + 1 < _stDevConfig._nNumsPgPerBlk) ? stTrans._nAddr + 1 : NULL_SIG(UINT32);
             _vctReadReqStat[nLunId][nBusId]++;
         }
         break;
 
+    case NAND_OP_READ_MULTIPLANE_RANDOM :
+        {
+            if(_vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE_RANDOM)
+            {
+                invalidateOpenAddr(nBusId);
+            }
+
+            UINT32  nNxPlaneSize    = _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsPlane;
+            UINT32  nPlaneFreeAddr  = (stTrans._nAddr / nNxPlaneSize) * nNxPlaneSize + (stTrans._nAddr % _stDevConfig._nNumsPgPerBlk);
+            if(_vctOpenAddress[nBusId] == nPlaneFreeAddr && _vctPaneIdx[nBusId] == NULL_SIG(UINT16) && _vctAddressedNxPacket[nBusId].empty())
+            {
+                // the pages of all planes are already in the registers. 
+                // change read column (06h-E0h) selects the plane (given by the address) and the column without tR.
+                nRet |= _stageBuilder.ReadNxPlaneSelection(stagePacket, stTrans._nAddr, stTrans._pData, stTrans._nNumsByte, stTrans._nByteOff);
+                if(nRet == NAND_SUCCESS)
+                {
+                    _vctCommandChains[nBusId].push_back(stagePacket);
+                    _vctReadReqStat[nLunId][nBusId]++;
+                }
+                break;
+            }
+        }
+        // otherwise, the pages are addressed and sensed as multi-plane read does.
+        // fall through
     case NAND_OP_READ_MULTIPLANE :
         if(stTrans._bAutoPlaneAddressing == true)
         {
@@ -363,13 +437,18 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
             // processing the stage for the last plane
             if(nRet == NAND_SUCCESS && bLastPlane == true)
             {
-                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE)
+                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != stTrans._nTransOp)
                 {
                     nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
                 }
                 else
                 {
                     _vctCommandChains[nBusId].splice(_vctCommandChains[nBusId].end(), _vctAddressedNxPacket[nBusId]);
+                    if(stTrans._nTransOp == NAND_OP_READ_MULTIPLANE_RANDOM)
+                    {
+                        UINT32  nNxPlaneSize    = _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsPlane;
+                        _vctOpenAddress[nBusId] = (stTrans._nAddr / nNxPlaneSize) * nNxPlaneSize + (stTrans._nAddr % _stDevConfig._nNumsPgPerBlk);
+                    }
                 }
             }
 
@@ -396,19 +475,102 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
             // processing the stage for the last plane
             if(nRet == NAND_SUCCESS && stTrans._bLastPlane == true)
             {
-                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE)
+                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != stTrans._nTransOp)
                 {
                     nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
                 }
                 else
                 {
                     _vctCommandChains[nBusId].splice(_vctCommandChains[nBusId].end(), _vctAddressedNxPacket[nBusId]);
+                    if(stTrans._nTransOp == NAND_OP_READ_MULTIPLANE_RANDOM)
+                    {
+                        UINT32  nNxPlaneSize    = _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsPlane;
+                        _vctOpenAddress[nBusId] = (stTrans._nAddr / nNxPlaneSize) * nNxPlaneSize + (stTrans._nAddr % _stDevConfig._nNumsPgPerBlk);
+                    }
                 }
             }
 
         }
         break;
 
+    case NAND_OP_READ_MULTIPLANE_CACHE :
+        {
+            bool    bLastPlane  = stTrans._bLastPlane;
+            UINT16  nPlane      = NULL_SIG(UINT16);
+            if(stTrans._bAutoPlaneAddressing == true)
+            {
+                // auto plane addressing mode           
+                nPlane              = _vctPaneIdx[nBusId];
+                bLastPlane          = false;
+                if(_vctPaneIdx[nBusId]    == NULL_SIG(UINT16))
+                {
+                    _vctPaneIdx[nBusId] = 0;
+                    nPlane              = 0;
+                }
+                else if(_vctPaneIdx[nBusId] == _stDevConfig._nNumsPlane -1)
+                {
+                    bLastPlane            = true;
+                    _vctPaneIdx[nBusId]   = NULL_SIG(UINT16);
+                }
+
+                if(bLastPlane == false)
+                {
+                    _vctPaneIdx[nBusId]++;
+                }
+            }
+
+            if(_vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE_CACHE)
+            {
+                invalidateOpenAddr(nBusId);
+            }
+
+            // open address keeps the next page of the sequential cache read without plane address.
+            UINT32  nNxPlaneSize    = _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsPlane;
+            UINT32  nPlaneFreeAddr  = (stTrans._nAddr / nNxPlaneSize) * nNxPlaneSize + (stTrans._nAddr % _stDevConfig._nNumsPgPerBlk);
+            if(_vctOpenAddress[nBusId] != nPlaneFreeAddr)
+            {
+                // start addressing, the pages of all planes are sensed by multi-plane read first.
+                nRet |= _stageBuilder.ReadNxPlaneAddAddr(stagePacket, stTrans._nAddr, 0, bLastPlane);
+                if(nPlane != NULL_SIG(UINT16))
+                {
+                    stagePacket._nRow = NAND_SET_PLANE_REGISTER(stagePacket._nRow, nPlane);
+                }
+                if(nRet == NAND_SUCCESS)
+                {
+                    _vctCommandChains[nBusId].push_back(stagePacket);
+                }
+            }
+
+            nRet |= _stageBuilder.ReadNxPlaneCacheSelection(stagePacket, stTrans._nAddr, stTrans._pData, stTrans._nNumsByte, stTrans._nByteOff);
+            if(nPlane != NULL_SIG(UINT16))
+            {
+                stagePacket._nRow = NAND_SET_PLANE_REGISTER(stagePacket._nRow, nPlane);
+            }
+            if(nRet == NAND_SUCCESS)
+            {
+                _vctAddressedNxPacket[nBusId].push_back(stagePacket);
+                _vctReadReqStat[nLunId][nBusId]++;
+            }
+
+            // processing the stage for the last plane
+            if(nRet == NAND_SUCCESS && bLastPlane == true)
+            {
+                if(_vctAddressedNxPacket[nBusId].empty())
+                {
+                    nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
+                }
+                else
+                {
+                    // cache read moves the pages to the cache registers, and then data of each plane are carried out.
+                    nRet |= _stageBuilder.ReadNxPlaneCache(stagePacket, stTrans._nAddr);
+                    _vctCommandChains[nBusId].push_back(stagePacket);
+                    _vctCommandChains[nBusId].splice(_vctCommandChains[nBusId].end(), _vctAddressedNxPacket[nBusId]);
+                    _vctOpenAddress[nBusId] = ((nPlaneFreeAddr % _stDevConfig._nNumsPgPerBlk) + 1 < _stDevConfig._nNumsPgPerBlk) ? nPlaneFreeAddr + 1 : NULL_SIG(UINT32);
+                }
+            }
+        }
+        break;
+
     case NAND_OP_PROG:
         nRet |= _stageBuilder.WritePage(stagePacket,stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._pStatusData, stTrans._nNumsByte);
         if(nRet == NAND_SUCCESS)
@@ -418,6 +580,96 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
         }
         break;
 
+    case NAND_OP_PROG_RANDOM :
+        if(_vctnPrevTransOp[nBusId] != NAND_OP_PROG_RANDOM)
+        {
+            invalidateOpenAddr(nBusId);
+        }
+
+        if(_vctOpenAddress[nBusId] == NULL_SIG(UINT32))
+        {
+            // serial data input (80h) starts assembling the page in the register, and the last request confirms the program (10h).
+            nRet |= _stageBuilder.WritePage(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._pStatusData, stTrans._nNumsByte, true, stTrans._bLastNxSubTrans);
+        }
+        else if(_vctOpenAddress[nBusId] != NULL_SIG(UINT32) && _vctOpenAddress[nBusId] != stTrans._nAddr)
+        {
+            // the page being assembled should be programmed before another page.
+            nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
+        }
+        else
+        {
+            // change write column (85h), and the last request confirms the program (10h).
+            nRet |= _stageBuilder.WriteRandomColSelection(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._pStatusData, stTrans._nNumsByte, stTrans._bLastNxSubTrans);
+        }
+
+        if(nRet == NAND_SUCCESS)
+        {
+            _vctCommandChains[nBusId].push_back(stagePacket);
+            _vctOpenAddress[nBusId]    = (stTrans._bLastNxSubTrans) ? NULL_SIG(UINT32) : stTrans._nAddr;
+            if(stTrans._bLastNxSubTrans)
+            {
+                _vctWriteReqStat[nLunId][nBusId]++;
+            }
+        }
+        break;
+
+    case NAND_OP_PROG_MULTIPLANE_RANDOM :
+        {
+            bool    bLastPlane  = stTrans._bLastPlane;
+            UINT16  nPlane      = NULL_SIG(UINT16);
+            if(stTrans._bAutoPlaneAddressing == true)
+            {
+                // auto plane addressing mode, the plane moves forward when the last request of the plane is given.
+                if(_vctPaneIdx[nBusId]    == NULL_SIG(UINT16))
+                {
+                    _vctPaneIdx[nBusId] = 0;
+                }
+                nPlane              = _vctPaneIdx[nBusId];
+                bLastPlane          = (nPlane == _stDevConfig._nNumsPlane -1);
+            }
+
+            if(_vctnPrevTransOp[nBusId] != NAND_OP_PROG_MULTIPLANE_RANDOM)
+            {
+                invalidateOpenAddr(nBusId);
+            }
+
+            if(_vctOpenAddress[nBusId] == NULL_SIG(UINT32))
+            {
+                // serial data input (80h) for the plane, the last request of the plane confirms as the column change does.
+                nRet |= _stageBuilder.WriteNxPlaneForRandom(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._nNumsByte, stTrans._pStatusData,
+                                                            (stTrans._bLastNxSubTrans && !bLastPlane), (stTrans._bLastNxSubTrans && bLastPlane));
+            }
+            else if(_vctOpenAddress[nBusId] != NULL_SIG(UINT32) && _vctOpenAddress[nBusId] != stTrans._nAddr)
+            {
+                nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
+            }
+            else
+            {
+                // change write column (85h), the last request of the plane confirms with 11h (10h for the last plane).
+                nRet |= _stageBuilder.WriteNxPlaneRandomColSelection(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._pStatusData, stTrans._nNumsByte, 
+                                                                     (stTrans._bLastNxSubTrans && !bLastPlane), (stTrans._bLastNxSubTrans && bLastPlane));
+            }
+            if(nPlane != NULL_SIG(UINT16))
+            {
+                stagePacket._nRow = NAND_SET_PLANE_REGISTER(stagePacket._nRow, nPlane);
+            }
+
+            if(nRet == NAND_SUCCESS)
+            {
+                _vctCommandChains[nBusId].push_back(stagePacket);
+                _vctOpenAddress[nBusId]    = (stTrans._bLastNxSubTrans) ? NULL_SIG(UINT32) : stTrans._nAddr;
+                if(stTrans._bLastNxSubTrans)
+                {
+                    _vctWriteReqStat[nLunId][nBusId]++;
+                    if(nPlane != NULL_SIG(UINT16))
+                    {
+                        _vctPaneIdx[nBusId] = (bLastPlane) ? NULL_SIG(UINT16) : _vctPaneIdx[nBusId] + 1;
+                    }
+                }
+            }
+        }
+        break;
+
     case NAND_OP_PROG_CACHE :
         nRet |= _stageBuilder.WritePageCache(stagePacket, stTrans._nAddr, stTrans._nByteOff, stTrans._pData, stTrans._pStatusData);
         if(nRet == NAND_SUCCESS)
@@ -513,7 +765,7 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
         if(nRet == NAND_SUCCESS)
         {
             _vctCommandChains[nBusId].push_back(stagePacket);
-            _vctReadReqStat[nLunId][nBusId]++;
+            _vctWriteReqStat[nLunId][nBusId]++;
         }
         break;
 
@@ -536,15 +788,15 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
 
             nRet |= _stageBuilder.ReadInternalPageNxPlane(stagePacket, stTrans._nAddr, bLastPlane);
             stagePacket._nRow = NAND_SET_PLANE_REGISTER(stagePacket._nRow, nPlane);
-            UINT32  nRow = stagePacket._nRow;
             if(nRet == NAND_SUCCESS)
             {
                 _vctCommandChains[nBusId].push_back(stagePacket);
                 _vctReadReqStat[nLunId][nBusId]++;
             }
 
+            // copyback programs the page register of the plane, so that the destination is on the same plane.
             nRet |= _stageBuilder.WriteInternalPageNxPlane(stagePacket, stTrans._nDestAddr, stTrans._pStatusData, bLastPlane);
-            stagePacket._nRow = nRow;
+            stagePacket._nRow = NAND_SET_PLANE_REGISTER(stagePacket._nRow, nPlane);
             if(nRet == NAND_SUCCESS)
             {
                 _vctAddressedNxPacket[nBusId].push_back(stagePacket);
@@ -554,7 +806,7 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
             // processing the stage for the last plane
             if(nRet == NAND_SUCCESS && bLastPlane == true)
             {
-                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE)
+                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != stTrans._nTransOp)
                 {
                     nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
                 }
@@ -580,7 +832,7 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
                 _vctReadReqStat[nLunId][nBusId]++;
             }
 
-            nRet |= _stageBuilder.WriteInternalPageNxPlane(stagePacket, stTrans._nAddr, stTrans._pStatusData, stTrans._bLastPlane);
+            nRet |= _stageBuilder.WriteInternalPageNxPlane(stagePacket, stTrans._nDestAddr, stTrans._pStatusData, stTrans._bLastPlane);
             if(nRet == NAND_SUCCESS)
             {
                 _vctAddressedNxPacket[nBusId].push_back(stagePacket);
@@ -590,7 +842,7 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
             // processing the stage for the last plane
             if(nRet == NAND_SUCCESS && stTrans._bLastPlane == true)
             {
-                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != NAND_OP_READ_MULTIPLANE)
+                if(_vctAddressedNxPacket[nBusId].empty() || _vctnPrevTransOp[nBusId] != stTrans._nTransOp)
                 {
                     nRet |= NAND_CTRL_ERROR_UNDEFINED_ORDER;
                 }
@@ -651,10 +903,13 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
     if(nRet == NAND_SUCCESS)
     {
         _vctnPrevTransOp[nBusId] = stTrans._nTransOp;
-        if(stTrans._nTransOp != NAND_OP_READ_CACHE)
+        if(stTrans._nTransOp != NAND_OP_READ_CACHE && stTrans._nTransOp != NAND_OP_READ_MULTIPLANE_CACHE &&
+           stTrans._nTransOp != NAND_OP_READ_RANDOM && stTrans._nTransOp != NAND_OP_READ_MULTIPLANE_RANDOM &&
+           stTrans._nTransOp != NAND_OP_PROG_RANDOM && stTrans._nTransOp != NAND_OP_PROG_MULTIPLANE_RANDOM)
         {
             invalidateOpenAddr(nBusId);
         }
+        formInterleavedGroup(nLunId, nDieId, stTrans._nTransOp);
         // patch the first stage from stage chain with delta time.
         Update(ZERO_TIME);
 
@@ -666,6 +921,68 @@ NV_RET NandController::BuildandAddStage( Transaction &stTrans )
     return nRet;
 }
 
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    formInterleavedGroup
+// FullName:  NandController::formInterleavedGroup
+// Access:    private 
+// Returns:   void
+// Parameter: UINT16 nLunId
+// Parameter: UINT16 nDieId
+// Parameter: NAND_TRANS_OP nTransOp
+//
+// Descriptions -
+// Group the transactions queued on dies of a LUN into an interleaved die command 
+// (NAND_INTERLEAVED_DIE_COMMAND) if they have the same operation.
+// The LUN issues the command sequences of a group back-to-back, so that array times of 
+// the dies overlap, and drains the data outputs with as few LUN selections as possible.
+// A die leaves the group when its command chain is completed.
+//////////////////////////////////////////////////////////////////////////////
+void NandController::formInterleavedGroup(UINT16 nLunId, UINT16 nDieId, NAND_TRANS_OP nTransOp)
+{
+    NAND_INTERLEAVED_DIE_COMMAND eCmd = NAND_MULTIDIE_NONE;
+    switch(nTransOp)
+    {
+    case NAND_OP_READ :
+        eCmd = NAND_MULTIDIE_READ;
+        break;
+    case NAND_OP_READ_MULTIPLANE :
+        eCmd = NAND_MULTIDIE_MULTIPLANE_READ;
+        break;
+    case NAND_OP_READ_MULTIPLANE_CACHE :
+        eCmd = NAND_MULTIDIE_MULTIPLANE_CACHE_READ;
+        break;
+    case NAND_OP_PROG :
+        eCmd = NAND_MUTILDIE_PROG;
+        break;
+    case NAND_OP_PROG_MULTIPLANE :
+        eCmd = NAND_MULTIDIE_MULTIPLANE_PROG;
+        break;
+    case NAND_OP_PROG_MULTIPLANE_CACHE :
+        eCmd = NAND_MULTIDIE_MULTIPLANE_CACHE_PROG;
+        break;
+    default :
+        break;
+    }
+
+    if(eCmd == NAND_MULTIDIE_NONE || _vctCommandChains[nLunId * _stDevConfig._nNumsDie + nDieId].empty())
+    {
+        return;
+    }
+
+    for(UINT16 nOtherIdx = 0; nOtherIdx < _stDevConfig._nNumsDie; nOtherIdx++)
+    {
+        UINT32 nOtherBusId = nLunId * _stDevConfig._nNumsDie + nOtherIdx;
+        if(nOtherIdx == nDieId || _vctCommandChains[nOtherBusId].empty() || _vctnPrevTransOp[nOtherBusId] != nTransOp)
+        {
+            continue;
+        }
+
+        _vctLuns[nLunId].JoinInterleavedGroup((UINT8)nOtherIdx, eCmd);
+        _vctLuns[nLunId].JoinInterleavedGroup((UINT8)nDieId, eCmd);
+    }
+}
+
 NandController::~NandController()
 {
     delete _pIsr;
@@ -699,6 +1016,11 @@ void NandController::ReportPerformance()
         nBandwidth = (nAccumluatedTraffic != 0) ? ((float)nAccumluatedTraffic / ((float)(_nCurrentTime - _vctLunLevelHostIdleTime[nLunIdx] - TickOverTime()) / 1000000.0f)) : 0;
         cout << "LUN resource utilization (%)                 :" <<  (((float)(_nCurrentTime - _vctLunLevelHostIdleTime[nLunIdx])*100) / (float)_nCurrentTime) << endl;
         cout << "LUN resource utilization including idle (%)  :" <<  (((float)(_nCurrentTime - _vctLunLevelHostIdleTime[nLunIdx] - TickOverTime())*100) / (float)_nCurrentTime) << endl;
+        cout << "LUN selections (78h) for bus handoff         :" << dec << _vctLuns[nLunIdx].GetLunSelectCount() << endl;
+        if(NFS_GET_PARAM(IDV_POWER_BUDGET) != 0)
+        {
+            cout << "Array tasks delayed by power budget          :" << dec << _vctLuns[nLunIdx].GetPowerThrottleCount() << endl;
+        }
         cout << "The amount of requests (Bytes)               :" << dec <<  nAccumluatedTraffic << endl << endl;        
         
 
@@ -730,6 +1052,20 @@ void NandController::ReportPerformance()
             cout << "Die resource utilization (%)                 :" <<  nUtil << endl;
             cout << "Die resource contention time                 :" << _vctResourceContentionTime[nLunIdx][nDieIdx] << endl;
             cout << "Die resource contention ratio (%)            :" << ((float)_vctResourceContentionTime[nLunIdx][nDieIdx] * 100) / (float) _nCurrentTime << endl;
+            if(NFS_GET_PARAM(ILV_READ_RETRY) != 0)
+            {
+                cout << "Die the number of read retries               :" << _vctLuns[nLunIdx].GetReadRetryCount(nDieIdx) << endl;
+            }
+            if(_vctLuns[nLunIdx].GetStaleReadCount(nDieIdx) != 0)
+            {
+                cout << "Die stale page reads                         :" << _vctLuns[nLunIdx].GetStaleReadCount(nDieIdx) << endl;
+            }
+            if(NFS_GET_PARAM(IDV_POWER_BUDGET) != 0)
+            {
+                // the time which the die lost waiting for the array currents of the other dies.
+                cout << "Die power capping stall time                 :" << _vctLuns[nLunIdx].GetPowerStallTime(nDieIdx) << endl;
+                cout << "Die power capping stall ratio (%)            :" << ((float)_vctLuns[nLunIdx].GetPowerStallTime(nDieIdx) * 100) / (float) _nCurrentTime << endl;
+            }
             cout << endl;
         }
     }
@@ -800,4 +1136,84 @@ UINT64 NandController::GetActiveCellTime( UINT32 nLunId, UINT32 nDieId )
     nBusTime += _vctLuns[nLunId].GetAccumulatedFSMTime(NAND_FSM_ERASE, nDieId);
     return nBusTime;
 }
-} 
\ No newline at end of file
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Save
+// FullName:  NandController::Save
+// Access:    public 
+// Returns:   void
+// Parameter: NandCheckpoint & ckpt
+//
+// Descriptions -
+// Serialize command chains, per-bus protocol state and statistics, followed 
+// by every LUN underneath.
+//////////////////////////////////////////////////////////////////////////////
+void NandController::Save( NandCheckpoint &ckpt )
+{
+    UINT32 nMaxBuses    = _stDevConfig._nNumsLun * _stDevConfig._nNumsDie;
+
+    ckpt.Put(_nCurrentTime);
+    ckpt.Put(_nFineGrainTransId);
+    ckpt.Put(_nMinNextActivate);
+    ckpt.Put(_nBubbleTime);
+    ckpt.Put(_nIdleTime);
+
+    for(UINT32 nBusId = 0; nBusId < nMaxBuses; nBusId++)
+    {
+        ckpt.PutPackets(_vctCommandChains[nBusId]);
+        ckpt.PutPackets(_vctAddressedNxPacket[nBusId]);
+    }
+    ckpt.PutVector(_vctnPrevNandCmd);
+    ckpt.PutVector(_vctnPrevTransOp);
+    ckpt.PutVector(_vctTransCompletion);
+    ckpt.PutVector(_vctOpenAddress);
+    ckpt.PutVector(_vctPaneIdx);
+    ckpt.PutVector(_vctLunLevelHostIdleTime);
+
+    for(UINT16  nLunIdx = 0; nLunIdx < _stDevConfig._nNumsLun; nLunIdx++)
+    {
+        ckpt.PutVector(_vctDieLevelNandClockIdleTime[nLunIdx]);
+        ckpt.PutVector(_vctDieLevelHostClockIdleTime[nLunIdx]);
+        ckpt.PutVector(_vctResourceContentionTime[nLunIdx]);
+        ckpt.PutVector(_vctReadReqStat[nLunIdx]);
+        ckpt.PutVector(_vctWriteReqStat[nLunIdx]);
+        ckpt.PutVector(_vctEraseReqStat[nLunIdx]);
+        _vctLuns[nLunIdx].Save(ckpt);
+    }
+}
+
+void NandController::Restore( NandCheckpoint &ckpt )
+{
+    UINT32 nMaxBuses    = _stDevConfig._nNumsLun * _stDevConfig._nNumsDie;
+
+    ckpt.Get(_nCurrentTime);
+    ckpt.Get(_nFineGrainTransId);
+    ckpt.Get(_nMinNextActivate);
+    ckpt.Get(_nBubbleTime);
+    ckpt.Get(_nIdleTime);
+
+    for(UINT32 nBusId = 0; nBusId < nMaxBuses; nBusId++)
+    {
+        ckpt.GetPackets(_vctCommandChains[nBusId]);
+        ckpt.GetPackets(_vctAddressedNxPacket[nBusId]);
+    }
+    ckpt.GetVector(_vctnPrevNandCmd);
+    ckpt.GetVector(_vctnPrevTransOp);
+    ckpt.GetVector(_vctTransCompletion);
+    ckpt.GetVector(_vctOpenAddress);
+    ckpt.GetVector(_vctPaneIdx);
+    ckpt.GetVector(_vctLunLevelHostIdleTime);
+
+    for(UINT16  nLunIdx = 0; nLunIdx < _stDevConfig._nNumsLun; nLunIdx++)
+    {
+        ckpt.GetVector(_vctDieLevelNandClockIdleTime[nLunIdx]);
+        ckpt.GetVector(_vctDieLevelHostClockIdleTime[nLunIdx]);
+        ckpt.GetVector(_vctResourceContentionTime[nLunIdx]);
+        ckpt.GetVector(_vctReadReqStat[nLunIdx]);
+        ckpt.GetVector(_vctWriteReqStat[nLunIdx]);
+        ckpt.GetVector(_vctEraseReqStat[nLunIdx]);
+        _vctLuns[nLunIdx].Restore(ckpt);
+    }
+}
+
+}
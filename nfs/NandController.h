@@ -39,6 +39,7 @@
 namespace NANDFlashSim {
 
 class NandFlashSystem;
+class NandCheckpoint;
 
 class NandController {
     std::vector<LogicalUnit>                    _vctLuns;
@@ -72,6 +73,7 @@ class NandController {
 private :
     inline UINT32           genFineGrainTransId()                   { return _nFineGrainTransId++; }
     inline void             invalidateOpenAddr(UINT32 nBusId)       { _vctOpenAddress[nBusId] = NULL_SIG(UINT32); }
+    void                    formInterleavedGroup(UINT16 nLunId, UINT16 nDieId, NAND_TRANS_OP nTransOp);
 public :
     void                    SetSystemIsr(NandSystemIsr *pIsr)       { _pIsr = pIsr; }
     NV_RET                  BuildandAddStage(Transaction &stTrans);
@@ -88,6 +90,18 @@ public :
     UINT64                  MinIoBusActivity();
 
     void                    HardReset(UINT32 nSystemClock, NandDeviceConfig &stDevConfig);
+    void                    Save(NandCheckpoint &ckpt);
+    void                    Restore(NandCheckpoint &ckpt);
+    NV_RET                  Precondition(UINT32 nLunId, UINT8 nDie, UINT8 nPlane, UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature)
+                                                                    { return _vctLuns[nLunId].Precondition(nDie, nPlane, nPbn, nProgrammedPgs, nEc, pSignature); }
+    NV_RET                  BlockMode(UINT32 nLunId, UINT8 nDie, UINT8 nPlane, UINT16 nPbn, NAND_BLOCK_MODE eMode)
+                                                                    { return _vctLuns[nLunId].BlockMode(nDie, nPlane, nPbn, eMode); }
+    NAND_BLOCK_MODE         BlockMode(UINT32 nLunId, UINT8 nDie, UINT8 nPlane, UINT16 nPbn)
+                                                                    { return _vctLuns[nLunId].BlockMode(nDie, nPlane, nPbn); }
+    UINT32                  EraseCount(UINT32 nLunId, UINT8 nDie, UINT8 nPlane, UINT16 nPbn)
+                                                                    { return _vctLuns[nLunId].EraseCount(nDie, nPlane, nPbn); }
+    NV_RET                  Deallocate(UINT32 nLunId, UINT8 nDie, UINT8 nPlane, UINT16 nPbn, UINT32 nPgoff)
+                                                                    { return _vctLuns[nLunId].Deallocate(nDie, nPlane, nPbn, nPgoff); }
     
     void                    ReportPerformance();
     void                    ReportStatistics();
@@ -34,6 +34,7 @@
 
 #include "TypeSystem.h"
 #include "Tools.h"
+#include "NandCheckpoint.h"
 #include "NandLogger.h"
 #include "ParamManager.h"
 #include "IoCompletion.h"
@@ -80,7 +81,7 @@ NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTran
     nandTrans._nAddr            = nSrcAddr;
     nandTrans._nDestAddr        = nDestAddr;
     nandTrans._nByteOff         = 0;
-    nandTrans._nNumsByte        = _stDevConfig._nPgSize;
+    nandTrans._nNumsByte        = NAND_FULL_PAGE_SIZE(_stDevConfig);
 
     return AddTransaction(nandTrans);
 }
@@ -96,6 +97,7 @@ NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTran
     UINT32  nBusId  = nLun * nDieId + nDieId;
 
     if (nTransOp == NAND_OP_PROG_MULTIPLANE_CACHE || 
+        nTransOp == NAND_OP_PROG_RANDOM ||
         nTransOp == NAND_OP_PROG_MULTIPLANE_RANDOM )
     {
         // For using these operations, a host model have to leverage AddTransaction function with lastRequest flag or with transaction data structure.
@@ -115,7 +117,7 @@ NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTran
 
     if (_vctIncomingTrans[nBusId]._nTransOp != NAND_OP_NOT_DETERMINED)
     {
-        if(nTransOp == NAND_OP_READ || nTransOp == NAND_OP_PROG )
+        if(nTransOp == NAND_OP_READ || nTransOp == NAND_OP_READ_SPARE || nTransOp == NAND_OP_PROG )
         {
             // single plane operation
             bBusy   = true;
@@ -141,7 +143,7 @@ NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTran
         nandTrans._nTransOp     = nTransOp;
         nandTrans._nAddr        = nAddr;
         nandTrans._nByteOff     = 0;
-        nandTrans._nNumsByte    = _stDevConfig._nPgSize;
+        nandTrans._nNumsByte    = NAND_FULL_PAGE_SIZE(_stDevConfig);
 
         nRet |= _controller.BuildandAddStage(nandTrans);
         
@@ -171,7 +173,7 @@ NV_RET NandFlashSystem::AddTransaction( Transaction &nandTrans )
 
     if (_vctIncomingTrans[nBusId]._nTransOp != NAND_OP_NOT_DETERMINED)
     {
-        if(nandTrans._nTransOp == NAND_OP_READ || nandTrans._nTransOp == NAND_OP_PROG )
+        if(nandTrans._nTransOp == NAND_OP_READ || nandTrans._nTransOp == NAND_OP_READ_SPARE || nandTrans._nTransOp == NAND_OP_PROG )
         {
             // single plane operation
             bBusy   = true;
@@ -211,7 +213,9 @@ NV_RET NandFlashSystem::AddTransaction( Transaction &nandTrans )
 // Parameter: bool bLastRequest
 //
 // Descriptions -
-// This function is used for NAND_OP_PROG_MULTIPLANE_CACHE or NAND_OP_PROG_MULTIPLANE_RANDOM
+// This function is used for NAND_OP_PROG_MULTIPLANE_CACHE, NAND_OP_PROG_RANDOM or NAND_OP_PROG_MULTIPLANE_RANDOM.
+// For the random operations, bLastRequest marks the last data input for the page (the plane in multi-plane mode),
+// and the Transaction interface can give the column and the length of each data input.
 //////////////////////////////////////////////////////////////////////////////
 NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nAddr, bool bLastRequest)
 {
@@ -221,12 +225,56 @@ NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTran
     nandTrans._nTransOp         = nTransOp;
     nandTrans._nAddr            = nAddr;
     nandTrans._nByteOff         = 0;
-    nandTrans._nNumsByte        = _stDevConfig._nPgSize;
+    nandTrans._nNumsByte        = NAND_FULL_PAGE_SIZE(_stDevConfig);
     nandTrans._bLastNxSubTrans  = bLastRequest;
 
     return AddTransaction(nandTrans);
 }
 
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    AddTransaction
+// FullName:  NandFlashSystem::AddTransaction
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nHostTransId
+// Parameter: NAND_TRANS_OP nTransOp
+// Parameter: UINT32 nAddr
+// Parameter: UINT32 nByteOff
+// Parameter: UINT32 nNumsByte
+//
+// Descriptions -
+// Sub-page read which carries out nNumsByte bytes from nByteOff of the page, 
+// so that only the requested bytes occupy the I/O bus.
+// This function is used for NAND_OP_READ, NAND_OP_READ_RANDOM or NAND_OP_READ_MULTIPLANE_RANDOM.
+// The random operations change the column (05h-E0h or 06h-E0h) without tR when the page 
+// has been sensed by the previous transaction of the same operation.
+// A range running beyond the page (including the spare area) returns NAND_CTRL_ERROR_IOLENGTH.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nAddr, UINT32 nByteOff, UINT32 nNumsByte)
+{
+    if(nTransOp != NAND_OP_READ && nTransOp != NAND_OP_READ_RANDOM && nTransOp != NAND_OP_READ_MULTIPLANE_RANDOM)
+    {
+        return NAND_FLASH_ERROR_UNSUPPORTED;
+    }
+
+    if(nByteOff > NAND_FULL_PAGE_SIZE(_stDevConfig) || nNumsByte > NAND_FULL_PAGE_SIZE(_stDevConfig) - nByteOff)
+    {
+        // the stage builder only asserts the column; reject a range beyond the page before any stage is built.
+        return NAND_CTRL_ERROR_IOLENGTH;
+    }
+
+    Transaction         nandTrans;
+
+    nandTrans._nHostTransId     = nHostTransId;
+    nandTrans._nTransOp         = nTransOp;
+    nandTrans._nAddr            = nAddr;
+    nandTrans._nByteOff         = nByteOff;
+    nandTrans._nNumsByte        = nNumsByte;
+
+    return AddTransaction(nandTrans);
+}
+
 
 //////////////////////////////////////////////////////////////////////////////// 
 //
@@ -497,12 +545,19 @@ void NandFlashSystem::ReportConfiguration( void )
     cout   << "NAND flash device configurations ***********************"<< endl;
     cout   << "Device ID            : " << hex << "0x"<< _stDevConfig._nDeviceId        << endl; 
     cout   << "Page size            : " << _stDevConfig._nPgSize        << endl; 
+    cout   << "Spare size           : " << _stDevConfig._nSpareSize     << endl; 
     cout   << "# of pages per block : " << _stDevConfig._nNumsPgPerBlk  << endl; 
     cout   << "# of blocks          : " << _stDevConfig._nNumsBlk       << endl; 
     cout   << "# of planes          : " << _stDevConfig._nNumsPlane     << endl; 
     cout   << "# of dies            : " << _stDevConfig._nNumsDie     << endl; 
     cout   << "# of I/O pins        : " << _stDevConfig._nNumsIoPins << endl; 
     cout   << "NOP                  : " << _stDevConfig._nNop << endl; 
+    cout   << "Interface mode       : " << dec << NFS_GET_PARAM(ISV_INTERFACE_MODE) << endl; 
+    cout   << "Data rate (MT/s)     : " << dec << NFS_GET_PARAM(ISV_DATA_RATE) << endl; 
+    cout   << "# of page types      : " << dec << NFS_GET_PARAM(IPV_NUMS_TYPES) << (NFS_GET_PARAM(IPV_ONESHOT) ? " (one-shot program)" : "") << endl; 
+    cout   << "SLC mode block pages : " << dec << _stDevConfig._nNumsSlcPgPerBlk << endl; 
+    cout   << "Read retry model     : " << (NFS_GET_PARAM(ILV_READ_RETRY) ? "enabled" : "disabled") << endl; 
+    cout   << "Power budget         : " << dec << NFS_GET_PARAM(IDV_POWER_BUDGET) << (NFS_GET_PARAM(IDV_POWER_BUDGET) ? "" : " (unlimited)") << endl; 
     cout   << "Max erase count      : " << dec <<_stDevConfig._nEc << endl << endl; 
 
 
@@ -674,4 +729,273 @@ void NandFlashSystem::UpdateBackToBackWithoutTickOver( UINT64 nCycles )
         _controller.Update(nCycles * nClockPeriods);
     }
 }
-}
\ No newline at end of file
+UINT32 NandFlashSystem::checkpointFeatures()
+{
+    UINT32 nFeatures = 0;
+#ifndef NO_STORAGE
+    nFeatures |= NAND_CHECKPOINT_FEATURE_STORAGE;
+#endif
+#ifndef WITHOUT_PLANE_STATS
+    nFeatures |= NAND_CHECKPOINT_FEATURE_PLANE;
+#endif
+    return nFeatures;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Save
+// FullName:  NandFlashSystem::Save
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: const char * szPath
+//
+// Descriptions -
+// Save the whole device state (plane metadata and data, die registers/FSM,
+// controller queues and statistics) into a versioned binary image.
+// Host buffers of in-flight transactions are not saved; take a checkpoint 
+// when IsActiveMode() is false if the transactions need to be replayed.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::Save( const char *szPath )
+{
+    NandCheckpoint  ckpt;
+
+    ckpt.Put((UINT32)NAND_CHECKPOINT_MAGIC);
+    ckpt.Put((UINT32)NAND_CHECKPOINT_VERSION);
+    ckpt.Put(checkpointFeatures());
+    ckpt.Put(_stDevConfig._nPgSize);
+    ckpt.Put(_stDevConfig._nSpareSize);
+    ckpt.Put(_stDevConfig._nNumsPgPerBlk);
+    ckpt.Put(_stDevConfig._nNumsBlk);
+    ckpt.Put(_stDevConfig._nNumsPlane);
+    ckpt.Put(_stDevConfig._nNumsDie);
+    ckpt.Put((UINT32)_stDevConfig._nNumsLun);
+
+    ckpt.Put(_nCurrentTime);
+    for(std::vector<Transaction>::iterator iTrans = _vctIncomingTrans.begin(); iTrans != _vctIncomingTrans.end(); ++iTrans)
+    {
+        ckpt.PutTransaction(*iTrans);
+    }
+    _controller.Save(ckpt);
+
+    return ckpt.Store(szPath);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Restore
+// FullName:  NandFlashSystem::Restore
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: const char * szPath
+//
+// Descriptions -
+// Restore an image written by Save. The image must come from a build with the 
+// same storage/plane options and from the same device geometry. If the image
+// turns out to be truncated in the middle of restoring, the system is left in
+// a partially restored state and needs a HardReset.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::Restore( const char *szPath )
+{
+    NandCheckpoint  ckpt;
+    NV_RET          nRet = ckpt.Load(szPath);
+    if(nRet != NAND_SUCCESS)
+    {
+        return nRet;
+    }
+
+    UINT32  nMagic = 0, nVersion = 0, nFeatures = 0;
+    UINT32  nPgSize = 0, nSpareSize = 0, nNumsPgPerBlk = 0, nNumsBlk = 0, nNumsPlane = 0, nNumsDie = 0, nNumsLun = 0;
+    ckpt.Get(nMagic);
+    ckpt.Get(nVersion);
+    ckpt.Get(nFeatures);
+    ckpt.Get(nPgSize);
+    ckpt.Get(nSpareSize);
+    ckpt.Get(nNumsPgPerBlk);
+    ckpt.Get(nNumsBlk);
+    ckpt.Get(nNumsPlane);
+    ckpt.Get(nNumsDie);
+    ckpt.Get(nNumsLun);
+
+    if(ckpt.IsBroken() || nMagic != NAND_CHECKPOINT_MAGIC || nVersion != NAND_CHECKPOINT_VERSION)
+    {
+        NV_ERROR("unknown checkpoint format : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+
+    if(nFeatures != checkpointFeatures() || 
+        nPgSize != _stDevConfig._nPgSize || nSpareSize != _stDevConfig._nSpareSize || nNumsPgPerBlk != _stDevConfig._nNumsPgPerBlk ||
+        nNumsBlk != _stDevConfig._nNumsBlk || nNumsPlane != _stDevConfig._nNumsPlane ||
+        nNumsDie != _stDevConfig._nNumsDie || nNumsLun != _stDevConfig._nNumsLun)
+    {
+        NV_ERROR("checkpoint was taken from a different device configuration : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+
+    ckpt.Get(_nCurrentTime);
+    for(std::vector<Transaction>::iterator iTrans = _vctIncomingTrans.begin(); iTrans != _vctIncomingTrans.end(); ++iTrans)
+    {
+        ckpt.GetTransaction(*iTrans);
+    }
+    _controller.Restore(ckpt);
+
+    if(ckpt.IsBroken())
+    {
+        NV_ERROR("checkpoint is truncated : " << szPath);
+        return NAND_FLASH_ERROR_CHECKPOINT;
+    }
+    return NAND_SUCCESS;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Precondition
+// FullName:  NandFlashSystem::Precondition
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nStartAddr
+// Parameter: UINT32 nNumsBlk
+// Parameter: UINT32 nProgrammedPgs
+// Parameter: std::vector<UINT32> & vctEcDist
+// Parameter: UINT8 * pSignature
+//
+// Descriptions -
+// Bulk initialization for steady-state experiments. Starting from the block
+// that contains nStartAddr, nNumsBlk blocks (in the same order as the address
+// space of AddTransaction) are marked as programmed up to nProgrammedPgs pages.
+// The erase count of the i-th block is vctEcDist[i % vctEcDist.size()], or 0 if
+// the distribution is empty. pSignature (one page) is copied to every 
+// programmed page when storage is enabled.
+// Stages are not built and no time elapses, so this should be called while 
+// the system is not in the active mode.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::Precondition( UINT32 nStartAddr, UINT32 nNumsBlk, UINT32 nProgrammedPgs, std::vector<UINT32> &vctEcDist, UINT8 *pSignature )
+{
+    NV_RET  nRet        = NAND_SUCCESS;
+    UINT32  nTotalBlk   = _stDevConfig._nNumsBlk * _stDevConfig._nNumsPlane * _stDevConfig._nNumsDie;
+    UINT32  nStartBlk   = nStartAddr / _stDevConfig._nNumsPgPerBlk;
+
+    if(IsActiveMode())
+    {
+        return NAND_FLASH_ERROR_BUSY;
+    }
+
+    if(nStartBlk >= nTotalBlk || nNumsBlk > nTotalBlk - nStartBlk || nProgrammedPgs > _stDevConfig._nNumsPgPerBlk)
+    {
+        return NAND_SYS_ERROR_ADDRESS;
+    }
+
+    for(UINT32 nIdx = 0; nIdx < nNumsBlk; nIdx++)
+    {
+        UINT32  nBlk    = nStartBlk + nIdx;
+        UINT8   nPlane  = nBlk % _stDevConfig._nNumsPlane;
+        UINT16  nPbn    = (nBlk / _stDevConfig._nNumsPlane) % _stDevConfig._nNumsBlk;
+        UINT8   nDie    = nBlk / (_stDevConfig._nNumsPlane * _stDevConfig._nNumsBlk);
+        UINT32  nEc     = vctEcDist.empty() ? 0 : vctEcDist[nIdx % vctEcDist.size()];
+
+        nRet |= _controller.Precondition(0, nDie, nPlane, nPbn, nProgrammedPgs, nEc, pSignature);
+    }
+
+    return nRet;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    SetBlockMode
+// FullName:  NandFlashSystem::SetBlockMode
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nAddr
+// Parameter: NAND_BLOCK_MODE eMode
+//
+// Descriptions -
+// Choose the cell mode of the block that contains nAddr (the address space of
+// AddTransaction). The block has to be erased. Array operations of SLC mode 
+// blocks take SLC.tPROG, SLC.tR and SLC.tBERS, and only the first SLC.NUMS_PAGES
+// pages of such a block can be programmed (see GetUsablePages).
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::SetBlockMode( UINT32 nAddr, NAND_BLOCK_MODE eMode )
+{
+    UINT32  nBlk    = nAddr / _stDevConfig._nNumsPgPerBlk;
+    if(nBlk >= _stDevConfig._nNumsBlk * _stDevConfig._nNumsPlane * _stDevConfig._nNumsDie)
+    {
+        return NAND_SYS_ERROR_ADDRESS;
+    }
+
+    return _controller.BlockMode(0, nBlk / (_stDevConfig._nNumsPlane * _stDevConfig._nNumsBlk), nBlk % _stDevConfig._nNumsPlane,
+                                 (nBlk / _stDevConfig._nNumsPlane) % _stDevConfig._nNumsBlk, eMode);
+}
+
+NAND_BLOCK_MODE NandFlashSystem::GetBlockMode( UINT32 nAddr )
+{
+    UINT32  nBlk    = nAddr / _stDevConfig._nNumsPgPerBlk;
+    assert(nBlk < _stDevConfig._nNumsBlk * _stDevConfig._nNumsPlane * _stDevConfig._nNumsDie);
+
+    return _controller.BlockMode(0, nBlk / (_stDevConfig._nNumsPlane * _stDevConfig._nNumsBlk), nBlk % _stDevConfig._nNumsPlane,
+                                 (nBlk / _stDevConfig._nNumsPlane) % _stDevConfig._nNumsBlk);
+}
+
+UINT32 NandFlashSystem::GetUsablePages( UINT32 nAddr )
+{
+    return (GetBlockMode(nAddr) == NAND_BLOCK_SLC) ? _stDevConfig._nNumsSlcPgPerBlk : _stDevConfig._nNumsPgPerBlk;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    GetEraseCount
+// FullName:  NandFlashSystem::GetEraseCount
+// Access:    public 
+// Returns:   UINT32
+// Parameter: UINT32 nAddr
+//
+// Descriptions -
+// The erase count of the block that contains nAddr (the address space of AddTransaction),
+// which a wear leveling policy reads without going through the FSM. 
+// It is always zero if the plane statistics are disabled (WITHOUT_PLANE_STATS).
+//////////////////////////////////////////////////////////////////////////////
+UINT32 NandFlashSystem::GetEraseCount( UINT32 nAddr )
+{
+    UINT32  nBlk    = nAddr / _stDevConfig._nNumsPgPerBlk;
+    assert(nBlk < _stDevConfig._nNumsBlk * _stDevConfig._nNumsPlane * _stDevConfig._nNumsDie);
+
+    return _controller.EraseCount(0, nBlk / (_stDevConfig._nNumsPlane * _stDevConfig._nNumsBlk), nBlk % _stDevConfig._nNumsPlane,
+                                  (nBlk / _stDevConfig._nNumsPlane) % _stDevConfig._nNumsBlk);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Deallocate
+// FullName:  NandFlashSystem::Deallocate
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nAddr
+// Parameter: UINT32 nNumsPg
+//
+// Descriptions -
+// Mark nNumsPg pages from nAddr (the address space of AddTransaction) stale, as 
+// the host has deallocated their data. It takes no flash operation and no time; 
+// a later read of a stale page returns zero without going to the storage of 
+// the plane, until the page is programmed again or its block is erased.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFlashSystem::Deallocate( UINT32 nAddr, UINT32 nNumsPg )
+{
+    NV_RET  nRet        = NAND_SUCCESS;
+    UINT32  nTotalPg    = _stDevConfig._nNumsBlk * _stDevConfig._nNumsPlane * _stDevConfig._nNumsDie * _stDevConfig._nNumsPgPerBlk;
+
+    if(nAddr >= nTotalPg || nNumsPg > nTotalPg - nAddr)
+    {
+        return NAND_SYS_ERROR_ADDRESS;
+    }
+
+    for(UINT32 nIdx = 0; nIdx < nNumsPg; nIdx++)
+    {
+        UINT32  nBlk    = (nAddr + nIdx) / _stDevConfig._nNumsPgPerBlk;
+        nRet |= _controller.Deallocate(0, nBlk / (_stDevConfig._nNumsPlane * _stDevConfig._nNumsBlk), nBlk % _stDevConfig._nNumsPlane,
+                                       (nBlk / _stDevConfig._nNumsPlane) % _stDevConfig._nNumsBlk, (nAddr + nIdx) % _stDevConfig._nNumsPgPerBlk);
+    }
+
+    return nRet;
+}
+
+}
@@ -39,6 +39,8 @@
 
 namespace NANDFlashSim {
 
+class NandCheckpoint;
+
 class NandFlashSystem {
     NandController              _controller;
     UINT64                      _nCurrentTime;
@@ -57,6 +59,7 @@ public :
     NV_RET          AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nAddr);
     NV_RET          AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nAddr, bool bLastRequest);
     NV_RET          AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nSrcAddr, UINT32 nDestAddr);
+    NV_RET          AddTransaction( UINT32 nHostTransId, NAND_TRANS_OP nTransOp, UINT32 nAddr, UINT32 nByteOff, UINT32 nNumsByte);
 
     //////////////////////////////////////////////////////////////////////////
     //
@@ -109,6 +112,34 @@ public :
     void            HardReset( UINT32 nSystemClock, NandDeviceConfig &stDevConfig );
     void            InterruptService( NAND_ISR_TYPE nIsrType, UINT32 nArg1, UINT64 nArg2 );
 
+    //////////////////////////////////////////////////////////////////////////
+    // checkpoint interfaces
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET          Save( const char *szPath );
+    NV_RET          Restore( const char *szPath );
+
+    //////////////////////////////////////////////////////////////////////////
+    // preconditioning interface (bypasses timing)
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET          Precondition( UINT32 nStartAddr, UINT32 nNumsBlk, UINT32 nProgrammedPgs, std::vector<UINT32> &vctEcDist, UINT8 *pSignature = NULL );
+
+    //////////////////////////////////////////////////////////////////////////
+    // block mode interfaces (SLC mode regions)
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET          SetBlockMode( UINT32 nAddr, NAND_BLOCK_MODE eMode );
+    NAND_BLOCK_MODE GetBlockMode( UINT32 nAddr );
+    UINT32          GetUsablePages( UINT32 nAddr );
+
+    //////////////////////////////////////////////////////////////////////////
+    // wear information
+    //////////////////////////////////////////////////////////////////////////
+    UINT32          GetEraseCount( UINT32 nAddr );
+
+    //////////////////////////////////////////////////////////////////////////
+    // deallocation hint (TRIM)
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET          Deallocate( UINT32 nAddr, UINT32 nNumsPg = 1 );
+
     //////////////////////////////////////////////////////////////////////////
     // statistics
     //////////////////////////////////////////////////////////////////////////
@@ -117,6 +148,7 @@ public :
 
 private:
     UINT64          GetCyclesFromTime(UINT64 nTime);
+    UINT32          checkpointFeatures();
 };
 
 }
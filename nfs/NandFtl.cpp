@@ -0,0 +1,2558 @@
+/****************************************************************************
+*	 NANDFlashSim: A Cycle Accurate NAND Flash Memory Simulator 
+*	 
+*	 Copyright (C) 2011   	Myoungsoo Jung (MJ)
+*
+*                           Pennsylvania State University
+*                           Microsystems Design Laboratory
+*                           I/O Group
+*
+*	 This program is free software: you can redistribute it and/or modify
+*	 it under the terms of the GNU Lesser General Public License as published by
+*	 the Free Software Foundation.
+*
+*	 This program is distributed in the hope that it will be useful,
+*	 but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	 MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	 GNU Lesser General Public License for more details.
+*
+*	 You should have received a copy of the GNU Lesser General Public License
+*	 along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*****************************************************************************/
+
+
+/********************************************************************
+	created:	2026/10/19
+	created:	19:10:2026   14:05
+	file base:	NandFtl
+	file ext:	cpp
+	
+	purpose:	page-mapped flash translation layer (see NandFtl.h)
+*********************************************************************/
+
+#include "TypeSystem.h"
+#include "Tools.h"
+#include "ParamManager.h"
+#include "IoCompletion.h"
+#include "Plane.h"
+#include "Die.h"
+#include "LogicalUnit.h"
+#include "NandStageBuilderTool.h"
+#include "NandController.h"
+#include "NandFlashSystem.h"
+#include "NandFtl.h"
+#include <cstring>
+
+namespace NANDFlashSim {
+
+NandFtl::NandFtl( UINT64 nSystemClock, NandDeviceConfig &stConfig, NandIoCompletion *pCallback ) :
+            _stDevConfig(stConfig),
+            _pHostCallback(pCallback),
+            _flashCallback(this, &NandFtl::CompleteTransaction),
+            _flash(nSystemClock, stConfig, &_flashCallback)
+{
+    UINT32  nNumsDie    = _stDevConfig._nNumsDie;
+    UINT32  nNumsGroup  = nNumsDie * _stDevConfig._nNumsBlk;
+
+    _nPgsPerGroup       = _stDevConfig._nNumsPlane * _stDevConfig._nNumsPgPerBlk;
+    _nNumsLpn           = (UINT32)(((UINT64)nNumsGroup * _nPgsPerGroup * (100 - NFS_GET_PARAM(IFV_OVERPROVISION))) / 100);
+
+    // each write stream has its own open block group of each die.
+    _nWriteStreams      = NFS_GET_PARAM(IFV_WRITE_STREAMS);
+    if(_nWriteStreams == 0) _nWriteStreams = 1;
+    if(_nWriteStreams > NULL_SIG(UINT8)) _nWriteStreams = NULL_SIG(UINT8);
+
+    _nMapCacheEntries   = NFS_GET_PARAM(IFV_MAP_CACHE_ENTRIES);
+    _nMapEntriesPerPage = _stDevConfig._nPgSize / sizeof(UINT32);
+    _nNumsTvpn          = (_nMapCacheEntries != 0) ? (_nNumsLpn + _nMapEntriesPerPage - 1) / _nMapEntriesPerPage : 0;
+
+    // the open groups of the write streams and the destinations of GC (one of each stream) are partly 
+    // written, so that the spare groups of a die cover them; otherwise, GC can run out of victims with invalid pages.
+    UINT32 nNumsReserved = nNumsDie * 2 * _nWriteStreams * _nPgsPerGroup;
+    if(nNumsReserved < nNumsGroup * _nPgsPerGroup && _nNumsLpn + _nNumsTvpn > nNumsGroup * _nPgsPerGroup - nNumsReserved)
+    {
+        _nNumsLpn       = nNumsGroup * _nPgsPerGroup - nNumsReserved - _nNumsTvpn;
+        _nNumsTvpn      = (_nMapCacheEntries != 0) ? (_nNumsLpn + _nMapEntriesPerPage - 1) / _nMapEntriesPerPage : 0;
+    }
+
+    _vctL2P.assign(_nNumsLpn + _nNumsTvpn, NULL_SIG(UINT32));
+    _vctP2L.assign(nNumsGroup * _nPgsPerGroup, NULL_SIG(UINT32));
+    _vctValidCnt.assign(nNumsGroup, 0);
+    _vctGroupState.assign(nNumsGroup, FTL_GROUP_FREE);
+    _vctFreeGroups.resize(nNumsDie);
+    for(UINT32 nGroup = 0; nGroup < nNumsGroup; nGroup++)
+    {
+        _vctFreeGroups[nGroup / _stDevConfig._nNumsBlk].push_back(nGroup);
+    }
+    _vctLpnStream.assign(_nNumsLpn, 0);
+    _vctLpnHeat.assign(_nNumsLpn, 0);
+    _nHeatWrites        = 0;
+    _vctOpenGroup.assign(_nWriteStreams * nNumsDie, NULL_SIG(UINT32));
+    _vctWritePtr.assign(_nWriteStreams * nNumsDie, 0);
+    _vctGroupTime.assign(nNumsGroup, 0);
+    _vctGroupEc.assign(nNumsGroup, 0);
+
+    // a superblock holds at least a block group, so that there are no more of them than block groups.
+    _bSuperblock        = (NFS_GET_PARAM(IFV_SUPERBLOCK) != 0);
+    _vctGroupSb.assign(nNumsGroup, NULL_SIG(UINT32));
+    _vctSbGroups.assign(nNumsGroup, std::vector<UINT32>(nNumsDie, NULL_SIG(UINT32)));
+    _vctSbValidCnt.assign(nNumsGroup, 0);
+    _vctSbWidth.assign(nNumsGroup, 0);
+    _vctSbLiveGroups.assign(nNumsGroup, 0);
+    for(UINT32 nSb = 0; nSb < nNumsGroup; nSb++)
+    {
+        _lstFreeSbs.push_back(nSb);
+    }
+    _vctOpenSb.assign(_nWriteStreams, NULL_SIG(UINT32));
+    _vctSbTaken.assign(_nWriteStreams * nNumsDie, false);
+
+    _nNextReqKey        = 0;
+    _vctNextWriteDie.assign(_nWriteStreams, 0);
+    _bTrimStale         = (NFS_GET_PARAM(IFV_TRIM_STALE) != 0);
+    _vctInFlight.resize(nNumsDie);
+    _vctErasingGroup.assign(nNumsDie, NULL_SIG(UINT32));
+    _vctCompleted.assign(nNumsDie, false);
+    _vctCompletionTime.assign(nNumsDie, 0);
+    for(UINT32 nIdx = 0; nIdx < nNumsDie * _stDevConfig._nNumsPlane; nIdx++)
+    {
+        _vctpStaging.push_back(boost::shared_array<UINT8>(new UINT8[NAND_FULL_PAGE_SIZE(_stDevConfig)]));
+        memset(_vctpStaging[nIdx].get(), 0xFF, NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+
+    // GC keeps a block group for its destination, so that watermarks are bounded by the spare groups.
+    // The open groups and the destinations of the other write streams are never free either; otherwise
+    // GC would run on every idle die, and move the nearly valid groups of cold data over and over.
+    UINT32 nSpareGroups     = _stDevConfig._nNumsBlk - (UINT32)(((_nNumsLpn + _nNumsTvpn) / nNumsDie + _nPgsPerGroup - 1) / _nPgsPerGroup);
+    nSpareGroups            = (nSpareGroups > 2 * (_nWriteStreams - 1)) ? nSpareGroups - 2 * (_nWriteStreams - 1) : 0;
+    _eGcPolicy              = (NFS_GET_PARAM(IFV_GC_POLICY) < FTL_GC_POLICY_MAX) ? (FTL_GC_POLICY)NFS_GET_PARAM(IFV_GC_POLICY) : FTL_GC_GREEDY;
+    _nGcHighWatermark       = (NFS_GET_PARAM(IFV_GC_HIGH_WATERMARK) < nSpareGroups) ? NFS_GET_PARAM(IFV_GC_HIGH_WATERMARK) : nSpareGroups;
+    _nGcLowWatermark        = (NFS_GET_PARAM(IFV_GC_LOW_WATERMARK) < _nGcHighWatermark) ? NFS_GET_PARAM(IFV_GC_LOW_WATERMARK) : _nGcHighWatermark;
+    // host writes leave a free group for each destination of GC (gcReserve), so that GC has to go ahead of them above it.
+    if(_nGcLowWatermark < _nWriteStreams + 1) _nGcLowWatermark = _nWriteStreams + 1;
+    if(_nGcHighWatermark < _nGcLowWatermark) _nGcHighWatermark = _nGcLowWatermark;
+    _vctGcVictim.assign(nNumsDie, NULL_SIG(UINT32));
+    _vctGcScan.assign(nNumsDie, 0);
+    _vctGcOpenGroup.assign(_nWriteStreams * nNumsDie, NULL_SIG(UINT32));
+    _vctGcPlanePtr.assign(_nWriteStreams * nNumsDie * _stDevConfig._nNumsPlane, 0);
+    _vctGcExhausted.assign(nNumsDie, false);
+    _vctGcInFlight.assign(nNumsDie, false);
+    _vctGcHeld.assign(nNumsDie, false);
+    _vctGcHeldPage.resize(nNumsDie);
+    _vctGcIssueTime.assign(nNumsDie, 0);
+    _nWlThreshold           = NFS_GET_PARAM(IFV_WL_THRESHOLD);
+
+    _vctWlPending.assign(nNumsDie, false);
+    _vctWlMove.assign(nNumsDie, false);
+    _vctWlInFlight.assign(nNumsDie, false);
+
+    // the pool has no use beyond the high watermark, where GC stops filling it.
+    _nPreEraseTarget        = (NFS_GET_PARAM(IFV_PRE_ERASE_TARGET) < _nGcHighWatermark) ? NFS_GET_PARAM(IFV_PRE_ERASE_TARGET) : _nGcHighWatermark;
+    _nPreEraseIdleTime      = NFS_GET_PARAM(IFV_PRE_ERASE_IDLE_TIME);
+    _vctEraseGroups.resize(nNumsDie);
+    _vctIdleMark.assign(nNumsDie, 0);
+    for(UINT32 nDie = 0; nDie < nNumsDie; nDie++)
+    {
+        _vctpGcBuffer.push_back(boost::shared_array<UINT8>(new UINT8[_stDevConfig._nPgSize]));
+    }
+
+    // the buffer is flushed in rows of a page per plane, so that the high watermark takes a row at least.
+    _nBufferPages           = NFS_GET_PARAM(IFV_WRITE_BUFFER_PAGES);
+    _nBufferHighWatermark   = (UINT32)((UINT64)_nBufferPages * NFS_GET_PARAM(IFV_BUFFER_HIGH_WATERMARK) / 100);
+    _nBufferLowWatermark    = (UINT32)((UINT64)_nBufferPages * NFS_GET_PARAM(IFV_BUFFER_LOW_WATERMARK) / 100);
+    if(_nBufferHighWatermark < _stDevConfig._nNumsPlane) _nBufferHighWatermark = _stDevConfig._nNumsPlane;
+    if(_nBufferHighWatermark > _nBufferPages) _nBufferHighWatermark = _nBufferPages;
+    if(_nBufferLowWatermark > _nBufferHighWatermark) _nBufferLowWatermark = _nBufferHighWatermark;
+    _nBufferIdleTime        = NFS_GET_PARAM(IFV_BUFFER_IDLE_TIME);
+    _nDramBandwidth         = NFS_GET_PARAM(IFV_DRAM_BANDWIDTH);
+    _bBufferFlushing        = false;
+    _nDramBusyUntil         = 0;
+    _nLastHostTime          = 0;
+    if(_nBufferPages != 0)
+    {
+        _pBufferData        = boost::shared_array<UINT8>(new UINT8[(UINT64)_nBufferPages * NAND_FULL_PAGE_SIZE(_stDevConfig)]);
+        memset(_pBufferData.get(), 0xFF, (UINT64)_nBufferPages * NAND_FULL_PAGE_SIZE(_stDevConfig));
+        for(UINT32 nSlot = 0; nSlot < _nBufferPages; nSlot++)
+        {
+            _lstBufferFree.push_back(nSlot);
+        }
+    }
+
+    _nPrefetchPages         = NFS_GET_PARAM(IFV_PREFETCH_PAGES);
+    _nPrefetchTrigger       = NFS_GET_PARAM(IFV_PREFETCH_TRIGGER);
+    _vctStreams.resize((NFS_GET_PARAM(IFV_PREFETCH_STREAMS) != 0) ? NFS_GET_PARAM(IFV_PREFETCH_STREAMS) : 1);
+    for(UINT32 nStream = 0; nStream < _vctStreams.size(); nStream++)
+    {
+        _vctStreams[nStream]._nNextLpn  = NULL_SIG(UINT32);
+        _vctStreams[nStream]._nRunPgs   = 0;
+        _vctStreams[nStream]._nAheadLpn = NULL_SIG(UINT32);
+        _vctStreams[nStream]._nLastTime = 0;
+    }
+    _vctCacheReadNext.assign(nNumsDie, NULL_SIG(UINT32));
+    if(_nPrefetchPages != 0)
+    {
+        _pPrefetchData      = boost::shared_array<UINT8>(new UINT8[(UINT64)_nPrefetchPages * NAND_FULL_PAGE_SIZE(_stDevConfig)]);
+        for(UINT32 nSlot = 0; nSlot < _nPrefetchPages; nSlot++)
+        {
+            _lstPrefetchFree.push_back(nSlot);
+        }
+    }
+
+    _nStatHostReadPgs       = 0;
+    _nStatHostWritePgs      = 0;
+    _nStatTrimPgs           = 0;
+    _nStatTrimInvalidPgs    = 0;
+    _nStatTrimStalePgs      = 0;
+    _nStatUnmappedReadPgs   = 0;
+    _nStatFailedPgs         = 0;
+    _nStatFlashReadPgs      = 0;
+    _nStatFlashWritePgs     = 0;
+    _nStatNxRead            = 0;
+    _nStatNxWrite           = 0;
+    _nStatErase             = 0;
+    _nStatGcVictims         = 0;
+    _nStatGcCopyback        = 0;
+    _nStatGcNxCopyback      = 0;
+    _nStatGcReadProg        = 0;
+    _nStatGcDelayedReqs     = 0;
+    _vctStatGcTime.assign(nNumsDie, 0);
+    _nStatWlMigrations      = 0;
+    _nStatWlPages           = 0;
+    _nStatWlDelayedReqs     = 0;
+    _vctStatWlTime.assign(nNumsDie, 0);
+    _nStatMapHits           = 0;
+    _nStatMapMisses         = 0;
+    _nStatMapReads          = 0;
+    _nStatMapWrites         = 0;
+    _nStatMapDelayedReqs    = 0;
+    _nStatMapDelayedLatency = 0;
+    _nStatBufferWritePgs    = 0;
+    _nStatBufferOverwritePgs= 0;
+    _nStatBufferReadHits    = 0;
+    _nStatBufferStalls      = 0;
+    _nStatBufferFlushes     = 0;
+    _nStatBufferFlushPgs    = 0;
+    _nStatFuaPgs            = 0;
+    _nStatPrefetchPgs       = 0;
+    _nStatPrefetchCacheReads= 0;
+    _nStatPrefetchHits      = 0;
+    _nStatPrefetchMisses    = 0;
+    _nStatPrefetchWasted    = 0;
+    _nStatSbOpened          = 0;
+    _nStatIdleErase         = 0;
+    _nStatDemandErase       = 0;
+    _nStatEraseDelayedReqs  = 0;
+    _nStatEraseDelayedWrites= 0;
+    _vctStatStreamHostPgs.assign(_nWriteStreams, 0);
+    _vctStatStreamFlashPgs.assign(_nWriteStreams, 0);
+    for(UINT32 nOp = 0; nOp < NAND_FTL_OP_MAX; nOp++)
+    {
+        _vctStatReqs[nOp]       = 0;
+        _vctStatLatency[nOp]    = 0;
+        _vctStatMaxLatency[nOp] = 0;
+    }
+}
+
+NandFtl::~NandFtl()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Read
+// FullName:  NandFtl::Read
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nHostReqId
+// Parameter: UINT32 nLpn
+// Parameter: UINT32 nNumsPage
+// Parameter: UINT8 * pData
+//
+// Descriptions -
+// Queue a read of nNumsPage logical pages from nLpn. pData receives the data area
+// of each page back-to-back (nNumsPage * page size bytes). Unmapped pages read as zero.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFtl::Read( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData )
+{
+    return addRequest(nHostReqId, NAND_FTL_READ, nLpn, nNumsPage, pData);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Write
+// FullName:  NandFtl::Write
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nHostReqId
+// Parameter: UINT32 nLpn
+// Parameter: UINT32 nNumsPage
+// Parameter: UINT8 * pData
+// Parameter: bool bFua
+// Parameter: UINT32 nStream
+//
+// Descriptions -
+// Queue a write of nNumsPage logical pages from nLpn. pData is referenced until
+// the request is completed. A FUA (force unit access) write completes after its
+// program even if there is a write buffer. The pages go to the write stream nStream,
+// or to the one which the FTL picks for each page if nStream is NULL_SIG.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFtl::Write( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData, bool bFua, UINT32 nStream )
+{
+    return addRequest(nHostReqId, NAND_FTL_WRITE, nLpn, nNumsPage, pData, bFua, nStream);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Trim
+// FullName:  NandFtl::Trim
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT32 nHostReqId
+// Parameter: UINT32 nLpn
+// Parameter: UINT32 nNumsPage
+//
+// Descriptions -
+// Queue an unmapping of nNumsPage logical pages from nLpn. It takes no flash operation,
+// but it is ordered with the other requests on the same logical pages. The physical
+// pages become invalid for GC, and with FTL.TRIM_STALE they are marked stale in the planes.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandFtl::Trim( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage )
+{
+    return addRequest(nHostReqId, NAND_FTL_TRIM, nLpn, nNumsPage, NULL);
+}
+
+NV_RET NandFtl::addRequest( UINT32 nHostReqId, NAND_FTL_OP nOp, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData, bool bFua, UINT32 nStream )
+{
+    if(nNumsPage == 0 || nLpn >= _nNumsLpn || nNumsPage > _nNumsLpn - nLpn)
+    {
+        return NAND_FTL_ERROR_ADDRESS;
+    }
+
+    FtlRequest  stReq;
+    stReq._nHostReqId       = nHostReqId;
+    stReq._nOp              = nOp;
+    stReq._nNumsPending     = nNumsPage;
+    stReq._nArrivalTime     = _flash.CurrentTime();
+    stReq._bGcDelayed       = false;
+    stReq._bWlDelayed       = false;
+    stReq._bMapDelayed      = false;
+    stReq._bEraseDelayed    = false;
+
+    UINT32      nKey        = _nNextReqKey++;
+    _mapRequests[nKey]      = stReq;
+    _nLastHostTime          = stReq._nArrivalTime;
+    if(nOp == NAND_FTL_WRITE && bFua == true) _nStatFuaPgs += nNumsPage;
+
+    if(_nPrefetchPages != 0)
+    {
+        if(nOp == NAND_FTL_READ)
+        {
+            detectStream(nLpn, nNumsPage);
+        }
+        else
+        {
+            // the prefetched data of the pages is overwritten.
+            for(UINT32 nIdx = 0; nIdx < nNumsPage && _mapPrefetch.empty() == false; nIdx++)
+            {
+                unprefetch(nLpn + nIdx);
+            }
+        }
+    }
+
+    for(UINT32 nIdx = 0; nIdx < nNumsPage; nIdx++)
+    {
+        FtlPageOp   stPageOp;
+        stPageOp._nReqKey   = nKey;
+        stPageOp._nOp       = nOp;
+        stPageOp._nLpn      = nLpn + nIdx;
+        stPageOp._nPpn      = NULL_SIG(UINT32);
+        stPageOp._nSrcPpn   = NULL_SIG(UINT32);
+        stPageOp._pData     = (pData != NULL) ? pData + (UINT64)nIdx * _stDevConfig._nPgSize : NULL;
+        stPageOp._bFua      = bFua;
+        if(nOp == NAND_FTL_WRITE && _nWriteStreams > 1)
+        {
+            stPageOp._nStream               = classify(stPageOp._nLpn);
+            if(nStream != NULL_SIG(UINT32)) stPageOp._nStream = (nStream < _nWriteStreams) ? nStream : _nWriteStreams - 1;
+            _vctLpnStream[stPageOp._nLpn]   = (UINT8)stPageOp._nStream;
+        }
+        _lstPending.push_back(stPageOp);
+    }
+
+    return NAND_SUCCESS;
+}
+
+// the write stream by the update count of the logical page; the coldest stream takes a page written once, 
+// and the next one takes twice the count. The counts are halved once the host has written the logical space.
+UINT32 NandFtl::classify( UINT32 nLpn )
+{
+    if(++_nHeatWrites >= _nNumsLpn)
+    {
+        for(UINT32 nIdx = 0; nIdx < _nNumsLpn; nIdx++)
+        {
+            _vctLpnHeat[nIdx] >>= 1;
+        }
+        _nHeatWrites = 0;
+    }
+    if(_vctLpnHeat[nLpn] != NULL_SIG(UINT8)) _vctLpnHeat[nLpn]++;
+
+    UINT32 nStream = 0;
+    for(UINT32 nHeat = _vctLpnHeat[nLpn]; nHeat > 1 && nStream + 1 < _nWriteStreams; nHeat >>= 1)
+    {
+        nStream++;
+    }
+
+    return nStream;
+}
+
+// the write stream of a page which GC moves; translation pages are updated the most.
+UINT32 NandFtl::gcStream( UINT32 nLpn )
+{
+    return (nLpn < _nNumsLpn) ? _vctLpnStream[nLpn] : _nWriteStreams - 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    UpdateWithoutIdleCycles
+// FullName:  NandFtl::UpdateWithoutIdleCycles
+// Access:    public 
+// Returns:   UINT64
+// Parameter: void
+//
+// Descriptions -
+// Dispatch the queued pages to free dies, and update the flash memory system
+// to its next activity. Transactions completed by the update are retired here rather 
+// than in the completion callback, since the die is released after the callback.
+//////////////////////////////////////////////////////////////////////////////
+UINT64 NandFtl::UpdateWithoutIdleCycles( void )
+{
+    dispatch();
+    UINT64 nCycles = _flash.UpdateWithoutIdleCycles();
+
+    for(UINT32 nDie = 0; nDie < _stDevConfig._nNumsDie; nDie++)
+    {
+        if(_vctCompleted[nDie] == true)
+        {
+            retire(nDie);
+        }
+    }
+
+    return nCycles;
+}
+
+bool NandFtl::IsActiveMode( void )
+{
+    if(_lstPending.empty() == false || _flash.IsActiveMode())
+    {
+        return true;
+    }
+
+    for(UINT32 nDie = 0; nDie < _stDevConfig._nNumsDie; nDie++)
+    {
+        if(gcWanted(nDie) || _vctWlPending[nDie] || preEraseWanted(nDie)) return true;
+    }
+
+    if(_mapBuffer.empty() == false || _lstPrefetchQueue.empty() == false)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+void NandFtl::CompleteTransaction( UINT32 nHostTransId, UINT64 nDeviceId, UINT64 nCompletionTime )
+{
+    (void)nDeviceId;
+    assert(nHostTransId < _stDevConfig._nNumsDie);
+    _vctCompleted[nHostTransId]         = true;
+    _vctCompletionTime[nHostTransId]    = nCompletionTime;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    dispatch
+// FullName:  NandFtl::dispatch
+// Access:    private 
+// Returns:   void
+// Parameter: void
+//
+// Descriptions -
+// Walk the queued pages in order and build a batch for each free die. 
+// A read batch collects the pages on the same page offset of different planes, 
+// and a write batch collects as many pages as planes if the write pointer of the die 
+// is at the first plane. Once the batch of a die is full, the next write goes to
+// the next die, so that consecutive writes are spread over the dies.
+// A page which is not dispatched blocks all following pages of the same logical page.
+// GC takes a die before the host pages only below the low watermark; otherwise it 
+// runs on the free dies which have no host page. The pre-erase pool of a die is 
+// erased below the low watermark, or in an idle window of the die.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::dispatch( void )
+{
+    typedef std::list<FtlPageOp>::iterator PageIter;
+
+    const UINT32    nNumsDie    = _stDevConfig._nNumsDie;
+    const UINT32    nNumsPlane  = _stDevConfig._nNumsPlane;
+    std::vector< std::vector<PageIter> >    vctBatch(nNumsDie);
+    std::vector<NAND_FTL_OP>                vctBatchOp(nNumsDie, NAND_FTL_OP_MAX);
+    std::vector<bool>                       vctFree(nNumsDie);
+    std::set<UINT32>                        setBlocked;
+    std::vector<UINT32>                     vctWriteDie(_nWriteStreams, NULL_SIG(UINT32));
+    bool                                    bStalledWrite   = false;
+    bool                                    bIssued         = false;
+    bool                                    bGcBusy         = false;
+    bool                                    bWlBusy         = false;
+    std::vector<UINT32>                     vctLoad(nNumsDie, NULL_SIG(UINT32));
+
+    for(UINT32 nDie = 0; nDie < nNumsDie; nDie++)
+    {
+        vctFree[nDie] = (_vctInFlight[nDie].empty() && _vctErasingGroup[nDie] == NULL_SIG(UINT32) && _flash.IsBusy(nDie) == false);
+        if(vctFree[nDie] == true && _vctFreeGroups[nDie].size() < _nGcLowWatermark && (preErase(nDie, false) || collect(nDie) == true))
+        {
+            vctFree[nDie]   = false;
+            bIssued         = true;
+        }
+        bGcBusy |= (_vctGcInFlight[nDie] && _vctWlInFlight[nDie] == false);
+        bWlBusy |= (_vctGcInFlight[nDie] && _vctWlInFlight[nDie]);
+    }
+
+    for(PageIter iPage = _lstPending.begin(); iPage != _lstPending.end(); )
+    {
+        if(setBlocked.find(iPage->_nLpn) != setBlocked.end())
+        {
+            ++iPage;
+            continue;
+        }
+
+        // the write buffer serves the host page if it can.
+        if(_nBufferPages != 0 && iPage->_nReqKey != NULL_SIG(UINT32))
+        {
+            bool bBlocked = false;
+            if(buffer(*iPage, bBlocked) == true)
+            {
+                iPage = _lstPending.erase(iPage);
+                continue;
+            }
+            if(bBlocked == true)
+            {
+                setBlocked.insert(iPage->_nLpn);
+                ++iPage;
+                continue;
+            }
+        }
+
+        // a prefetched page serves the host read, or the read waits for the prefetch under reading.
+        if(_nPrefetchPages != 0 && iPage->_nReqKey != NULL_SIG(UINT32) && iPage->_nOp == NAND_FTL_READ)
+        {
+            bool bBlocked = false;
+            if(prefetched(*iPage, bBlocked) == true)
+            {
+                iPage = _lstPending.erase(iPage);
+                continue;
+            }
+            if(bBlocked == true)
+            {
+                setBlocked.insert(iPage->_nLpn);
+                ++iPage;
+                continue;
+            }
+        }
+
+        // a host page waits until its mapping entry is cached.
+        if(_nMapCacheEntries != 0 && iPage->_nLpn < _nNumsLpn && iPage->_bMapReady == false)
+        {
+            bool    bCached = mapLookup(iPage->_nLpn);
+            UINT32  nTvpn   = iPage->_nLpn / _nMapEntriesPerPage;
+            if(iPage->_bMapLooked == false)
+            {
+                if(bCached) _nStatMapHits++;
+                else _nStatMapMisses++;
+                iPage->_bMapLooked = true;
+            }
+
+            if(bCached == false && _vctL2P[_nNumsLpn + nTvpn] == NULL_SIG(UINT32))
+            {
+                // a translation page which has never been written maps nothing.
+                mapInsert(iPage->_nLpn);
+                iPage->_bMapReady = true;
+            }
+            else if(bCached)
+            {
+                iPage->_bMapReady = true;
+            }
+            else
+            {
+                UINT32 nMapDie = dieOf(_vctL2P[_nNumsLpn + nTvpn]);
+                iPage->_bMapDelayed = true;
+                if(_setMapLoading.find(nTvpn) == _setMapLoading.end() && vctFree[nMapDie] == true && vctBatch[nMapDie].empty())
+                {
+                    vctLoad[nMapDie]    = nTvpn;
+                    vctFree[nMapDie]    = false;
+                    _setMapLoading.insert(nTvpn);
+                }
+                setBlocked.insert(iPage->_nLpn);
+                ++iPage;
+                continue;
+            }
+        }
+
+        UINT32  nDie    = NULL_SIG(UINT32);
+        UINT32  nStream = iPage->_nStream;
+        switch(iPage->_nOp)
+        {
+        case NAND_FTL_TRIM :
+            if(_vctL2P[iPage->_nLpn] != NULL_SIG(UINT32))
+            {
+                // a page which is still read or programmed by a transaction is left to it.
+                if(_bTrimStale && inFlight(_vctL2P[iPage->_nLpn]) == false)
+                {
+                    _flash.Deallocate(physicalAddr(_vctL2P[iPage->_nLpn]));
+                    _nStatTrimStalePgs++;
+                }
+                _nStatTrimInvalidPgs++;
+                invalidate(_vctL2P[iPage->_nLpn]);
+                _vctL2P[iPage->_nLpn] = NULL_SIG(UINT32);
+                mapUpdate(iPage->_nLpn);
+            }
+            completePage(*iPage, _flash.CurrentTime());
+            iPage = _lstPending.erase(iPage);
+            continue;
+
+        case NAND_FTL_READ :
+            if(_vctL2P[iPage->_nLpn] == NULL_SIG(UINT32))
+            {
+                if(iPage->_pData != NULL)
+                {
+                    memset(iPage->_pData, 0, _stDevConfig._nPgSize);
+                }
+                _nStatUnmappedReadPgs++;
+                completePage(*iPage, _flash.CurrentTime());
+                iPage = _lstPending.erase(iPage);
+                continue;
+            }
+
+            iPage->_nPpn = _vctL2P[iPage->_nLpn];
+            nDie         = dieOf(iPage->_nPpn);
+            if(vctFree[nDie] == false)
+            {
+                iPage->_bGcDelayed |= (_vctGcInFlight[nDie] && _vctWlInFlight[nDie] == false);
+                iPage->_bWlDelayed |= (_vctGcInFlight[nDie] && _vctWlInFlight[nDie]);
+                iPage->_bEraseDelayed |= (_vctErasingGroup[nDie] != NULL_SIG(UINT32));
+                nDie = NULL_SIG(UINT32);
+            }
+            else if(vctBatch[nDie].empty() == false)
+            {
+                // join the batch only for the same page offset of another plane
+                bool bJoin = (vctBatchOp[nDie] == NAND_FTL_READ && vctBatch[nDie].size() < nNumsPlane &&
+                              groupOf(vctBatch[nDie][0]->_nPpn) == groupOf(iPage->_nPpn) && pageOf(vctBatch[nDie][0]->_nPpn) == pageOf(iPage->_nPpn));
+                for(UINT32 nIdx = 0; bJoin && nIdx < vctBatch[nDie].size(); nIdx++)
+                {
+                    bJoin = (planeOf(vctBatch[nDie][nIdx]->_nPpn) != planeOf(iPage->_nPpn));
+                }
+                if(bJoin == false) nDie = NULL_SIG(UINT32);
+            }
+            break;
+
+        case NAND_FTL_WRITE :
+            // the pages of a write stream share a batch, which goes to the open group of the stream.
+            if(vctWriteDie[nStream] != NULL_SIG(UINT32) && 
+               vctBatch[vctWriteDie[nStream]].size() < ((_vctWritePtr[nStream * nNumsDie + vctWriteDie[nStream]] % nNumsPlane == 0) ? nNumsPlane : 1))
+            {
+                nDie = vctWriteDie[nStream];
+            }
+            else
+            {
+                // superblocks take the writes in stripe order, so that only the die of the stripe can take them.
+                UINT32 nFirst   = (_bSuperblock) ? stripeDie(nStream) : _vctNextWriteDie[nStream];
+                UINT32 nNums    = (_bSuperblock) ? ((nFirst != NULL_SIG(UINT32)) ? 1 : 0) : nNumsDie;
+                bool   bErasing = false;
+                for(UINT32 nIdx = 0; nIdx < nNums; nIdx++)
+                {
+                    UINT32 nCandidate = (nFirst + nIdx) % nNumsDie;
+                    bErasing |= (_vctErasingGroup[nCandidate] != NULL_SIG(UINT32));
+                    if(vctFree[nCandidate] == true && vctBatch[nCandidate].empty() && writable(nCandidate, nStream))
+                    {
+                        nDie                        = nCandidate;
+                        vctWriteDie[nStream]        = nCandidate;
+                        _vctNextWriteDie[nStream]   = (nCandidate + 1) % nNumsDie;
+                        break;
+                    }
+                }
+                if(nDie == NULL_SIG(UINT32))
+                {
+                    bStalledWrite       = true;
+                    iPage->_bGcDelayed |= bGcBusy;
+                    iPage->_bWlDelayed |= bWlBusy;
+                    iPage->_bEraseDelayed |= bErasing;
+                }
+            }
+            break;
+
+        default :
+            break;
+        }
+
+        if(nDie != NULL_SIG(UINT32))
+        {
+            vctBatch[nDie].push_back(iPage);
+            vctBatchOp[nDie] = iPage->_nOp;
+        }
+        setBlocked.insert(iPage->_nLpn);
+        ++iPage;
+    }
+
+    bool bFlush = (_nBufferPages != 0 && flushWanted());
+    for(UINT32 nDie = 0; nDie < nNumsDie; nDie++)
+    {
+        if(vctLoad[nDie] != NULL_SIG(UINT32))
+        {
+            FtlPageOp   stPageOp;
+            stPageOp._nReqKey       = NULL_SIG(UINT32);
+            stPageOp._nOp           = NAND_FTL_READ;
+            stPageOp._nLpn          = _nNumsLpn + vctLoad[nDie];
+            stPageOp._nPpn          = _vctL2P[stPageOp._nLpn];
+            stPageOp._nSrcPpn       = NULL_SIG(UINT32);
+            stPageOp._pData         = NULL;
+            stPageOp._bMapLooked    = true;
+            stPageOp._bMapReady     = true;
+
+            Transaction stTrans;
+            stTrans._nHostTransId   = nDie;
+            stTrans._nTransOp       = NAND_OP_READ;
+            stTrans._nAddr          = physicalAddr(stPageOp._nPpn);
+            stTrans._nByteOff       = 0;
+            stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+            stTrans._pData          = _vctpStaging[nDie * nNumsPlane + planeOf(stPageOp._nPpn)].get();
+            addTransaction(stTrans);
+            _vctInFlight[nDie].push_back(stPageOp);
+            _nStatFlashReadPgs++;
+            _nStatMapReads++;
+            bIssued = true;
+            continue;
+        }
+
+        if(vctBatch[nDie].empty()) 
+        {
+            // a flush to a former die may have emptied the buffer.
+            if(vctFree[nDie] == true && bFlush == true && _lstBufferOrder.empty() == false && (_bSuperblock == false || nDie == stripeDie(_vctLpnStream[_lstBufferOrder.front()])) && flush(nDie) == true)
+            {
+                bIssued = true;
+                continue;
+            }
+
+            if(vctFree[nDie] == true && _lstPrefetchQueue.empty() == false && prefetch(nDie, setBlocked) == true)
+            {
+                bIssued = true;
+                continue;
+            }
+
+            if(vctFree[nDie] == true && preEraseWanted(nDie) && preErase(nDie, true) == true)
+            {
+                bIssued = true;
+                continue;
+            }
+
+            // background GC, or wear leveling once no host page is left, on the free die without host pages
+            if(vctFree[nDie] == true && (gcWanted(nDie) || (_lstPending.empty() && levelWear(nDie))) && collect(nDie) == true)
+            {
+                bIssued = true;
+            }
+            continue;
+        }
+
+        if(vctBatchOp[nDie] == NAND_FTL_WRITE)
+        {
+            issueWrite(nDie, vctBatch[nDie]);
+        }
+        else
+        {
+            issueRead(nDie, vctBatch[nDie]);
+        }
+        bIssued = true;
+    }
+
+    // no die can take the write, and nothing in flight frees a block group.
+    if(bIssued == false && bStalledWrite == true && _flash.IsActiveMode() == false)
+    {
+        for(PageIter iPage = _lstPending.begin(); iPage != _lstPending.end(); ++iPage)
+        {
+            if(iPage->_nOp == NAND_FTL_WRITE && iPage->_nReqKey != NULL_SIG(UINT32))
+            {
+                NV_ERROR("FTL has no free block group to write the logical page " << iPage->_nLpn);
+                completePage(*iPage, _flash.CurrentTime(), true);
+                _lstPending.erase(iPage);
+                break;
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    writable
+// FullName:  NandFtl::writable
+// Access:    private 
+// Returns:   bool
+// Parameter: UINT32 nDie
+// Parameter: UINT32 nStream
+//
+// Descriptions -
+// Host writes of the stream can open a new block group as long as a free group is 
+// left for GC. A die opens a new superblock of the stream with such a group once 
+// every die has opened its group of the former superblock of the stream.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::writable( UINT32 nDie, UINT32 nStream )
+{
+    UINT32 nOpen = nStream * _stDevConfig._nNumsDie + nDie;
+    if(_bSuperblock == false || _vctOpenGroup[nOpen] != NULL_SIG(UINT32))
+    {
+        return (_vctOpenGroup[nOpen] != NULL_SIG(UINT32) || _vctFreeGroups[nDie].size() > gcReserve(nDie));
+    }
+
+    if(_vctOpenSb[nStream] != NULL_SIG(UINT32) && _vctSbTaken[nOpen] == false)
+    {
+        return true;
+    }
+
+    for(UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsDie; nIdx++)
+    {
+        if(_vctOpenSb[nStream] != NULL_SIG(UINT32) && _vctSbTaken[nStream * _stDevConfig._nNumsDie + nIdx] == false)
+        {
+            return false;
+        }
+    }
+
+    return (_vctFreeGroups[nDie].size() > gcReserve(nDie));
+}
+
+bool NandFtl::gcWanted( UINT32 nDie )
+{
+    if(_vctGcExhausted[nDie] == true)
+    {
+        return false;
+    }
+
+    // the pre-erase pool becomes free groups without moving a page.
+    return (_vctGcHeld[nDie] || _vctGcVictim[nDie] != NULL_SIG(UINT32) || _vctFreeGroups[nDie].size() + _vctEraseGroups[nDie].size() < _nGcHighWatermark);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    collect
+// FullName:  NandFtl::collect
+// Access:    private 
+// Returns:   bool (true if a transaction is issued to the die)
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// A step of GC on the die. It programs the page which GC has read, chooses a victim, 
+// moves valid pages of the victim, or erases the victim which has no valid page.
+// With the pre-erase pool, the victim without valid pages joins the pool instead, 
+// and only the free groups below the low watermark erase the pool at once.
+// Valid pages are moved by copyback into the same plane of the destination group, 
+// a page of each plane at once by the multi-plane copyback. If the block of the plane 
+// is full, the page is read into the controller and programmed to another plane.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::collect( UINT32 nDie )
+{
+    const UINT32    nNumsPlane  = _stDevConfig._nNumsPlane;
+
+    if(_vctGcHeld[nDie] == true)
+    {
+        // the page is dropped if the host has updated or trimmed it in the meantime.
+        if(_vctP2L[_vctGcHeldPage[nDie]._nSrcPpn] == _vctGcHeldPage[nDie]._nLpn)
+        {
+            return moveHeldPage(nDie);
+        }
+        _vctGcHeld[nDie] = false;
+    }
+
+    if(_vctGcVictim[nDie] == NULL_SIG(UINT32))
+    {
+        _vctGcVictim[nDie] = selectVictim(nDie);
+        if(_vctGcVictim[nDie] == NULL_SIG(UINT32))
+        {
+            _vctGcExhausted[nDie] = true;
+            return false;
+        }
+        _vctGcScan[nDie]    = 0;
+        _nStatGcVictims++;
+    }
+
+    UINT32 nVictim = _vctGcVictim[nDie];
+    _vctWlInFlight[nDie] = _vctWlMove[nDie];
+    if(_vctValidCnt[nVictim] == 0)
+    {
+        _vctGcVictim[nDie]  = NULL_SIG(UINT32);
+        _vctWlMove[nDie]    = false;
+        if(_nPreEraseTarget != 0)
+        {
+            _vctGroupState[nVictim] = FTL_GROUP_DIRTY;
+            _vctEraseGroups[nDie].push_back(nVictim);
+            return (_vctFreeGroups[nDie].size() < _nGcLowWatermark && preErase(nDie, false));
+        }
+        eraseGroup(nDie, nVictim);
+        _vctGcInFlight[nDie]    = true;
+        _vctGcIssueTime[nDie]   = _flash.CurrentTime();
+        return true;
+    }
+
+    // gather valid pages of different planes which go to the same destination, and have room in it.
+    while(_vctGcScan[nDie] < _nPgsPerGroup && _vctP2L[nVictim * _nPgsPerGroup + _vctGcScan[nDie]] == NULL_SIG(UINT32))
+    {
+        _vctGcScan[nDie]++;
+    }
+
+    UINT32 nOpen = gcDestination(nDie, _vctP2L[nVictim * _nPgsPerGroup + _vctGcScan[nDie]]);
+    if(nOpen == NULL_SIG(UINT32))
+    {
+        _vctGcExhausted[nDie] = true;
+        return false;
+    }
+    if(_vctGcOpenGroup[nOpen] == NULL_SIG(UINT32))
+    {
+        openGroup(nDie, false, nOpen / _stDevConfig._nNumsDie);
+    }
+
+    std::vector<UINT32> vctSrc(nNumsPlane, NULL_SIG(UINT32));
+    UINT32              nNums       = 0;
+    UINT32              nFallback   = NULL_SIG(UINT32);
+    for(UINT32 nSlot = _vctGcScan[nDie]; nSlot < _nPgsPerGroup && nNums < nNumsPlane; nSlot++)
+    {
+        UINT32 nPpn     = nVictim * _nPgsPerGroup + nSlot;
+        UINT32 nPlane   = planeOf(nPpn);
+        if(_vctP2L[nPpn] == NULL_SIG(UINT32) || gcDestination(nDie, _vctP2L[nPpn]) != nOpen)
+        {
+            continue;
+        }
+        if(_vctGcPlanePtr[nOpen * nNumsPlane + nPlane] >= _stDevConfig._nNumsPgPerBlk)
+        {
+            if(nFallback == NULL_SIG(UINT32)) nFallback = nPpn;
+            continue;
+        }
+        if(vctSrc[nPlane] != NULL_SIG(UINT32))
+        {
+            break;
+        }
+        vctSrc[nPlane]  = nPpn;
+        nNums++;
+    }
+
+    if(nNums == 0)
+    {
+        // the blocks of the destination on the planes of the remaining pages are full.
+        assert(nFallback != NULL_SIG(UINT32));
+        FtlPageOp   stPageOp;
+        stPageOp._nReqKey       = NULL_SIG(UINT32);
+        stPageOp._nOp           = NAND_FTL_READ;
+        stPageOp._nLpn          = _vctP2L[nFallback];
+        stPageOp._nPpn          = nFallback;
+        stPageOp._nSrcPpn       = nFallback;
+        stPageOp._pData         = NULL;
+
+        Transaction stTrans;
+        stTrans._nHostTransId   = nDie;
+        stTrans._nTransOp       = NAND_OP_READ;
+        stTrans._nAddr          = physicalAddr(nFallback);
+        stTrans._nByteOff       = 0;
+        stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+        stTrans._pData          = _vctpStaging[nDie * nNumsPlane + planeOf(nFallback)].get();
+        addTransaction(stTrans);
+        _vctInFlight[nDie].push_back(stPageOp);
+        _nStatFlashReadPgs++;
+    }
+    else
+    {
+        bool            bNx     = (nNumsPlane > 1 && nNums == nNumsPlane);
+        UINT32          nDest   = _vctGcOpenGroup[nOpen];
+        for(UINT32 nPlane = 0; nPlane < nNumsPlane; nPlane++)
+        {
+            if(vctSrc[nPlane] == NULL_SIG(UINT32)) continue;
+
+            UINT32  nSrc    = vctSrc[nPlane];
+            UINT32  nDst    = nDest * _nPgsPerGroup + _vctGcPlanePtr[nOpen * nNumsPlane + nPlane] * nNumsPlane + nPlane;
+            Transaction stTrans;
+            stTrans._nHostTransId   = nDie;
+            stTrans._nTransOp       = (bNx) ? NAND_OP_INTERNAL_DATAMOVEMENT_MULTIPLANE : NAND_OP_INTERNAL_DATAMOVEMENT;
+            stTrans._nAddr          = physicalAddr(nSrc);
+            stTrans._nDestAddr      = physicalAddr(nDst);
+            stTrans._nByteOff       = 0;
+            stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+            addTransaction(stTrans);
+
+            FtlPageOp   stPageOp;
+            stPageOp._nReqKey       = NULL_SIG(UINT32);
+            stPageOp._nOp           = NAND_FTL_WRITE;
+            stPageOp._nLpn          = _vctP2L[nSrc];
+            stPageOp._nPpn          = nDst;
+            stPageOp._nSrcPpn       = nSrc;
+            stPageOp._pData         = NULL;
+            remap(stPageOp._nLpn, nDst);
+            _vctGcPlanePtr[nOpen * nNumsPlane + nPlane]++;
+            _vctInFlight[nDie].push_back(stPageOp);
+            if(_vctWlMove[nDie]) _nStatWlPages++;
+            else _nStatGcCopyback++;
+            _nStatFlashWritePgs++;
+
+            if(bNx == false) break;
+        }
+        if(bNx) _nStatGcNxCopyback++;
+    }
+
+    _vctGcInFlight[nDie]    = true;
+    _vctGcIssueTime[nDie]   = _flash.CurrentTime();
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    selectVictim
+// FullName:  NandFtl::selectVictim
+// Access:    private 
+// Returns:   UINT32 (block group, NULL_SIG if there is no candidate)
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// Greedy takes the full block group with the fewest valid pages. Cost-benefit takes 
+// the largest (1 - u) * age / 2u, where u is the utilization of the group and age
+// is the time since the group became full. A group without valid pages wins at once,
+// and a group whose valid pages don't fit into the room of GC is skipped.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 NandFtl::selectVictim( UINT32 nDie )
+{
+    UINT32  nRoom       = gcRoom(nDie);
+    UINT32  nVictim     = NULL_SIG(UINT32);
+    double  nBestScore  = -1;
+    UINT64  nNow        = _flash.CurrentTime();
+
+    for(UINT32 nGroup = nDie * _stDevConfig._nNumsBlk; nGroup < (nDie + 1) * _stDevConfig._nNumsBlk; nGroup++)
+    {
+        if(_vctGroupState[nGroup] != FTL_GROUP_FULL || _vctValidCnt[nGroup] == _nPgsPerGroup || _vctValidCnt[nGroup] > nRoom)
+        {
+            continue;
+        }
+        if(_vctValidCnt[nGroup] == 0)
+        {
+            return nGroup;
+        }
+
+        double nScore;
+        if(_eGcPolicy == FTL_GC_COST_BENEFIT)
+        {
+            double nUtil    = groupUtil(nGroup);
+            nScore          = (1 - nUtil) * (double)(nNow - _vctGroupTime[nGroup] + 1) / (2 * nUtil);
+        }
+        else
+        {
+            nScore          = 1 - groupUtil(nGroup);
+        }
+
+        if(nScore > nBestScore)
+        {
+            nBestScore  = nScore;
+            nVictim     = nGroup;
+        }
+    }
+
+    return nVictim;
+}
+
+// free pages which GC can move the valid pages of a victim to.
+UINT32 NandFtl::gcRoom( UINT32 nDie )
+{
+    UINT32  nRoom       = _vctFreeGroups[nDie].size() * _nPgsPerGroup;
+
+    for(UINT32 nOpen = nDie; nOpen < _vctGcOpenGroup.size(); nOpen += _stDevConfig._nNumsDie)
+    {
+        if(_vctGcOpenGroup[nOpen] == NULL_SIG(UINT32)) continue;
+        for(UINT32 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+        {
+            nRoom += _stDevConfig._nNumsPgPerBlk - _vctGcPlanePtr[nOpen * _stDevConfig._nNumsPlane + nPlane];
+        }
+    }
+
+    return nRoom;
+}
+
+// the destination of GC (stream * dies + die) for a page of the logical page. It keeps the write stream of 
+// the page, so that the streams stay apart in GC as well, and the caller opens it if the die has a free group.
+// Otherwise the page goes to the open destination of the die with the most room, since the room of GC counts 
+// all of them (gcRoom). NULL_SIG if the die has no room for the page at all.
+UINT32 NandFtl::gcDestination( UINT32 nDie, UINT32 nLpn )
+{
+    UINT32 nOpen = gcStream(nLpn) * _stDevConfig._nNumsDie + nDie;
+    if(_vctGcOpenGroup[nOpen] != NULL_SIG(UINT32) || _vctFreeGroups[nDie].empty() == false)
+    {
+        return nOpen;
+    }
+
+    UINT32 nBestRoom = 0;
+    nOpen = NULL_SIG(UINT32);
+    for(UINT32 nOther = nDie; nOther < _vctGcOpenGroup.size(); nOther += _stDevConfig._nNumsDie)
+    {
+        if(_vctGcOpenGroup[nOther] == NULL_SIG(UINT32)) continue;
+
+        UINT32 nRoom = 0;
+        for(UINT32 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+        {
+            nRoom += _stDevConfig._nNumsPgPerBlk - _vctGcPlanePtr[nOther * _stDevConfig._nNumsPlane + nPlane];
+        }
+        if(nRoom > nBestRoom)
+        {
+            nBestRoom   = nRoom;
+            nOpen       = nOther;
+        }
+    }
+
+    return nOpen;
+}
+
+// free groups of the die which host writes leave for GC; a group for each destination which is not open, and one at least.
+UINT32 NandFtl::gcReserve( UINT32 nDie )
+{
+    UINT32 nReserve = 0;
+    for(UINT32 nOpen = nDie; nOpen < _vctGcOpenGroup.size(); nOpen += _stDevConfig._nNumsDie)
+    {
+        if(_vctGcOpenGroup[nOpen] == NULL_SIG(UINT32)) nReserve++;
+    }
+
+    return (nReserve > 1) ? nReserve : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    levelWear
+// FullName:  NandFtl::levelWear
+// Access:    private 
+// Returns:   bool (true if a wear leveling victim is chosen)
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// Static wear leveling. If the erase counts of the die spread over the threshold,
+// the least worn full block group becomes the victim of GC; its valid pages are
+// cold data, and the group takes hot data after its erase. A whole block group 
+// of room is kept, so that GC doesn't run out of free groups due to the migration.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::levelWear( UINT32 nDie )
+{
+    if(_nWlThreshold == 0 || _vctWlPending[nDie] == false || _vctGcVictim[nDie] != NULL_SIG(UINT32) || _vctGcHeld[nDie] == true)
+    {
+        return false;
+    }
+    _vctWlPending[nDie] = false;
+
+    UINT32  nRoom       = gcRoom(nDie);
+    UINT32  nVictim     = NULL_SIG(UINT32);
+    UINT32  nMinEc      = NULL_SIG(UINT32);
+    for(UINT32 nGroup = nDie * _stDevConfig._nNumsBlk; nGroup < (nDie + 1) * _stDevConfig._nNumsBlk; nGroup++)
+    {
+        if(_vctGroupState[nGroup] != FTL_GROUP_FULL || _vctValidCnt[nGroup] + _nPgsPerGroup > nRoom)
+        {
+            continue;
+        }
+
+        UINT32 nEc = groupEraseCount(nGroup);
+        if(nEc < nMinEc)
+        {
+            nMinEc  = nEc;
+            nVictim = nGroup;
+        }
+    }
+
+    if(nVictim == NULL_SIG(UINT32))
+    {
+        return false;
+    }
+
+    _vctGcVictim[nDie]  = nVictim;
+    _vctGcScan[nDie]    = 0;
+    _vctWlMove[nDie]    = true;
+    _nStatWlMigrations++;
+    return true;
+}
+
+// erase counts of the die are checked whenever a block group of the die is erased.
+void NandFtl::checkWear( UINT32 nDie )
+{
+    if(_nWlThreshold == 0)
+    {
+        return;
+    }
+
+    UINT32  nMaxEc  = 0;
+    UINT32  nMinEc  = NULL_SIG(UINT32);
+    for(UINT32 nGroup = nDie * _stDevConfig._nNumsBlk; nGroup < (nDie + 1) * _stDevConfig._nNumsBlk; nGroup++)
+    {
+        UINT32 nEc = groupEraseCount(nGroup);
+        if(nEc > nMaxEc) nMaxEc = nEc;
+        if(_vctGroupState[nGroup] == FTL_GROUP_FULL && nEc < nMinEc) nMinEc = nEc;
+    }
+
+    _vctWlPending[nDie] = (nMinEc != NULL_SIG(UINT32) && nMaxEc - nMinEc > _nWlThreshold);
+}
+
+// the blocks of a group are erased together, but the most worn one tells the wear of the group.
+// Without the plane statistics, the erases which the FTL issued to the group tell it.
+UINT32 NandFtl::groupEraseCount( UINT32 nGroup )
+{
+#ifdef WITHOUT_PLANE_STATS
+    return _vctGroupEc[nGroup];
+#else
+    UINT32 nEc = 0;
+    for(UINT32 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+    {
+        UINT32 nPlaneEc = _flash.GetEraseCount(physicalAddr(nGroup * _nPgsPerGroup + nPlane));
+        if(nPlaneEc > nEc) nEc = nPlaneEc;
+    }
+
+    return nEc;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    takeGroup
+// FullName:  NandFtl::takeGroup
+// Access:    private 
+// Returns:   UINT32 (the taken block group)
+// Parameter: UINT32 nDie
+// Parameter: bool bHot (true for host writes, false for the destination of GC)
+//
+// Descriptions -
+// Dynamic wear leveling. Host writes take the least worn free group, and GC takes
+// the most worn one, since the pages which survive GC are likely to stay.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 NandFtl::takeGroup( UINT32 nDie, bool bHot )
+{
+    std::list<UINT32>::iterator iBest   = _vctFreeGroups[nDie].begin();
+    UINT32                      nBestEc = groupEraseCount(*iBest);
+    for(std::list<UINT32>::iterator iGroup = ++_vctFreeGroups[nDie].begin(); iGroup != _vctFreeGroups[nDie].end(); ++iGroup)
+    {
+        UINT32 nEc = groupEraseCount(*iGroup);
+        if((bHot && nEc < nBestEc) || (bHot == false && nEc > nBestEc))
+        {
+            nBestEc = nEc;
+            iBest   = iGroup;
+        }
+    }
+
+    UINT32 nGroup           = *iBest;
+    _vctGroupState[nGroup]  = FTL_GROUP_OPEN;
+    _vctFreeGroups[nDie].erase(iBest);
+
+    return nGroup;
+}
+
+// open a block group of the die for host writes of the stream (its group of the open superblock), or for GC of the stream.
+UINT32 NandFtl::openGroup( UINT32 nDie, bool bHot, UINT32 nStream )
+{
+    UINT32 nOpen = nStream * _stDevConfig._nNumsDie + nDie;
+    UINT32 nGroup;
+    if(bHot && _bSuperblock)
+    {
+        if(_vctOpenSb[nStream] == NULL_SIG(UINT32) || _vctSbTaken[nOpen])
+        {
+            openSuperblock(nStream);
+        }
+        nGroup              = _vctSbGroups[_vctOpenSb[nStream]][nDie];
+        _vctSbTaken[nOpen]  = true;
+    }
+    else
+    {
+        nGroup              = takeGroup(nDie, bHot);
+    }
+
+    if(bHot)
+    {
+        _vctOpenGroup[nOpen] = nGroup;
+        _vctWritePtr[nOpen]  = 0;
+    }
+    else
+    {
+        _vctGcOpenGroup[nOpen] = nGroup;
+        for(UINT32 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+        {
+            _vctGcPlanePtr[nOpen * _stDevConfig._nNumsPlane + nPlane] = 0;
+        }
+    }
+
+    return nGroup;
+}
+
+/************************************************************************/
+/* superblocks                                                          */
+/************************************************************************/
+// the die of the stripe position takes the next write of the stream; a die which can't write is passed over.
+UINT32 NandFtl::stripeDie( UINT32 nStream )
+{
+    for(UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsDie; nIdx++)
+    {
+        UINT32 nDie = (_vctNextWriteDie[nStream] + nIdx) % _stDevConfig._nNumsDie;
+        if(writable(nDie, nStream))
+        {
+            return nDie;
+        }
+    }
+
+    return NULL_SIG(UINT32);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    openSuperblock
+// FullName:  NandFtl::openSuperblock
+// Access:    private 
+// Returns:   UINT32 (the opened superblock)
+// Parameter: UINT32 nStream
+//
+// Descriptions -
+// A superblock takes a free block group (a block of each plane) of every die at once,
+// and each die opens its group when the stripe comes to it. The groups need not have 
+// the same block number, so that the superblock is formed of the least worn groups.
+// A die which has no free group but the ones for GC sits out the superblock (its
+// valid pages are not spread evenly, since GC works in each die), and the stripe
+// passes it over.
+//////////////////////////////////////////////////////////////////////////////
+UINT32 NandFtl::openSuperblock( UINT32 nStream )
+{
+    UINT32 nSb = _lstFreeSbs.front();
+    _lstFreeSbs.pop_front();
+
+    _vctSbWidth[nSb]        = 0;
+    for(UINT32 nDie = 0; nDie < _stDevConfig._nNumsDie; nDie++)
+    {
+        UINT32 nOpen                = nStream * _stDevConfig._nNumsDie + nDie;
+        _vctSbGroups[nSb][nDie]     = NULL_SIG(UINT32);
+        _vctSbTaken[nOpen]          = true;
+        if(_vctFreeGroups[nDie].size() > gcReserve(nDie))
+        {
+            UINT32 nGroup           = takeGroup(nDie, true);
+            _vctSbGroups[nSb][nDie] = nGroup;
+            _vctGroupSb[nGroup]     = nSb;
+            _vctSbTaken[nOpen]      = false;
+            _vctSbWidth[nSb]++;
+        }
+    }
+    _vctSbValidCnt[nSb]     = 0;
+    _vctSbLiveGroups[nSb]   = _vctSbWidth[nSb];
+    _vctOpenSb[nStream]     = nSb;
+    _nStatSbOpened++;
+
+    return nSb;
+}
+
+// the utilization of a block group for GC; the groups of a superblock share the one of the superblock.
+double NandFtl::groupUtil( UINT32 nGroup )
+{
+    if(_vctGroupSb[nGroup] != NULL_SIG(UINT32))
+    {
+        return (double)_vctSbValidCnt[_vctGroupSb[nGroup]] / (_nPgsPerGroup * _vctSbWidth[_vctGroupSb[nGroup]]);
+    }
+
+    return (double)_vctValidCnt[nGroup] / _nPgsPerGroup;
+}
+
+void NandFtl::eraseGroup( UINT32 nDie, UINT32 nGroup )
+{
+    for(UINT32 nPlane = 0; nPlane < _stDevConfig._nNumsPlane; nPlane++)
+    {
+        Transaction stTrans;
+        stTrans._nHostTransId   = nDie;
+        stTrans._nTransOp       = (_stDevConfig._nNumsPlane > 1) ? NAND_OP_BLOCK_ERASE_MULTIPLANE : NAND_OP_BLOCK_ERASE;
+        stTrans._nAddr          = physicalAddr(nGroup * _nPgsPerGroup + nPlane);
+        stTrans._nByteOff       = 0;
+        stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+        addTransaction(stTrans);
+    }
+
+    _vctGroupState[nGroup]  = FTL_GROUP_ERASING;
+    _vctErasingGroup[nDie]  = nGroup;
+}
+
+// the pre-erase pool of the die is wanted below the target, once the die has been idle for a while by the controller.
+bool NandFtl::preEraseWanted( UINT32 nDie )
+{
+    if(_vctEraseGroups[nDie].empty() || _vctFreeGroups[nDie].size() >= _nPreEraseTarget)
+    {
+        return false;
+    }
+
+    // nothing else would advance the clock.
+    if(_lstPending.empty() && _flash.IsActiveMode() == false)
+    {
+        return true;
+    }
+
+    UINT64 nIdle = _flash.GetHostClockIdleTime(nDie);
+    if(nIdle < _vctIdleMark[nDie])
+    {
+        // the statistics of the controller are reset.
+        _vctIdleMark[nDie] = nIdle;
+    }
+    return (nIdle - _vctIdleMark[nDie] >= _nPreEraseIdleTime);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    preErase
+// FullName:  NandFtl::preErase
+// Access:    private 
+// Returns:   bool (true if a transaction is issued to the die)
+// Parameter: UINT32 nDie
+// Parameter: bool bIdle (the die is in an idle window)
+//
+// Descriptions -
+// Erase the oldest block group of the pre-erase pool of the die. The erase is 
+// accounted to GC, so that host pages which wait for it are delayed by GC.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::preErase( UINT32 nDie, bool bIdle )
+{
+    if(_vctEraseGroups[nDie].empty())
+    {
+        return false;
+    }
+
+    eraseGroup(nDie, _vctEraseGroups[nDie].front());
+    _vctEraseGroups[nDie].pop_front();
+    _vctGcInFlight[nDie]    = true;
+    _vctWlInFlight[nDie]    = false;
+    _vctGcIssueTime[nDie]   = _flash.CurrentTime();
+    if(bIdle) _nStatIdleErase++;
+    else _nStatDemandErase++;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    moveHeldPage
+// FullName:  NandFtl::moveHeldPage
+// Access:    private 
+// Returns:   bool (true if a transaction is issued to the die)
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// Program the page which GC has read into the plane of the destination with the most room.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::moveHeldPage( UINT32 nDie )
+{
+    const UINT32 nNumsPlane = _stDevConfig._nNumsPlane;
+
+    FtlPageOp   stPageOp    = _vctGcHeldPage[nDie];
+    UINT32      nOpen       = gcDestination(nDie, stPageOp._nLpn);
+    if(nOpen == NULL_SIG(UINT32))
+    {
+        _vctGcExhausted[nDie] = true;
+        return false;
+    }
+    if(_vctGcOpenGroup[nOpen] == NULL_SIG(UINT32))
+    {
+        openGroup(nDie, false, nOpen / _stDevConfig._nNumsDie);
+    }
+
+    UINT32 nTarget = 0;
+    for(UINT32 nPlane = 1; nPlane < nNumsPlane; nPlane++)
+    {
+        if(_vctGcPlanePtr[nOpen * nNumsPlane + nPlane] < _vctGcPlanePtr[nOpen * nNumsPlane + nTarget]) nTarget = nPlane;
+    }
+
+    UINT32      nDst        = _vctGcOpenGroup[nOpen] * _nPgsPerGroup + _vctGcPlanePtr[nOpen * nNumsPlane + nTarget] * nNumsPlane + nTarget;
+    UINT8       *pStaging   = _vctpStaging[nDie * nNumsPlane + nTarget].get();
+    memcpy(pStaging, _vctpGcBuffer[nDie].get(), _stDevConfig._nPgSize);
+
+    Transaction stTrans;
+    stTrans._nHostTransId   = nDie;
+    stTrans._nTransOp       = NAND_OP_PROG;
+    stTrans._nAddr          = physicalAddr(nDst);
+    stTrans._nByteOff       = 0;
+    stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+    stTrans._pData          = pStaging;
+    addTransaction(stTrans);
+
+    remap(stPageOp._nLpn, nDst);
+    stPageOp._nPpn          = nDst;
+    _vctGcPlanePtr[nOpen * nNumsPlane + nTarget]++;
+    _vctInFlight[nDie].push_back(stPageOp);
+    _vctGcHeld[nDie]        = false;
+    _vctGcInFlight[nDie]    = true;
+    _vctWlInFlight[nDie]    = _vctWlMove[nDie];
+    _vctGcIssueTime[nDie]   = _flash.CurrentTime();
+    if(_vctWlMove[nDie]) _nStatWlPages++;
+    else _nStatGcReadProg++;
+    _nStatFlashWritePgs++;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    issueWrite
+// FullName:  NandFtl::issueWrite
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nDie
+// Parameter: std::vector< std::list<FtlPageOp>::iterator > & vctBatch
+//
+// Descriptions -
+// Place the batch at the write pointer of the open group of its stream and update the mapping.
+// A full batch from the first plane is programmed by NAND_OP_PROG_MULTIPLANE, 
+// otherwise the first page of the batch is programmed alone and the rest stays in the queue.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::issueWrite( UINT32 nDie, std::vector< std::list<FtlPageOp>::iterator > &vctBatch )
+{
+    const UINT32 nNumsPlane = _stDevConfig._nNumsPlane;
+    const UINT32 nStream    = vctBatch[0]->_nStream;
+    const UINT32 nOpen      = nStream * _stDevConfig._nNumsDie + nDie;
+
+    if(_vctOpenGroup[nOpen] == NULL_SIG(UINT32))
+    {
+        assert(writable(nDie, nStream));
+        openGroup(nDie, true, nStream);
+    }
+
+    UINT32          nGroup  = _vctOpenGroup[nOpen];
+    bool            bNx     = (nNumsPlane > 1 && vctBatch.size() == nNumsPlane && _vctWritePtr[nOpen] % nNumsPlane == 0);
+    UINT32          nNums   = (bNx) ? nNumsPlane : 1;
+    NAND_TRANS_OP   nOp     = (bNx) ? NAND_OP_PROG_MULTIPLANE : NAND_OP_PROG;
+
+    for(UINT32 nIdx = 0; nIdx < nNums; nIdx++)
+    {
+        FtlPageOp   &stPageOp   = *vctBatch[nIdx];
+        UINT32      nPpn        = nGroup * _nPgsPerGroup + _vctWritePtr[nOpen] + nIdx;
+        UINT8       *pStaging   = _vctpStaging[nDie * nNumsPlane + planeOf(nPpn)].get();
+
+        if(stPageOp._pData != NULL)
+        {
+            memcpy(pStaging, stPageOp._pData, _stDevConfig._nPgSize);
+        }
+
+        Transaction stTrans;
+        stTrans._nHostTransId   = nDie;
+        stTrans._nTransOp       = nOp;
+        stTrans._nAddr          = physicalAddr(nPpn);
+        stTrans._nByteOff       = 0;
+        stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+        stTrans._pData          = pStaging;
+        addTransaction(stTrans);
+
+        remap(stPageOp._nLpn, nPpn);
+        stPageOp._nPpn          = nPpn;
+        if(stPageOp._nLpn >= _nNumsLpn)
+        {
+            _setMapFlushing.erase(stPageOp._nLpn - _nNumsLpn);
+            _nStatMapWrites++;
+        }
+        _vctInFlight[nDie].push_back(stPageOp);
+        _lstPending.erase(vctBatch[nIdx]);
+    }
+
+    _nStatFlashWritePgs     += nNums;
+    if(bNx) _nStatNxWrite++;
+
+    _vctWritePtr[nOpen]     += nNums;
+    if(_vctWritePtr[nOpen] == _nPgsPerGroup)
+    {
+        _vctGroupState[nGroup]  = FTL_GROUP_FULL;
+        _vctGroupTime[nGroup]   = _flash.CurrentTime();
+        _vctOpenGroup[nOpen]    = NULL_SIG(UINT32);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    issueRead
+// FullName:  NandFtl::issueRead
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nDie
+// Parameter: std::vector< std::list<FtlPageOp>::iterator > & vctBatch
+//
+// Descriptions -
+// A batch which covers all planes is read by NAND_OP_READ_MULTIPLANE in the plane order,
+// otherwise the first page of the batch is read alone and the rest stays in the queue.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::issueRead( UINT32 nDie, std::vector< std::list<FtlPageOp>::iterator > &vctBatch )
+{
+    const UINT32    nNumsPlane  = _stDevConfig._nNumsPlane;
+    bool            bNx         = (nNumsPlane > 1 && vctBatch.size() == nNumsPlane);
+    UINT32          nNums       = (bNx) ? nNumsPlane : 1;
+
+    for(UINT32 nPlane = 0; nPlane < nNums; nPlane++)
+    {
+        UINT32 nIdx = 0;
+        while(bNx && planeOf(vctBatch[nIdx]->_nPpn) != nPlane) nIdx++;
+
+        FtlPageOp   &stPageOp   = *vctBatch[nIdx];
+        Transaction stTrans;
+        stTrans._nHostTransId   = nDie;
+        stTrans._nTransOp       = (bNx) ? NAND_OP_READ_MULTIPLANE : NAND_OP_READ;
+        stTrans._nAddr          = physicalAddr(stPageOp._nPpn);
+        stTrans._nByteOff       = 0;
+        stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+        stTrans._pData          = _vctpStaging[nDie * nNumsPlane + planeOf(stPageOp._nPpn)].get();
+        addTransaction(stTrans);
+
+        _vctInFlight[nDie].push_back(stPageOp);
+    }
+
+    // the batch is searched by plane above, so that its pages leave the queue only after all planes are issued.
+    for(UINT32 nIdx = 0; nIdx < nNums; nIdx++)
+    {
+        _lstPending.erase(vctBatch[nIdx]);
+    }
+
+    _nStatFlashReadPgs  += nNums;
+    if(bNx) _nStatNxRead++;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    retire
+// FullName:  NandFtl::retire
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// Complete the pages (or the erase) of the transaction which the die has finished.
+// A page which GC has read is held for its program.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::retire( UINT32 nDie )
+{
+    UINT64  nTime       = _vctCompletionTime[nDie];
+    UINT32  nNumsPlane  = _stDevConfig._nNumsPlane;
+
+    for(UINT32 nIdx = 0; nIdx < _vctInFlight[nDie].size(); nIdx++)
+    {
+        FtlPageOp &stPageOp = _vctInFlight[nDie][nIdx];
+        if(stPageOp._bPrefetch == true)
+        {
+            // a prefetch which has been dropped under reading gives its slot back.
+            std::map<UINT32, FtlPrefetch>::iterator iEntry = _mapPrefetch.find(stPageOp._nLpn);
+            if(iEntry != _mapPrefetch.end() && iEntry->second._nSlot == stPageOp._nSlot)
+            {
+                iEntry->second._bReady = true;
+            }
+            else
+            {
+                _lstPrefetchFree.push_back(stPageOp._nSlot);
+            }
+            continue;
+        }
+        if(stPageOp._nSlot != NULL_SIG(UINT32))
+        {
+            _lstBufferFree.push_back(stPageOp._nSlot);
+        }
+        if(stPageOp._nReqKey == NULL_SIG(UINT32) && stPageOp._nSrcPpn == NULL_SIG(UINT32))
+        {
+            // a translation page
+            if(stPageOp._nOp == NAND_FTL_READ) mapLoaded(stPageOp._nLpn - _nNumsLpn);
+            continue;
+        }
+        if(stPageOp._nReqKey == NULL_SIG(UINT32))
+        {
+            if(stPageOp._nOp == NAND_FTL_READ && _vctP2L[stPageOp._nSrcPpn] == stPageOp._nLpn)
+            {
+                memcpy(_vctpGcBuffer[nDie].get(), _vctpStaging[nDie * nNumsPlane + planeOf(stPageOp._nSrcPpn)].get(), _stDevConfig._nPgSize);
+                _vctGcHeldPage[nDie]            = stPageOp;
+                _vctGcHeldPage[nDie]._nOp       = NAND_FTL_WRITE;
+                _vctGcHeld[nDie]                = true;
+            }
+            continue;
+        }
+
+        if(stPageOp._nOp == NAND_FTL_READ && stPageOp._pData != NULL)
+        {
+            memcpy(stPageOp._pData, _vctpStaging[nDie * nNumsPlane + planeOf(stPageOp._nPpn)].get(), _stDevConfig._nPgSize);
+        }
+        if(stPageOp._nOp == NAND_FTL_READ && _nPrefetchPages != 0 && followed(stPageOp._nLpn))
+        {
+            _nStatPrefetchMisses++;
+        }
+        completePage(stPageOp, nTime);
+    }
+    _vctInFlight[nDie].clear();
+
+    if(_vctErasingGroup[nDie] != NULL_SIG(UINT32))
+    {
+        UINT32 nGroup               = _vctErasingGroup[nDie];
+        if(_vctGroupSb[nGroup] != NULL_SIG(UINT32))
+        {
+            // the superblock is over once all of its groups are erased.
+            if(--_vctSbLiveGroups[_vctGroupSb[nGroup]] == 0) _lstFreeSbs.push_back(_vctGroupSb[nGroup]);
+            _vctGroupSb[nGroup]     = NULL_SIG(UINT32);
+        }
+        _vctGroupState[nGroup]      = FTL_GROUP_FREE;
+        _vctGroupEc[nGroup]++;
+        _vctFreeGroups[nDie].push_back(nGroup);
+        _vctErasingGroup[nDie]      = NULL_SIG(UINT32);
+        _vctGcExhausted[nDie]       = false;
+        _nStatErase++;
+        checkWear(nDie);
+    }
+
+    if(_vctGcInFlight[nDie] == true)
+    {
+        if(_vctWlInFlight[nDie]) _vctStatWlTime[nDie] += nTime - _vctGcIssueTime[nDie];
+        else _vctStatGcTime[nDie] += nTime - _vctGcIssueTime[nDie];
+        _vctGcInFlight[nDie]        = false;
+        _vctWlInFlight[nDie]        = false;
+    }
+
+    for(UINT32 nOpen = nDie; nOpen < _vctGcOpenGroup.size(); nOpen += _stDevConfig._nNumsDie)
+    {
+        if(_vctGcOpenGroup[nOpen] == NULL_SIG(UINT32)) continue;
+
+        // a destination is closed when the blocks of all planes are full.
+        bool bFull = true;
+        for(UINT32 nPlane = 0; bFull && nPlane < nNumsPlane; nPlane++)
+        {
+            bFull = (_vctGcPlanePtr[nOpen * nNumsPlane + nPlane] >= _stDevConfig._nNumsPgPerBlk);
+        }
+        if(bFull)
+        {
+            _vctGroupState[_vctGcOpenGroup[nOpen]]  = FTL_GROUP_FULL;
+            _vctGroupTime[_vctGcOpenGroup[nOpen]]   = nTime;
+            _vctGcOpenGroup[nOpen]                  = NULL_SIG(UINT32);
+        }
+    }
+
+    _vctCompleted[nDie] = false;
+    _vctIdleMark[nDie]  = _flash.GetHostClockIdleTime(nDie);
+}
+
+void NandFtl::completePage( FtlPageOp &stPageOp, UINT64 nTime, bool bFailed )
+{
+    switch((bFailed) ? NAND_FTL_OP_MAX : stPageOp._nOp)
+    {
+    case NAND_FTL_READ :    _nStatHostReadPgs++;    break;
+    case NAND_FTL_WRITE :   _nStatHostWritePgs++;   break;
+    case NAND_FTL_TRIM :    _nStatTrimPgs++;        break;
+    default :               _nStatFailedPgs++;      break;
+    }
+    if(bFailed == false && stPageOp._nOp == NAND_FTL_WRITE) _vctStatStreamHostPgs[stPageOp._nStream]++;
+
+    std::map<UINT32, FtlRequest>::iterator iReq = _mapRequests.find(stPageOp._nReqKey);
+    assert(iReq != _mapRequests.end());
+    iReq->second._bGcDelayed |= stPageOp._bGcDelayed;
+    iReq->second._bWlDelayed |= stPageOp._bWlDelayed;
+    iReq->second._bMapDelayed |= stPageOp._bMapDelayed;
+    iReq->second._bEraseDelayed |= stPageOp._bEraseDelayed;
+    if(--iReq->second._nNumsPending != 0)
+    {
+        return;
+    }
+
+    FtlRequest  stReq       = iReq->second;
+    UINT64      nLatency    = nTime - stReq._nArrivalTime;
+    _mapRequests.erase(iReq);
+
+    _vctStatReqs[stReq._nOp]++;
+    if(stReq._bGcDelayed) _nStatGcDelayedReqs++;
+    if(stReq._bWlDelayed) _nStatWlDelayedReqs++;
+    if(stReq._bEraseDelayed)
+    {
+        _nStatEraseDelayedReqs++;
+        if(stReq._nOp == NAND_FTL_WRITE) _nStatEraseDelayedWrites++;
+    }
+    if(stReq._bMapDelayed)
+    {
+        _nStatMapDelayedReqs++;
+        _nStatMapDelayedLatency += nTime - stReq._nArrivalTime;
+    }
+    _vctStatLatency[stReq._nOp] += nLatency;
+    if(_vctStatMaxLatency[stReq._nOp] < nLatency) _vctStatMaxLatency[stReq._nOp] = nLatency;
+
+    if(_pHostCallback != NULL)
+    {
+        (*_pHostCallback)(stReq._nHostReqId, stReq._nArrivalTime, nTime);
+    }
+}
+
+void NandFtl::invalidate( UINT32 nPpn )
+{
+    assert(_vctValidCnt[groupOf(nPpn)] != 0);
+    _vctP2L[nPpn] = NULL_SIG(UINT32);
+    _vctValidCnt[groupOf(nPpn)]--;
+    if(_vctGroupSb[groupOf(nPpn)] != NULL_SIG(UINT32)) _vctSbValidCnt[_vctGroupSb[groupOf(nPpn)]]--;
+    _vctGcExhausted[dieOf(nPpn)] = false;
+}
+
+void NandFtl::remap( UINT32 nLpn, UINT32 nPpn )
+{
+    if(_vctL2P[nLpn] != NULL_SIG(UINT32))
+    {
+        invalidate(_vctL2P[nLpn]);
+    }
+    _vctL2P[nLpn]   = nPpn;
+    _vctP2L[nPpn]   = nLpn;
+    _vctValidCnt[groupOf(nPpn)]++;
+    if(_vctGroupSb[groupOf(nPpn)] != NULL_SIG(UINT32)) _vctSbValidCnt[_vctGroupSb[groupOf(nPpn)]]++;
+    if(nLpn < _nNumsLpn) mapUpdate(nLpn);
+    if(nLpn < _nNumsLpn) _vctStatStreamFlashPgs[_vctLpnStream[nLpn]]++;
+}
+
+/************************************************************************/
+/* mapping cache                                                        */
+/************************************************************************/
+bool NandFtl::mapLookup( UINT32 nLpn )
+{
+    std::map<UINT32, FtlMapEntry>::iterator iEntry = _mapMapCache.find(nLpn);
+    if(iEntry == _mapMapCache.end())
+    {
+        return false;
+    }
+
+    _lstMapLru.splice(_lstMapLru.begin(), _lstMapLru, iEntry->second._iLru);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    mapInsert
+// FullName:  NandFtl::mapInsert
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nLpn
+//
+// Descriptions -
+// Cache a clean mapping entry. If the cache is full, the least recently used entry 
+// is evicted, and its translation page is written back if the entry is dirty.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::mapInsert( UINT32 nLpn )
+{
+    FtlMapEntry stEntry;
+    _lstMapLru.push_front(nLpn);
+    stEntry._iLru       = _lstMapLru.begin();
+    stEntry._bDirty     = false;
+    _mapMapCache[nLpn]  = stEntry;
+
+    if(_mapMapCache.size() > _nMapCacheEntries)
+    {
+        UINT32 nVictim = _lstMapLru.back();
+        if(_mapMapCache[nVictim]._bDirty)
+        {
+            mapFlush(nVictim / _nMapEntriesPerPage);
+        }
+        _mapMapCache.erase(nVictim);
+        _lstMapLru.pop_back();
+    }
+}
+
+// the mapping of a logical page has changed; an entry which is not cached goes to its translation page.
+void NandFtl::mapUpdate( UINT32 nLpn )
+{
+    if(_nMapCacheEntries == 0)
+    {
+        return;
+    }
+
+    std::map<UINT32, FtlMapEntry>::iterator iEntry = _mapMapCache.find(nLpn);
+    if(iEntry != _mapMapCache.end())
+    {
+        iEntry->second._bDirty = true;
+    }
+    else
+    {
+        mapFlush(nLpn / _nMapEntriesPerPage);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    mapFlush
+// FullName:  NandFtl::mapFlush
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nTvpn
+//
+// Descriptions -
+// Queue the write of a translation page, which carries all dirty entries of the page, 
+// unless the write is already queued.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::mapFlush( UINT32 nTvpn )
+{
+    std::map<UINT32, FtlMapEntry>::iterator iEntry  = _mapMapCache.lower_bound(nTvpn * _nMapEntriesPerPage);
+    std::map<UINT32, FtlMapEntry>::iterator iEnd    = _mapMapCache.lower_bound((nTvpn + 1) * _nMapEntriesPerPage);
+    for(; iEntry != iEnd; ++iEntry)
+    {
+        iEntry->second._bDirty = false;
+    }
+
+    if(_setMapFlushing.insert(nTvpn).second == true)
+    {
+        FtlPageOp   stPageOp;
+        stPageOp._nReqKey       = NULL_SIG(UINT32);
+        stPageOp._nOp           = NAND_FTL_WRITE;
+        stPageOp._nLpn          = _nNumsLpn + nTvpn;
+        stPageOp._nPpn          = NULL_SIG(UINT32);
+        stPageOp._nSrcPpn       = NULL_SIG(UINT32);
+        stPageOp._pData         = NULL;
+        stPageOp._bMapLooked    = true;
+        stPageOp._bMapReady     = true;
+        stPageOp._nStream       = _nWriteStreams - 1;   // translation pages are updated the most
+        _lstPending.push_back(stPageOp);
+    }
+}
+
+/************************************************************************/
+/* write buffer                                                         */
+/************************************************************************/
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    buffer
+// FullName:  NandFtl::buffer
+// Access:    private 
+// Returns:   bool (true if the write buffer has completed the page)
+// Parameter: FtlPageOp & stPageOp
+// Parameter: bool & bBlocked (the write waits for a free slot)
+//
+// Descriptions -
+// A read of a buffered page and a write which gets a slot (or overwrites its buffered
+// page) complete after their DRAM transfer. A FUA write or a trim drops the buffered 
+// page, and goes on to the flash.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::buffer( FtlPageOp &stPageOp, bool &bBlocked )
+{
+    std::map<UINT32, UINT32>::iterator iSlot = _mapBuffer.find(stPageOp._nLpn);
+
+    switch(stPageOp._nOp)
+    {
+    case NAND_FTL_READ :
+        if(iSlot == _mapBuffer.end())
+        {
+            return false;
+        }
+        if(stPageOp._pData != NULL)
+        {
+            memcpy(stPageOp._pData, _pBufferData.get() + (UINT64)iSlot->second * NAND_FULL_PAGE_SIZE(_stDevConfig), _stDevConfig._nPgSize);
+        }
+        _nStatBufferReadHits++;
+        completePage(stPageOp, dramTime(_stDevConfig._nPgSize));
+        return true;
+
+    case NAND_FTL_WRITE :
+        if(stPageOp._bFua == true)
+        {
+            unbuffer(stPageOp._nLpn);
+            return false;
+        }
+
+        if(iSlot == _mapBuffer.end())
+        {
+            if(_lstBufferFree.empty())
+            {
+                if(stPageOp._bBufferStalled == false) _nStatBufferStalls++;
+                stPageOp._bBufferStalled    = true;
+                _bBufferFlushing            = true;
+                bBlocked                    = true;
+                return false;
+            }
+            iSlot = _mapBuffer.insert(std::make_pair(stPageOp._nLpn, _lstBufferFree.front())).first;
+            _lstBufferFree.pop_front();
+            _lstBufferOrder.push_back(stPageOp._nLpn);
+        }
+        else
+        {
+            _nStatBufferOverwritePgs++;
+        }
+
+        if(stPageOp._pData != NULL)
+        {
+            memcpy(_pBufferData.get() + (UINT64)iSlot->second * NAND_FULL_PAGE_SIZE(_stDevConfig), stPageOp._pData, _stDevConfig._nPgSize);
+        }
+        _nStatBufferWritePgs++;
+        completePage(stPageOp, dramTime(_stDevConfig._nPgSize));
+        return true;
+
+    default :
+        unbuffer(stPageOp._nLpn);
+        return false;
+    }
+}
+
+void NandFtl::unbuffer( UINT32 nLpn )
+{
+    std::map<UINT32, UINT32>::iterator iSlot = _mapBuffer.find(nLpn);
+    if(iSlot != _mapBuffer.end())
+    {
+        _lstBufferFree.push_back(iSlot->second);
+        _lstBufferOrder.remove(nLpn);
+        _mapBuffer.erase(iSlot);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    flushWanted
+// FullName:  NandFtl::flushWanted
+// Access:    private 
+// Returns:   bool
+// Parameter: void
+//
+// Descriptions -
+// The buffer is flushed from the high watermark down to the low watermark, and 
+// entirely once the host has been idle for the idle time. If nothing keeps the flash
+// busy, the simulation time doesn't pass, so that the host is taken as idle at once.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::flushWanted( void )
+{
+    if(_mapBuffer.size() >= _nBufferHighWatermark)
+    {
+        _bBufferFlushing = true;
+    }
+    else if(_mapBuffer.size() <= _nBufferLowWatermark)
+    {
+        _bBufferFlushing = false;
+    }
+
+    if(_mapBuffer.empty())
+    {
+        return false;
+    }
+
+    return (_bBufferFlushing || (_lstPending.empty() && (_flash.CurrentTime() - _nLastHostTime >= _nBufferIdleTime || _flash.IsActiveMode() == false)));
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    flush
+// FullName:  NandFtl::flush
+// Access:    private 
+// Returns:   bool (true if a transaction is issued to the die)
+// Parameter: UINT32 nDie
+//
+// Descriptions -
+// Program the oldest buffered pages into the open group of the die. The buffer is 
+// shared out among the dies in rows of a page per plane, and the rows go out as 
+// a single NAND_OP_PROG_MULTIPLANE_CACHE sequence which ends at the last sub-transaction.
+// Less than a row, or a write pointer which is not at the first plane, takes a page program.
+// Only the pages of the write stream of the oldest page go to its open group.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::flush( UINT32 nDie )
+{
+    const UINT32 nNumsPlane = _stDevConfig._nNumsPlane;
+    const UINT32 nStream    = _vctLpnStream[_lstBufferOrder.front()];
+    const UINT32 nOpen      = nStream * _stDevConfig._nNumsDie + nDie;
+
+    if(writable(nDie, nStream) == false)
+    {
+        return false;
+    }
+    if(_vctOpenGroup[nOpen] == NULL_SIG(UINT32))
+    {
+        openGroup(nDie, true, nStream);
+    }
+
+    std::vector< std::list<UINT32>::iterator > vctPages;
+    for(std::list<UINT32>::iterator iLpn = _lstBufferOrder.begin(); iLpn != _lstBufferOrder.end(); ++iLpn)
+    {
+        if(_vctLpnStream[*iLpn] == nStream) vctPages.push_back(iLpn);
+    }
+
+    UINT32  nGroup  = _vctOpenGroup[nOpen];
+    UINT32  nRows   = 0;
+    if(_vctWritePtr[nOpen] % nNumsPlane == 0)
+    {
+        UINT32 nNumsRow = vctPages.size() / nNumsPlane;
+        nRows = (nNumsRow + _stDevConfig._nNumsDie - 1) / _stDevConfig._nNumsDie;
+        if(nRows > (_nPgsPerGroup - _vctWritePtr[nOpen]) / nNumsPlane) nRows = (_nPgsPerGroup - _vctWritePtr[nOpen]) / nNumsPlane;
+    }
+    bool    bCache  = (nRows != 0 && nNumsPlane > 1);
+    UINT32  nNums   = (bCache) ? nRows * nNumsPlane : 1;
+
+    for(UINT32 nIdx = 0; nIdx < nNums; nIdx++)
+    {
+        FtlPageOp   stPageOp;
+        stPageOp._nOp           = NAND_FTL_WRITE;
+        stPageOp._nLpn          = *vctPages[nIdx];
+        stPageOp._nPpn          = nGroup * _nPgsPerGroup + _vctWritePtr[nOpen];
+        stPageOp._nSlot         = _mapBuffer[stPageOp._nLpn];
+        stPageOp._nStream       = nStream;
+        _lstBufferOrder.erase(vctPages[nIdx]);
+        _mapBuffer.erase(stPageOp._nLpn);
+
+        Transaction stTrans;
+        stTrans._nHostTransId   = nDie;
+        stTrans._nTransOp       = (bCache) ? NAND_OP_PROG_MULTIPLANE_CACHE : NAND_OP_PROG;
+        stTrans._nAddr          = physicalAddr(stPageOp._nPpn);
+        stTrans._nByteOff       = 0;
+        stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+        stTrans._pData          = _pBufferData.get() + (UINT64)stPageOp._nSlot * NAND_FULL_PAGE_SIZE(_stDevConfig);
+        stTrans._bLastNxSubTrans= (nIdx == nNums - 1);
+        addTransaction(stTrans);
+
+        remap(stPageOp._nLpn, stPageOp._nPpn);
+        _vctInFlight[nDie].push_back(stPageOp);
+        _vctWritePtr[nOpen]++;
+    }
+
+    _nStatBufferFlushes++;
+    if(_bSuperblock) _vctNextWriteDie[nStream] = (nDie + 1) % _stDevConfig._nNumsDie;
+    _nStatBufferFlushPgs    += nNums;
+    if(bCache == true) _nStatNxWrite++;
+    _nStatFlashWritePgs     += nNums;
+    if(_vctWritePtr[nOpen] == _nPgsPerGroup)
+    {
+        _vctGroupState[nGroup]  = FTL_GROUP_FULL;
+        _vctGroupTime[nGroup]   = _flash.CurrentTime();
+        _vctOpenGroup[nOpen]    = NULL_SIG(UINT32);
+    }
+
+    return true;
+}
+
+// the DRAM transfer of the buffer is serialized at its bandwidth.
+UINT64 NandFtl::dramTime( UINT32 nNumsByte )
+{
+    UINT64 nStart       = (_nDramBusyUntil > _flash.CurrentTime()) ? _nDramBusyUntil : _flash.CurrentTime();
+    _nDramBusyUntil     = nStart + ((_nDramBandwidth != 0) ? (UINT64)nNumsByte * 1000 / _nDramBandwidth : 0);
+    return _nDramBusyUntil;
+}
+
+/************************************************************************/
+/* read-ahead                                                           */
+/************************************************************************/
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    detectStream
+// FullName:  NandFtl::detectStream
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nLpn
+// Parameter: UINT32 nNumsPage
+//
+// Descriptions -
+// A host read which continues a stream extends it; otherwise it starts a stream
+// in place of the least recently used one, whose prefetches are dropped. Once 
+// the stream has read the trigger pages in a row, the pages ahead of it are queued
+// for prefetching as long as the prefetch buffer has room.
+//////////////////////////////////////////////////////////////////////////////
+void NandFtl::detectStream( UINT32 nLpn, UINT32 nNumsPage )
+{
+    UINT32  nStream = NULL_SIG(UINT32);
+    UINT32  nVictim = 0;
+    for(UINT32 nIdx = 0; nIdx < _vctStreams.size(); nIdx++)
+    {
+        if(_vctStreams[nIdx]._nRunPgs != 0 && _vctStreams[nIdx]._nNextLpn == nLpn)
+        {
+            nStream = nIdx;
+            break;
+        }
+        if(_vctStreams[nIdx]._nLastTime < _vctStreams[nVictim]._nLastTime) nVictim = nIdx;
+    }
+
+    if(nStream == NULL_SIG(UINT32))
+    {
+        std::vector<UINT32> vctDrop;
+        for(std::map<UINT32, FtlPrefetch>::iterator iEntry = _mapPrefetch.begin(); iEntry != _mapPrefetch.end(); ++iEntry)
+        {
+            if(iEntry->second._nStream == nVictim) vctDrop.push_back(iEntry->first);
+        }
+        for(UINT32 nIdx = 0; nIdx < vctDrop.size(); nIdx++)
+        {
+            unprefetch(vctDrop[nIdx]);
+        }
+
+        nStream                         = nVictim;
+        _vctStreams[nStream]._nRunPgs   = 0;
+        _vctStreams[nStream]._nAheadLpn = nLpn;
+    }
+
+    FtlReadStream &stStream = _vctStreams[nStream];
+    stStream._nRunPgs       += nNumsPage;
+    stStream._nNextLpn      = nLpn + nNumsPage;
+    stStream._nLastTime     = _flash.CurrentTime();
+    if(stStream._nAheadLpn < stStream._nNextLpn) stStream._nAheadLpn = stStream._nNextLpn;
+    if(stStream._nRunPgs < _nPrefetchTrigger)
+    {
+        return;
+    }
+
+    UINT32 nLimit = (_nNumsLpn - stStream._nNextLpn > _nPrefetchPages) ? stStream._nNextLpn + _nPrefetchPages : _nNumsLpn;
+    while(stStream._nAheadLpn < nLimit && _mapPrefetch.size() < _nPrefetchPages)
+    {
+        UINT32 nAhead = stStream._nAheadLpn++;
+        if(_vctL2P[nAhead] == NULL_SIG(UINT32) || _mapPrefetch.find(nAhead) != _mapPrefetch.end())
+        {
+            continue;
+        }
+
+        FtlPrefetch stEntry;
+        stEntry._nSlot      = NULL_SIG(UINT32);
+        stEntry._nStream    = nStream;
+        stEntry._bReady     = false;
+        _mapPrefetch[nAhead] = stEntry;
+        _lstPrefetchQueue.push_back(nAhead);
+    }
+}
+
+// a detected stream has passed over the logical page, and the page is below its prefetch frontier.
+// A host read of such a page from the flash is a prefetch miss.
+bool NandFtl::followed( UINT32 nLpn )
+{
+    for(UINT32 nIdx = 0; nIdx < _vctStreams.size(); nIdx++)
+    {
+        FtlReadStream &stStream = _vctStreams[nIdx];
+        if(stStream._nRunPgs >= _nPrefetchTrigger && nLpn < stStream._nAheadLpn &&
+           nLpn + stStream._nRunPgs >= stStream._nNextLpn + _nPrefetchTrigger)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// drop the prefetch of a logical page; the slot of a prefetch under reading is given back at its retirement.
+void NandFtl::unprefetch( UINT32 nLpn )
+{
+    std::map<UINT32, FtlPrefetch>::iterator iEntry = _mapPrefetch.find(nLpn);
+    if(iEntry == _mapPrefetch.end())
+    {
+        return;
+    }
+
+    if(iEntry->second._nSlot == NULL_SIG(UINT32))
+    {
+        _lstPrefetchQueue.remove(nLpn);
+    }
+    else
+    {
+        _nStatPrefetchWasted++;
+        if(iEntry->second._bReady) _lstPrefetchFree.push_back(iEntry->second._nSlot);
+    }
+    _mapPrefetch.erase(iEntry);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    prefetched
+// FullName:  NandFtl::prefetched
+// Access:    private 
+// Returns:   bool (true if the prefetch buffer has completed the page)
+// Parameter: FtlPageOp & stPageOp
+// Parameter: bool & bBlocked (the read waits for the prefetch under reading)
+//
+// Descriptions -
+// A host read takes the prefetched page after its DRAM transfer. A prefetch which
+// is only queued is dropped, and the host read goes to the flash by itself.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::prefetched( FtlPageOp &stPageOp, bool &bBlocked )
+{
+    std::map<UINT32, FtlPrefetch>::iterator iEntry = _mapPrefetch.find(stPageOp._nLpn);
+    if(iEntry == _mapPrefetch.end())
+    {
+        return false;
+    }
+
+    if(iEntry->second._nSlot == NULL_SIG(UINT32))
+    {
+        _lstPrefetchQueue.remove(stPageOp._nLpn);
+        _mapPrefetch.erase(iEntry);
+        return false;
+    }
+
+    if(iEntry->second._bReady == false)
+    {
+        bBlocked = true;
+        return false;
+    }
+
+    if(stPageOp._pData != NULL)
+    {
+        memcpy(stPageOp._pData, _pPrefetchData.get() + (UINT64)iEntry->second._nSlot * NAND_FULL_PAGE_SIZE(_stDevConfig), _stDevConfig._nPgSize);
+    }
+    _lstPrefetchFree.push_back(iEntry->second._nSlot);
+    _mapPrefetch.erase(iEntry);
+    _nStatPrefetchHits++;
+    completePage(stPageOp, dramTime(_stDevConfig._nPgSize));
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    prefetch
+// FullName:  NandFtl::prefetch
+// Access:    private 
+// Returns:   bool (true if a transaction is issued to the die)
+// Parameter: UINT32 nDie
+// Parameter: std::set<UINT32> & setBlocked (logical pages which have pending pages)
+//
+// Descriptions -
+// Read a queued page of the die by NAND_OP_READ_CACHE. The page which continues
+// the cache read of the die goes first, and then the lowest address, so that
+// the pages of each plane are read in a row. A queued page which is unmapped, 
+// buffered, not cached in the mapping cache or has a pending page is dropped, 
+// since its data could be stale by the time the host reads it.
+//////////////////////////////////////////////////////////////////////////////
+bool NandFtl::prefetch( UINT32 nDie, std::set<UINT32> &setBlocked )
+{
+    typedef std::list<UINT32>::iterator LpnIter;
+
+    if(_lstPrefetchFree.empty())
+    {
+        return false;
+    }
+
+    LpnIter iBest       = _lstPrefetchQueue.end();
+    UINT32  nBestAddr   = NULL_SIG(UINT32);
+    for(LpnIter iLpn = _lstPrefetchQueue.begin(); iLpn != _lstPrefetchQueue.end(); )
+    {
+        UINT32 nPpn = _vctL2P[*iLpn];
+        if(nPpn == NULL_SIG(UINT32) || setBlocked.find(*iLpn) != setBlocked.end() || _mapBuffer.find(*iLpn) != _mapBuffer.end() ||
+           (_nMapCacheEntries != 0 && _mapMapCache.find(*iLpn) == _mapMapCache.end()))
+        {
+            _mapPrefetch.erase(*iLpn);
+            iLpn = _lstPrefetchQueue.erase(iLpn);
+            continue;
+        }
+
+        if(dieOf(nPpn) == nDie)
+        {
+            UINT32 nAddr = physicalAddr(nPpn);
+            if(nAddr == _vctCacheReadNext[nDie])
+            {
+                iBest       = iLpn;
+                nBestAddr   = nAddr;
+                break;
+            }
+            if(iBest == _lstPrefetchQueue.end() || nAddr < nBestAddr)
+            {
+                iBest       = iLpn;
+                nBestAddr   = nAddr;
+            }
+        }
+        ++iLpn;
+    }
+
+    if(iBest == _lstPrefetchQueue.end())
+    {
+        return false;
+    }
+
+    FtlPrefetch &stEntry    = _mapPrefetch[*iBest];
+    stEntry._nSlot          = _lstPrefetchFree.front();
+    _lstPrefetchFree.pop_front();
+
+    FtlPageOp   stPageOp;
+    stPageOp._nOp           = NAND_FTL_READ;
+    stPageOp._nLpn          = *iBest;
+    stPageOp._nPpn          = _vctL2P[*iBest];
+    stPageOp._nSlot         = stEntry._nSlot;
+    stPageOp._bPrefetch     = true;
+    _lstPrefetchQueue.erase(iBest);
+
+    Transaction stTrans;
+    stTrans._nHostTransId   = nDie;
+    stTrans._nTransOp       = NAND_OP_READ_CACHE;
+    stTrans._nAddr          = nBestAddr;
+    stTrans._nByteOff       = 0;
+    stTrans._nNumsByte      = NAND_FULL_PAGE_SIZE(_stDevConfig);
+    stTrans._pData          = _pPrefetchData.get() + (UINT64)stPageOp._nSlot * NAND_FULL_PAGE_SIZE(_stDevConfig);
+    addTransaction(stTrans);
+    _vctInFlight[nDie].push_back(stPageOp);
+
+    if(nBestAddr == _vctCacheReadNext[nDie]) _nStatPrefetchCacheReads++;
+    _vctCacheReadNext[nDie] = (pageOf(stPageOp._nPpn) + 1 < _stDevConfig._nNumsPgPerBlk) ? nBestAddr + 1 : NULL_SIG(UINT32);
+    _nStatPrefetchPgs++;
+    _nStatFlashReadPgs++;
+    return true;
+}
+
+// the pages waiting for the translation page take their mapping from it, 
+// and their entries are cached as many as the cache holds.
+void NandFtl::mapLoaded( UINT32 nTvpn )
+{
+    UINT32 nInserted = 0;
+
+    _setMapLoading.erase(nTvpn);
+    for(std::list<FtlPageOp>::iterator iPage = _lstPending.begin(); iPage != _lstPending.end(); ++iPage)
+    {
+        if(iPage->_nLpn < _nNumsLpn && iPage->_nLpn / _nMapEntriesPerPage == nTvpn)
+        {
+            iPage->_bMapReady = true;
+            if(nInserted < _nMapCacheEntries && _mapMapCache.find(iPage->_nLpn) == _mapMapCache.end())
+            {
+                mapInsert(iPage->_nLpn);
+                nInserted++;
+            }
+        }
+    }
+}
+
+// a transaction in flight reads, programs or moves the physical page.
+bool NandFtl::inFlight( UINT32 nPpn )
+{
+    std::vector<FtlPageOp> &vctInFlight = _vctInFlight[dieOf(nPpn)];
+    for(UINT32 nIdx = 0; nIdx < vctInFlight.size(); nIdx++)
+    {
+        if(vctInFlight[nIdx]._nPpn == nPpn || vctInFlight[nIdx]._nSrcPpn == nPpn)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The FTL issues transactions only to the dies which are free (see dispatch), so that the flash 
+// memory system takes every transaction. Otherwise the mapping would point to a page which is 
+// never programmed, and the page would stay in flight forever.
+void NandFtl::addTransaction( Transaction &stTrans )
+{
+    NV_RET nRet = _flash.AddTransaction(stTrans);
+    if(nRet != NAND_SUCCESS)
+    {
+        NV_ERROR("FTL transaction (op " << stTrans._nTransOp << ") to " << std::hex << stTrans._nAddr << " is refused : " << nRet << std::dec);
+    }
+    assert(nRet == NAND_SUCCESS);
+}
+
+UINT32 NandFtl::physicalAddr( UINT32 nPpn )
+{
+    UINT32 nPbn = groupOf(nPpn) % _stDevConfig._nNumsBlk;
+
+    return (dieOf(nPpn) << (_stDevConfig._bits._blk + _stDevConfig._bits._plane + _stDevConfig._bits._page)) |
+           (nPbn << (_stDevConfig._bits._plane + _stDevConfig._bits._page)) |
+           (planeOf(nPpn) << _stDevConfig._bits._page) | pageOf(nPpn);
+}
+
+UINT32 NandFtl::GetPhysicalAddr( UINT32 nLpn )
+{
+    if(nLpn >= _nNumsLpn || _vctL2P[nLpn] == NULL_SIG(UINT32))
+    {
+        return NULL_SIG(UINT32);
+    }
+
+    return physicalAddr(_vctL2P[nLpn]);
+}
+
+// host pages written to the streams hotter than the coldest one.
+UINT64 NandFtl::GetHotStreamPages( void )
+{
+    UINT64 nPgs = 0;
+    for(UINT32 nStream = 1; nStream < _nWriteStreams; nStream++)
+    {
+        nPgs += _vctStatStreamHostPgs[nStream];
+    }
+
+    return nPgs;
+}
+
+void NandFtl::ReportConfiguration( void )
+{
+    using namespace std;
+
+    _flash.ReportConfiguration();
+    cout   << "FTL configurations ************************************"<< endl;
+    cout   << "Logical pages        : " << dec << _nNumsLpn << endl; 
+    cout   << "Over-provisioning (%): " << dec << NFS_GET_PARAM(IFV_OVERPROVISION) << endl; 
+    cout   << "Pages per blk group  : " << dec << _nPgsPerGroup << endl; 
+    cout   << "GC policy            : " << ((_eGcPolicy == FTL_GC_COST_BENEFIT) ? "cost-benefit" : "greedy") << endl; 
+    cout   << "GC watermarks (L/H)  : " << dec << _nGcLowWatermark << " / " << _nGcHighWatermark << endl; 
+    cout   << "WL threshold (EC)    : " << dec << _nWlThreshold << endl; 
+    if(_nMapCacheEntries != 0)
+    {
+        cout   << "Map cache entries    : " << dec << _nMapCacheEntries << " (" << _nNumsTvpn << " translation pages)" << endl; 
+    }
+    else
+    {
+        cout   << "Map cache entries    : whole page map" << endl; 
+    }
+    if(_nBufferPages != 0)
+    {
+        cout   << "Write buffer pages   : " << dec << _nBufferPages << " (watermarks " << _nBufferLowWatermark << " / " << _nBufferHighWatermark << ", idle " << _nBufferIdleTime << " ns, DRAM " << _nDramBandwidth << " MB/s)" << endl; 
+    }
+    if(_bSuperblock)
+    {
+        cout   << "Superblock stripe    : " << dec << _stDevConfig._nNumsDie << " dies x " << _stDevConfig._nNumsPlane << " planes" << endl; 
+    }
+    if(_nWriteStreams > 1)
+    {
+        cout   << "Write streams        : " << dec << _nWriteStreams << endl; 
+    }
+    if(_bTrimStale)
+    {
+        cout   << "Trim                 : marks stale pages" << endl; 
+    }
+    if(_nPreEraseTarget != 0)
+    {
+        cout   << "Pre-erase target     : " << dec << _nPreEraseTarget << " free groups (idle " << _nPreEraseIdleTime << " ns)" << endl; 
+    }
+    if(_nPrefetchPages != 0)
+    {
+        cout   << "Read-ahead pages     : " << dec << _nPrefetchPages << " (" << _vctStreams.size() << " streams, trigger " << _nPrefetchTrigger << " pages)" << endl; 
+    }
+    cout   << endl;
+}
+
+void NandFtl::ReportStatistics( void )
+{
+    using namespace std;
+
+    cout << "FTL *****************************************************************"<<endl;
+    cout << "Host read pages                              :" << dec << _nStatHostReadPgs << endl;
+    cout << "Host unmapped page reads                     :" << dec << _nStatUnmappedReadPgs << endl;
+    cout << "Host written pages                           :" << dec << _nStatHostWritePgs << endl;
+    cout << "Host trimmed pages                           :" << dec << _nStatTrimPgs << endl;
+    cout << "Flash pages invalidated by trim              :" << dec << _nStatTrimInvalidPgs << endl;
+    cout << "Flash pages marked stale by trim             :" << dec << _nStatTrimStalePgs << endl;
+    cout << "Host pages failed for no free block          :" << dec << _nStatFailedPgs << endl;
+    cout << "Flash read pages                             :" << dec << _nStatFlashReadPgs << endl;
+    cout << "Flash multi-plane reads                      :" << dec << _nStatNxRead << endl;
+    cout << "Flash written pages                          :" << dec << _nStatFlashWritePgs << endl;
+    cout << "Flash multi-plane programs                   :" << dec << _nStatNxWrite << endl;
+    cout << "Flash block group erases                     :" << dec << _nStatErase << endl;
+    cout << "Block group erases in idle windows           :" << dec << _nStatIdleErase << endl;
+    cout << "Pre-erase pool erases on demand              :" << dec << _nStatDemandErase << endl;
+    cout << "GC victims                                   :" << dec << _nStatGcVictims << endl;
+    cout << "GC copyback pages                            :" << dec << _nStatGcCopyback << endl;
+    cout << "GC multi-plane copybacks                     :" << dec << _nStatGcNxCopyback << endl;
+    cout << "GC read and program pages                    :" << dec << _nStatGcReadProg << endl;
+    cout << "WL migrations                                :" << dec << _nStatWlMigrations << endl;
+    cout << "WL moved pages                               :" << dec << _nStatWlPages << endl;
+    cout << "Write amplification by WL                    :" << ((_nStatHostWritePgs != 0) ? (float)_nStatWlPages / (float)_nStatHostWritePgs : 0) << endl;
+    cout << "Map cache hits                               :" << dec << _nStatMapHits << endl;
+    cout << "Map cache misses                             :" << dec << _nStatMapMisses << endl;
+    cout << "Translation page reads                       :" << dec << _nStatMapReads << endl;
+    cout << "Translation page writes                      :" << dec << _nStatMapWrites << endl;
+    cout << "Buffered write pages                         :" << dec << _nStatBufferWritePgs << endl;
+    cout << "Buffer overwritten pages                     :" << dec << _nStatBufferOverwritePgs << endl;
+    cout << "Buffer read hits                             :" << dec << _nStatBufferReadHits << endl;
+    cout << "Host pages stalled by a full buffer          :" << dec << _nStatBufferStalls << endl;
+    cout << "Buffer flushes                               :" << dec << _nStatBufferFlushes << endl;
+    cout << "Buffer flushed pages                         :" << dec << _nStatBufferFlushPgs << endl;
+    cout << "FUA written pages                            :" << dec << _nStatFuaPgs << endl;
+    cout << "Prefetched pages                             :" << dec << _nStatPrefetchPgs << endl;
+    cout << "Prefetches continuing a cache read           :" << dec << _nStatPrefetchCacheReads << endl;
+    cout << "Prefetch hits                                :" << dec << _nStatPrefetchHits << endl;
+    cout << "Prefetch misses                              :" << dec << _nStatPrefetchMisses << endl;
+    cout << "Wasted prefetches                            :" << dec << _nStatPrefetchWasted << endl;
+    cout << "Superblocks opened                           :" << dec << _nStatSbOpened << endl;
+    cout << "Write amplification                          :" << ((_nStatHostWritePgs != 0) ? (float)_nStatFlashWritePgs / (float)_nStatHostWritePgs : 0) << endl;
+    cout << "Read requests                                :" << dec << _vctStatReqs[NAND_FTL_READ] << endl;
+    cout << "Read average latency                         :" << dec << ((_vctStatReqs[NAND_FTL_READ] != 0) ? _vctStatLatency[NAND_FTL_READ] / _vctStatReqs[NAND_FTL_READ] : 0) << endl;
+    cout << "Read maximum latency                         :" << dec << _vctStatMaxLatency[NAND_FTL_READ] << endl;
+    cout << "Write requests                               :" << dec << _vctStatReqs[NAND_FTL_WRITE] << endl;
+    cout << "Write average latency                        :" << dec << ((_vctStatReqs[NAND_FTL_WRITE] != 0) ? _vctStatLatency[NAND_FTL_WRITE] / _vctStatReqs[NAND_FTL_WRITE] : 0) << endl;
+    cout << "Write maximum latency                        :" << dec << _vctStatMaxLatency[NAND_FTL_WRITE] << endl;
+    cout << "Host requests delayed by GC                  :" << dec << _nStatGcDelayedReqs << endl;
+    cout << "Host requests delayed by WL                  :" << dec << _nStatWlDelayedReqs << endl;
+    cout << "Host requests delayed by erases              :" << dec << _nStatEraseDelayedReqs << endl;
+    cout << "Host writes delayed by erases                :" << dec << _nStatEraseDelayedWrites << endl;
+    cout << "Host requests delayed by map misses          :" << dec << _nStatMapDelayedReqs << endl;
+    cout << "Map miss request average latency             :" << dec << ((_nStatMapDelayedReqs != 0) ? _nStatMapDelayedLatency / _nStatMapDelayedReqs : 0) << endl;
+    for(UINT32 nStream = 0; _nWriteStreams > 1 && nStream < _nWriteStreams; nStream++)
+    {
+        cout << "Host written pages of stream " << dec << nStream << "               :" << _vctStatStreamHostPgs[nStream] << endl;
+        cout << "Write amplification of stream " << dec << nStream << "              :" << ((_vctStatStreamHostPgs[nStream] != 0) ? (float)_vctStatStreamFlashPgs[nStream] / (float)_vctStatStreamHostPgs[nStream] : 0) << endl;
+    }
+    for(UINT32 nDie = 0; nDie < _stDevConfig._nNumsDie; nDie++)
+    {
+        cout << "GC busy time of die " << dec << nDie << "                        :" << _vctStatGcTime[nDie] << endl;
+        cout << "WL busy time of die " << dec << nDie << "                        :" << _vctStatWlTime[nDie] << endl;
+    }
+    cout << endl;
+
+    _flash.ReportStatistics();
+}
+
+}
@@ -0,0 +1,513 @@
+/****************************************************************************
+*	 NANDFlashSim: A Cycle Accurate NAND Flash Memory Simulator 
+*	 
+*	 Copyright (C) 2011   	Myoungsoo Jung (MJ)
+*
+*                           Pennsylvania State University
+*                           Microsystems Design Laboratory
+*                           I/O Group
+*
+*	 This program is free software: you can redistribute it and/or modify
+*	 it under the terms of the GNU Lesser General Public License as published by
+*	 the Free Software Foundation.
+*
+*	 This program is distributed in the hope that it will be useful,
+*	 but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	 MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	 GNU Lesser General Public License for more details.
+*
+*	 You should have received a copy of the GNU Lesser General Public License
+*	 along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*****************************************************************************/
+
+
+/********************************************************************
+	created:	2026/10/19
+	created:	19:10:2026   14:05
+	file base:	NandFtl
+	file ext:	h
+	
+	purpose:	NandFtl is an optional page-mapped flash translation layer
+    which exposes NandFlashSystem as a logical block device. A logical page
+    (LPN) is the data area of a NAND page, and it is mapped to a physical
+    page through a page-level table.
+
+    Blocks with the same block number over the planes of a die form a block
+    group, and pages of a group are written in (page, plane) order. Thus,
+    the pages written to a die back-to-back land on the same page offset of 
+    different planes and are programmed by NAND_OP_PROG_MULTIPLANE, while
+    the writes are spread over dies in a round-robin fashion so that the 
+    controller interleaves them. Reads of the pages on the same page offset 
+    of all planes are merged into NAND_OP_READ_MULTIPLANE.
+
+    Host requests are queued and dispatched whenever their dies are free. 
+    A request never bypasses a former request on the same logical page.
+    A trim unmaps its logical pages and drops the valid counts of their
+    block groups, so that GC neither moves nor counts the trimmed data. 
+    With FTL.TRIM_STALE, the physical pages are also marked stale in the
+    plane metadata (NandFlashSystem::Deallocate).
+
+    Garbage collection works on each die. If the free block groups of a die
+    fall below FTL.GC_HIGH_WATERMARK, a victim group is chosen by the greedy
+    or the cost-benefit policy (FTL.GC_POLICY), and its valid pages are moved
+    to a GC block group while the die has no host page to serve. A page is
+    moved by copyback (NAND_OP_INTERNAL_DATAMOVEMENT, or its multi-plane
+    variant for a page of each plane) into the same plane of the GC group,
+    and by read and program through the controller if the block of the plane
+    is full. Below FTL.GC_LOW_WATERMARK, GC goes before host pages.
+
+    Wear leveling reads the erase counts of blocks from the planes
+    (NandFlashSystem::GetEraseCount). The planes keep no erase counts 
+    without their statistics (WITHOUT_PLANE_STATS, which build.sh defines),
+    so that the FTL counts the erases of each block group itself then. Dynamic wear leveling opens the least
+    worn free group for host writes and the most worn one for the pages 
+    which GC moves. Static wear leveling starts when the erase counts of 
+    a die spread over FTL.WL_THRESHOLD; once the die is idle, the valid pages
+    of the least worn full group, which hold cold data, are moved by the
+    GC machinery (copyback), so that the group takes hot data after its erase.
+
+    With FTL.PRE_ERASE_TARGET, GC does not erase a victim once its valid 
+    pages are moved, but leaves it in a pre-erase pool of the die. The pool 
+    is erased (NAND_OP_BLOCK_ERASE_MULTIPLANE) while the die has been idle 
+    for FTL.PRE_ERASE_IDLE_TIME by the host clock idle time of the controller,
+    until the die has that many free block groups. Below the low watermark,
+    the pool is erased on demand ahead of host pages.
+
+    With FTL.MAP_CACHE_ENTRIES, the page map lives in translation pages on 
+    the flash (as DFTL does), and only that many mapping entries are cached
+    in an LRU table. A host page whose entry is not cached waits for the read 
+    of its translation page. Evicting a dirty entry writes its translation 
+    page back with all other dirty entries of the page. Translation pages 
+    are written, mapped and collected as the logical pages after the host ones.
+
+    With FTL.WRITE_BUFFER_PAGES, host writes complete once they are copied
+    into a DRAM write buffer (FTL.DRAM_BANDWIDTH), and reads of the buffered 
+    pages are served from it. The buffer is flushed from its oldest page 
+    in rows of a page per plane, and the rows to a die go out as a single 
+    NAND_OP_PROG_MULTIPLANE_CACHE sequence. Flushing starts above the high
+    watermark and stops below the low one, and the whole buffer is flushed
+    once the host has been idle for FTL.BUFFER_IDLE_TIME. FUA writes go 
+    through the buffer to the flash.
+
+    With FTL.PREFETCH_PAGES, host reads are followed by up to 
+    FTL.PREFETCH_STREAMS sequential streams. Once a stream has read
+    FTL.PREFETCH_TRIGGER pages in a row, the logical pages ahead of it are 
+    read into a prefetch buffer of that many pages while their dies have
+    nothing else to do. Prefetches go out as NAND_OP_READ_CACHE in the 
+    ascending address order of each plane, so that the controller keeps 
+    the cache read open and the next page is sensed during the data out.
+    A host read of a prefetched page is served from the buffer, and a write 
+    or a trim drops the prefetched page.
+
+    With FTL.SUPERBLOCK, host writes go to superblocks rather than to the
+    block groups of each die. A superblock takes a free block group of every
+    die, and its pages are handed out in stripe order, a page of each plane 
+    of a die and then the next die, so that back-to-back writes become 
+    multi-plane programs on different dies. A die without a spare free group
+    sits out a superblock. The valid pages are counted for each superblock, 
+    and GC scores the groups of a superblock by them.
+
+    With FTL.WRITE_STREAMS, each write stream has its own open block group
+    of each die (or its own open superblock), so that hot and cold data do 
+    not share blocks. A write goes to the stream which the host gives, or 
+    the FTL classifies it by the update count of the logical page, which is
+    halved every time the host has written as many pages as the logical 
+    space. GC has a destination of each stream of each die as well, and 
+    moves a page to the one of the stream of its logical page; only a die 
+    without a free group for it lets the page into another destination.
+    The pages which a stream writes to the flash, including the ones
+    GC moves, are counted for the write amplification of each stream.
+    The logical space leaves at least a spare block group of each die for 
+    the open group and for the destination of GC of each stream.
+*********************************************************************/
+
+#ifndef _NandFtl_h__
+#define _NandFtl_h__
+
+namespace NANDFlashSim {
+
+typedef enum {
+    NAND_FTL_READ,
+    NAND_FTL_WRITE,
+    NAND_FTL_TRIM,
+    NAND_FTL_OP_MAX
+} NAND_FTL_OP;
+
+class NandFtl {
+    typedef enum {
+        FTL_GROUP_FREE,
+        FTL_GROUP_OPEN,
+        FTL_GROUP_FULL,
+        FTL_GROUP_ERASING,
+        FTL_GROUP_DIRTY                             // GC has moved all valid pages, and the group waits for its erase
+    } FTL_GROUP_STATE;
+
+    // a host request; it completes when all of its logical pages complete.
+    struct FtlRequest {
+        UINT32          _nHostReqId;
+        NAND_FTL_OP     _nOp;
+        UINT32          _nNumsPending;
+        UINT64          _nArrivalTime;
+        bool            _bGcDelayed;
+        bool            _bWlDelayed;
+        bool            _bMapDelayed;
+        bool            _bEraseDelayed;
+    };
+
+    typedef enum {
+        FTL_GC_GREEDY,                              // the fewest valid pages
+        FTL_GC_COST_BENEFIT,                        // the largest (1 - u) * age / 2u
+        FTL_GC_POLICY_MAX
+    } FTL_GC_POLICY;
+
+    // a logical page of a host request, or a page which GC moves or a translation page (_nReqKey is NULL_SIG).
+    struct FtlPageOp {
+        UINT32          _nReqKey;
+        NAND_FTL_OP     _nOp;
+        UINT32          _nLpn;
+        UINT32          _nPpn;
+        UINT32          _nSrcPpn;                   // the page which GC moves
+        UINT8           *_pData;                    // the data area of the page in the host buffer (can be NULL)
+        bool            _bGcDelayed;                // the page waited for a die busy with GC
+        bool            _bWlDelayed;                // the page waited for a die busy with wear leveling
+        bool            _bMapDelayed;               // the page waited for the read of its translation page
+        bool            _bEraseDelayed;             // the page waited for a die busy with an erase
+        bool            _bMapLooked;                // the mapping cache has been looked up for the page
+        bool            _bMapReady;                 // the mapping entry of the page is known to the controller
+        bool            _bFua;                      // the write goes to the flash before its completion
+        UINT32          _nSlot;                     // the write buffer slot which holds the data, NULL_SIG if none
+        bool            _bBufferStalled;            // the write waited for a free slot of the write buffer
+        bool            _bPrefetch;                 // the page is read ahead into the slot of the prefetch buffer
+        UINT32          _nStream;                   // the write stream of the page
+
+        FtlPageOp() {
+            _nReqKey        = NULL_SIG(UINT32);
+            _nOp            = NAND_FTL_READ;
+            _nLpn           = NULL_SIG(UINT32);
+            _nPpn           = NULL_SIG(UINT32);
+            _nSrcPpn        = NULL_SIG(UINT32);
+            _pData          = NULL;
+            _bGcDelayed     = false;
+            _bWlDelayed     = false;
+            _bMapDelayed    = false;
+            _bEraseDelayed  = false;
+            _bMapLooked     = false;
+            _bMapReady      = false;
+            _bFua           = false;
+            _nSlot          = NULL_SIG(UINT32);
+            _bBufferStalled = false;
+            _bPrefetch      = false;
+            _nStream        = 0;
+        }
+    };
+
+    // a sequential read stream of the host
+    struct FtlReadStream {
+        UINT32          _nNextLpn;                  // the logical page which continues the stream
+        UINT32          _nRunPgs;                   // pages read in a row, 0 if the stream is not used
+        UINT32          _nAheadLpn;                 // the next logical page to prefetch
+        UINT64          _nLastTime;
+    };
+
+    // a logical page queued for a prefetch, under reading, or in the prefetch buffer
+    struct FtlPrefetch {
+        UINT32          _nSlot;                     // NULL_SIG until the read is issued
+        UINT32          _nStream;
+        bool            _bReady;
+    };
+
+    // a cached mapping entry
+    struct FtlMapEntry {
+        std::list<UINT32>::iterator _iLru;
+        bool            _bDirty;
+    };
+
+    /************************************************************************/
+    /* flash memory system                                                  */
+    /************************************************************************/
+    NandDeviceConfig                _stDevConfig;
+    NandIoCompletion                *_pHostCallback;
+    CallbackRepository<NandFtl, void, UINT32, UINT64, UINT64> _flashCallback;
+    NandFlashSystem                 _flash;
+
+    /************************************************************************/
+    /* mapping information                                                  */
+    /************************************************************************/
+    UINT32                          _nNumsLpn;
+    UINT32                          _nPgsPerGroup;
+    std::vector<UINT32>             _vctL2P;            // physical page of each logical page, NULL_SIG if unmapped
+    std::vector<UINT32>             _vctP2L;            // logical page of each physical page, NULL_SIG if invalid or free
+    std::vector<UINT32>             _vctValidCnt;       // valid pages of each block group
+    std::vector<FTL_GROUP_STATE>    _vctGroupState;
+    std::vector< std::list<UINT32> > _vctFreeGroups;    // free block groups of each die
+    std::vector<UINT32>             _vctOpenGroup;      // block group under writing of each write stream of each die (stream * dies + die), NULL_SIG if none
+    std::vector<UINT32>             _vctWritePtr;       // next page of the open group
+    std::vector<UINT64>             _vctGroupTime;      // the time when the block group became full (cost-benefit age)
+    std::vector<UINT32>             _vctGroupEc;        // erases of the block group by the FTL (wear without the plane statistics)
+
+    /************************************************************************/
+    /* superblocks                                                          */
+    /************************************************************************/
+    bool                            _bSuperblock;       // host writes go to superblocks
+    std::vector<UINT32>             _vctGroupSb;        // superblock of each block group, NULL_SIG if none
+    std::vector< std::vector<UINT32> > _vctSbGroups;    // block group of each die of each superblock
+    std::vector<UINT32>             _vctSbValidCnt;     // valid pages of each superblock
+    std::vector<UINT32>             _vctSbWidth;        // block groups of each superblock
+    std::vector<UINT32>             _vctSbLiveGroups;   // groups of each superblock which are not erased yet
+    std::list<UINT32>               _lstFreeSbs;        // unused superblock numbers
+    std::vector<UINT32>             _vctOpenSb;         // superblock under writing of each write stream, NULL_SIG if none
+    std::vector<bool>               _vctSbTaken;        // the die has opened its group of the open superblock (stream * dies + die)
+
+    /************************************************************************/
+    /* write streams                                                        */
+    /************************************************************************/
+    UINT32                          _nWriteStreams;     // 1 if hot and cold data are not separated
+    std::vector<UINT8>              _vctLpnStream;      // write stream of the last write of each logical page
+    std::vector<UINT8>              _vctLpnHeat;        // decayed update count of each logical page
+    UINT32                          _nHeatWrites;       // host pages written since the last decay
+
+    /************************************************************************/
+    /* trim                                                                 */
+    /************************************************************************/
+    bool                            _bTrimStale;        // trimmed physical pages are marked stale in the planes
+
+    /************************************************************************/
+    /* mapping cache                                                        */
+    /************************************************************************/
+    UINT32                          _nMapCacheEntries;  // 0 if the whole page map is in DRAM
+    UINT32                          _nMapEntriesPerPage;
+    UINT32                          _nNumsTvpn;         // translation pages; they are mapped by _vctL2P[_nNumsLpn + tvpn]
+    std::map<UINT32, FtlMapEntry>   _mapMapCache;
+    std::list<UINT32>               _lstMapLru;         // cached logical pages, the most recently used first
+    std::set<UINT32>                _setMapLoading;     // translation pages under reading
+    std::set<UINT32>                _setMapFlushing;    // translation pages queued for writing
+
+    /************************************************************************/
+    /* write buffer                                                         */
+    /************************************************************************/
+    UINT32                          _nBufferPages;      // 0 if there is no write buffer
+    UINT32                          _nBufferHighWatermark;
+    UINT32                          _nBufferLowWatermark;
+    UINT64                          _nBufferIdleTime;
+    UINT32                          _nDramBandwidth;    // MB/s
+    boost::shared_array<UINT8>      _pBufferData;       // full page slots
+    std::map<UINT32, UINT32>        _mapBuffer;         // slot of each buffered logical page
+    std::list<UINT32>               _lstBufferOrder;    // buffered logical pages, the oldest first
+    std::list<UINT32>               _lstBufferFree;     // free slots
+    bool                            _bBufferFlushing;   // above the high watermark, and not yet below the low one
+    UINT64                          _nDramBusyUntil;
+    UINT64                          _nLastHostTime;
+
+    /************************************************************************/
+    /* read-ahead                                                           */
+    /************************************************************************/
+    UINT32                          _nPrefetchPages;    // 0 if there is no read-ahead
+    UINT32                          _nPrefetchTrigger;
+    std::vector<FtlReadStream>      _vctStreams;
+    boost::shared_array<UINT8>      _pPrefetchData;     // full page slots
+    std::map<UINT32, FtlPrefetch>   _mapPrefetch;
+    std::list<UINT32>               _lstPrefetchQueue;  // logical pages to prefetch, in stream order
+    std::list<UINT32>               _lstPrefetchFree;   // free slots
+    std::vector<UINT32>             _vctCacheReadNext;  // the address which continues the cache read of each die
+
+    /************************************************************************/
+    /* request scheduling                                                   */
+    /************************************************************************/
+    std::map<UINT32, FtlRequest>    _mapRequests;
+    UINT32                          _nNextReqKey;
+    std::list<FtlPageOp>            _lstPending;
+    std::vector< std::vector<FtlPageOp> > _vctInFlight;
+    std::vector<UINT32>             _vctErasingGroup;   // block group under erasing of each die, NULL_SIG if none
+    std::vector<bool>               _vctCompleted;      // the flash transaction of the die is completed, but not retired
+    std::vector<UINT64>             _vctCompletionTime;
+    std::vector< boost::shared_array<UINT8> > _vctpStaging;   // full page buffers of each plane of each die
+    std::vector<UINT32>             _vctNextWriteDie;   // the die which takes the next write of each write stream
+
+    /************************************************************************/
+    /* garbage collection                                                   */
+    /************************************************************************/
+    FTL_GC_POLICY                   _eGcPolicy;
+    UINT32                          _nGcHighWatermark;
+    UINT32                          _nGcLowWatermark;
+    std::vector<UINT32>             _vctGcVictim;       // block group under collection of each die, NULL_SIG if none
+    std::vector<UINT32>             _vctGcScan;         // first page of the victim which may be valid
+    std::vector<UINT32>             _vctGcOpenGroup;    // destination block group of each stream and die (stream * dies + die), NULL_SIG if none
+    std::vector<UINT32>             _vctGcPlanePtr;     // next page of each plane of the destinations (destination * planes + plane)
+    std::vector<bool>               _vctGcExhausted;    // no victim is found since the last invalidation of the die
+    std::vector<bool>               _vctGcInFlight;     // the transaction of the die is issued by GC
+    std::vector<bool>               _vctGcHeld;         // a page read by GC waits for its program
+    std::vector<FtlPageOp>          _vctGcHeldPage;
+    std::vector< boost::shared_array<UINT8> > _vctpGcBuffer;  // data of the held page of each die
+    std::vector<UINT64>             _vctGcIssueTime;
+
+    /************************************************************************/
+    /* wear leveling                                                        */
+    /************************************************************************/
+    UINT32                          _nWlThreshold;      // erase count spread which triggers static wear leveling, 0 disables it
+    std::vector<bool>               _vctWlPending;      // the erase counts of the die spread over the threshold
+    std::vector<bool>               _vctWlMove;         // the victim of the die is chosen by wear leveling
+    std::vector<bool>               _vctWlInFlight;     // the GC transaction of the die moves pages for wear leveling
+
+    /************************************************************************/
+    /* pre-erase                                                            */
+    /************************************************************************/
+    UINT32                          _nPreEraseTarget;   // free block groups of a die which idle windows erase up to, 0 erases victims at once
+    UINT64                          _nPreEraseIdleTime;
+    std::vector< std::list<UINT32> > _vctEraseGroups;   // block groups of each die which wait for their erase
+    std::vector<UINT64>             _vctIdleMark;       // host clock idle time of each die when its last transaction retired
+
+    /************************************************************************/
+    /* statistics                                                           */
+    /************************************************************************/
+    UINT64                          _nStatHostReadPgs;
+    UINT64                          _nStatHostWritePgs;
+    UINT64                          _nStatTrimPgs;
+    UINT64                          _nStatTrimInvalidPgs;
+    UINT64                          _nStatTrimStalePgs;
+    UINT64                          _nStatUnmappedReadPgs;
+    UINT64                          _nStatFailedPgs;
+    UINT64                          _nStatFlashReadPgs;
+    UINT64                          _nStatFlashWritePgs;
+    UINT64                          _nStatNxRead;
+    UINT64                          _nStatNxWrite;
+    UINT64                          _nStatErase;
+    UINT64                          _nStatGcVictims;
+    UINT64                          _nStatGcCopyback;
+    UINT64                          _nStatGcNxCopyback;
+    UINT64                          _nStatGcReadProg;
+    UINT64                          _nStatGcDelayedReqs;
+    std::vector<UINT64>             _vctStatGcTime;
+    UINT64                          _nStatWlMigrations;
+    UINT64                          _nStatWlPages;
+    UINT64                          _nStatWlDelayedReqs;
+    std::vector<UINT64>             _vctStatWlTime;
+    UINT64                          _nStatMapHits;
+    UINT64                          _nStatMapMisses;
+    UINT64                          _nStatMapReads;
+    UINT64                          _nStatMapWrites;
+    UINT64                          _nStatMapDelayedReqs;
+    UINT64                          _nStatMapDelayedLatency;
+    UINT64                          _nStatBufferWritePgs;
+    UINT64                          _nStatBufferOverwritePgs;
+    UINT64                          _nStatBufferReadHits;
+    UINT64                          _nStatBufferStalls;
+    UINT64                          _nStatBufferFlushes;
+    UINT64                          _nStatBufferFlushPgs;
+    UINT64                          _nStatFuaPgs;
+    UINT64                          _nStatPrefetchPgs;
+    UINT64                          _nStatPrefetchCacheReads;
+    UINT64                          _nStatPrefetchHits;
+    UINT64                          _nStatPrefetchMisses;
+    UINT64                          _nStatPrefetchWasted;
+    UINT64                          _nStatSbOpened;
+    UINT64                          _nStatIdleErase;
+    UINT64                          _nStatDemandErase;
+    UINT64                          _nStatEraseDelayedReqs;
+    UINT64                          _nStatEraseDelayedWrites;
+    std::vector<UINT64>             _vctStatStreamHostPgs;
+    std::vector<UINT64>             _vctStatStreamFlashPgs;
+    UINT64                          _vctStatReqs[NAND_FTL_OP_MAX];
+    UINT64                          _vctStatLatency[NAND_FTL_OP_MAX];
+    UINT64                          _vctStatMaxLatency[NAND_FTL_OP_MAX];
+
+public :
+    NandFtl( UINT64 nSystemClock, NandDeviceConfig &stConfig, NandIoCompletion *pCallback = NULL );
+    ~NandFtl();
+
+    //////////////////////////////////////////////////////////////////////////
+    // logical block interfaces (in logical pages). 
+    // pCallback is invoked with (host request id, arrival time, completion time).
+    //////////////////////////////////////////////////////////////////////////
+    NV_RET          Read( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData );
+    NV_RET          Write( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData, bool bFua = false, UINT32 nStream = NULL_SIG(UINT32) );
+    NV_RET          Trim( UINT32 nHostReqId, UINT32 nLpn, UINT32 nNumsPage );
+
+    //////////////////////////////////////////////////////////////////////////
+    // cycle update interfaces.
+    //////////////////////////////////////////////////////////////////////////
+    UINT64          UpdateWithoutIdleCycles( void );
+    bool            IsActiveMode( void );
+
+    //////////////////////////////////////////////////////////////////////////
+    // attributes
+    //////////////////////////////////////////////////////////////////////////
+    UINT32          GetNumsLogicalPages( void )     { return _nNumsLpn; }
+    UINT32          GetPhysicalAddr( UINT32 nLpn );
+    UINT64          CurrentTime()                   { return _flash.CurrentTime(); }
+    NandFlashSystem &Flash( void )                  { return _flash; }
+
+    //////////////////////////////////////////////////////////////////////////
+    // statistics
+    //////////////////////////////////////////////////////////////////////////
+    void            ReportStatistics( void );
+    void            ReportConfiguration( void );
+    UINT64          GetFailedPages( void )          { return _nStatFailedPgs; }
+    UINT64          GetGcCopybackPages( void )      { return _nStatGcCopyback; }
+    UINT64          GetWlMigrations( void )         { return _nStatWlMigrations; }
+    UINT64          GetMapMisses( void )            { return _nStatMapMisses; }
+    UINT64          GetBufferReadHits( void )       { return _nStatBufferReadHits; }
+    UINT64          GetPrefetchHits( void )         { return _nStatPrefetchHits; }
+    UINT64          GetSuperblocksOpened( void )    { return _nStatSbOpened; }
+    UINT64          GetHotStreamPages( void );
+    UINT64          GetTrimStalePages( void )       { return _nStatTrimStalePgs; }
+    UINT64          GetIdleErases( void )           { return _nStatIdleErase; }
+    void            CompleteTransaction( UINT32 nHostTransId, UINT64 nDeviceId, UINT64 nCompletionTime );
+
+private :
+    NV_RET          addRequest( UINT32 nHostReqId, NAND_FTL_OP nOp, UINT32 nLpn, UINT32 nNumsPage, UINT8 *pData, bool bFua = false, UINT32 nStream = NULL_SIG(UINT32) );
+    UINT32          classify( UINT32 nLpn );
+    UINT32          gcStream( UINT32 nLpn );
+    void            dispatch( void );
+    bool            writable( UINT32 nDie, UINT32 nStream );
+    bool            gcWanted( UINT32 nDie );
+    bool            collect( UINT32 nDie );
+    bool            levelWear( UINT32 nDie );
+    void            checkWear( UINT32 nDie );
+    UINT32          groupEraseCount( UINT32 nGroup );
+    UINT32          takeGroup( UINT32 nDie, bool bHot );
+    UINT32          openGroup( UINT32 nDie, bool bHot, UINT32 nStream = 0 );
+    UINT32          openSuperblock( UINT32 nStream );
+    UINT32          stripeDie( UINT32 nStream );
+    double          groupUtil( UINT32 nGroup );
+    UINT32          selectVictim( UINT32 nDie );
+    UINT32          gcRoom( UINT32 nDie );
+    UINT32          gcDestination( UINT32 nDie, UINT32 nLpn );
+    UINT32          gcReserve( UINT32 nDie );
+    void            eraseGroup( UINT32 nDie, UINT32 nGroup );
+    bool            preEraseWanted( UINT32 nDie );
+    bool            preErase( UINT32 nDie, bool bIdle );
+    bool            moveHeldPage( UINT32 nDie );
+    void            remap( UINT32 nLpn, UINT32 nPpn );
+    bool            mapLookup( UINT32 nLpn );
+    void            mapInsert( UINT32 nLpn );
+    void            mapUpdate( UINT32 nLpn );
+    void            mapFlush( UINT32 nTvpn );
+    void            mapLoaded( UINT32 nTvpn );
+    bool            buffer( FtlPageOp &stPageOp, bool &bBlocked );
+    void            unbuffer( UINT32 nLpn );
+    bool            flushWanted( void );
+    bool            flush( UINT32 nDie );
+    UINT64          dramTime( UINT32 nNumsByte );
+    void            detectStream( UINT32 nLpn, UINT32 nNumsPage );
+    bool            followed( UINT32 nLpn );
+    void            unprefetch( UINT32 nLpn );
+    bool            prefetched( FtlPageOp &stPageOp, bool &bBlocked );
+    bool            prefetch( UINT32 nDie, std::set<UINT32> &setBlocked );
+    void            issueWrite( UINT32 nDie, std::vector< std::list<FtlPageOp>::iterator > &vctBatch );
+    void            issueRead( UINT32 nDie, std::vector< std::list<FtlPageOp>::iterator > &vctBatch );
+    void            retire( UINT32 nDie );
+    void            completePage( FtlPageOp &stPageOp, UINT64 nTime, bool bFailed = false );
+    void            invalidate( UINT32 nPpn );
+    bool            inFlight( UINT32 nPpn );
+    void            addTransaction( Transaction &stTrans );
+    UINT32          physicalAddr( UINT32 nPpn );
+    inline UINT32   groupOf( UINT32 nPpn )      { return nPpn / _nPgsPerGroup; }
+    inline UINT32   dieOf( UINT32 nPpn )        { return groupOf(nPpn) / _stDevConfig._nNumsBlk; }
+    inline UINT32   planeOf( UINT32 nPpn )      { return (nPpn % _nPgsPerGroup) % _stDevConfig._nNumsPlane; }
+    inline UINT32   pageOf( UINT32 nPpn )       { return (nPpn % _nPgsPerGroup) / _stDevConfig._nNumsPlane; }
+};
+
+}
+
+#endif // _NandFtl_h__
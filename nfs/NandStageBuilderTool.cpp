@@ -110,7 +110,7 @@ NV_RET NandStageBuilderTool::ReadPageCacheAddAddr(NandStagePacket &stDataPacket,
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
 
     stDataPacket._nCommand          = NAND_CMD_READ_CACHE_ADDR_INIT;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie,  nPlane, nPbn, nPpo);
     stDataPacket._bLastCmdForFgTrans  = false;
 
@@ -129,7 +129,7 @@ NV_RET NandStageBuilderTool::ReadPageCache( NandStagePacket &stDataPacket, UINT3
 
     // initialize data packet
     stDataPacket._nCommand          = NAND_CMD_READ_CACHE;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._pData             = pData;
     stDataPacket._bLastCmdForFgTrans  = true;
     stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, nPlane, nPbn, nPpo);    
@@ -154,7 +154,7 @@ NV_RET NandStageBuilderTool::WritePageCache(NandStagePacket &stDataPacket, UINT3
 
     stDataPacket._nCommand          = NAND_CMD_PROG_CACHE;
     stDataPacket._nCol              = nCol;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize - nCol;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     stDataPacket._pData             = pData;
     stDataPacket._pStatusData       = pStatusData;
     stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, nPlane, nPbn, nPpo);    
@@ -174,11 +174,11 @@ NV_RET NandStageBuilderTool::ReadNxPlaneAddAddr(NandStagePacket &stDataPacket, U
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
     NV_RET      nRet = NAND_SUCCESS;
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
 
     stDataPacket._nCommand          = (bLast) ? NAND_CMD_READ_MULTIPLANE_INIT_FIN :NAND_CMD_READ_MULTIPLANE_INIT;
     stDataPacket._nCol              = nCol;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize - nCol;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     stDataPacket._bLastCmdForFgTrans  = false;
     stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, nPlane, nPbn, nPpo);
 
@@ -194,13 +194,13 @@ NV_RET NandStageBuilderTool::ReadNxPlaneSelection(NandStagePacket &stDataPacket,
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
     NV_RET      nRet = NAND_SUCCESS;
 
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        |= NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
 
     stDataPacket._nCommand          = NAND_CMD_READ_MULTIPLANE;
     stDataPacket._nCol              = nCol;
@@ -213,6 +213,49 @@ NV_RET NandStageBuilderTool::ReadNxPlaneSelection(NandStagePacket &stDataPacket,
 
 }
 
+NV_RET NandStageBuilderTool::ReadNxPlaneCache(NandStagePacket &stDataPacket, UINT32 nOpenRow )
+{
+    UINT8       nDie, nPlane, nPpo;
+    UINT16      nPbn;
+    breakdownSemiPhysicalAddr(nOpenRow, nDie, nPlane, nPbn, nPpo);
+    NV_RET      nRet = NAND_SUCCESS;
+
+    // sequential cache read command (31h) has no address cycle, and it is applied to all the addressed planes.
+    stDataPacket._nCommand          = NAND_CMD_READ_MULTIPLANE_CACHE;
+    stDataPacket._nCol              = 0;
+    stDataPacket._nRandomBytes      = NULL_SIG(UINT32);
+    stDataPacket._pData             = NULL;
+    stDataPacket._bLastCmdForFgTrans  = false;
+    stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, 0, nPbn, nPpo);
+
+    return nRet;
+}
+
+NV_RET NandStageBuilderTool::ReadNxPlaneCacheSelection(NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT8 *pData, UINT32 nNumsPulse, UINT16 nCol /*= 0*/ )
+{
+    UINT8       nDie, nPlane, nPpo;
+    UINT16      nPbn;
+    breakdownSemiPhysicalAddr(nOpenRow, nDie, nPlane, nPbn, nPpo);
+    NV_RET      nRet = NAND_SUCCESS;
+
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
+    {
+        nRet        |= NAND_CTRL_ERROR_IOLENGTH;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
+    }
+
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
+
+    stDataPacket._nCommand          = NAND_CMD_READ_MULTIPLANE_CACHE_DUMMY;
+    stDataPacket._nCol              = nCol;
+    stDataPacket._nRandomBytes      = nNumsPulse;
+    stDataPacket._pData             = pData;
+    stDataPacket._bLastCmdForFgTrans  = true;
+    stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, nPlane, nPbn, nPpo);
+
+    return nRet;
+}
+
 NV_RET NandStageBuilderTool::WriteNxPlane(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, bool bLastPlane )
 {
     
@@ -222,7 +265,7 @@ NV_RET NandStageBuilderTool::WriteNxPlane(NandStagePacket &stDataPacket, UINT32
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
 
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
 
     // initialize data packet
     if (pStatusData != NULL && bLastPlane)
@@ -231,7 +274,7 @@ NV_RET NandStageBuilderTool::WriteNxPlane(NandStagePacket &stDataPacket, UINT32
     }
     stDataPacket._nCommand          = (bLastPlane) ?  NAND_CMD_PROG_MULTIPLANE_FIN : NAND_CMD_PROG_MULTIPLANE;
     stDataPacket._nCol              = nCol;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize - nCol;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     stDataPacket._pData             = pData;
     stDataPacket._pStatusData       = (bLastPlane) ? pStatusData : NULL;
     stDataPacket._bLastCmdForFgTrans  = true;
@@ -242,7 +285,7 @@ NV_RET NandStageBuilderTool::WriteNxPlane(NandStagePacket &stDataPacket, UINT32
 }
 
 
-NV_RET NandStageBuilderTool::WriteNxPlaneForRandom(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse)
+NV_RET NandStageBuilderTool::WriteNxPlaneForRandom(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse, UINT32 *pStatusData /*= NULL*/, bool bLastRand /*= false*/, bool bLastStage /*= false*/)
 {
     
     NV_RET  nRet    = NAND_SUCCESS;
@@ -250,20 +293,32 @@ NV_RET NandStageBuilderTool::WriteNxPlaneForRandom(NandStagePacket &stDataPacket
     UINT16      nPbn;
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
 
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        |= NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
+    if (pStatusData != NULL && bLastStage)
+    {
+        (*pStatusData)              = 0;
+    }
 
-    stDataPacket._nCommand          = NAND_CMD_PROG_MULTIPLANE_RANDOM;
+    // the serial data input (80h) of a plane is confirmed at once (11h, or 10h for the last plane) if it is the only data input.
+    if (bLastStage)
+    {
+        stDataPacket._nCommand      = NAND_CMD_PROG_MULTIPLANE_FIN_RANDOM;
+    }
+    else
+    {
+        stDataPacket._nCommand      = (bLastRand) ?  NAND_CMD_PROG_MULTIPLANE_RANDOM_DUMMY : NAND_CMD_PROG_MULTIPLANE_RANDOM;
+    }
     stDataPacket._nCol              = nCol;
     stDataPacket._nRandomBytes      = nNumsPulse;
     stDataPacket._pData             = pData;
-    stDataPacket._pStatusData       = NULL;
-    stDataPacket._bLastCmdForFgTrans  = false;
+    stDataPacket._pStatusData       = (bLastStage) ? pStatusData : NULL;
+    stDataPacket._bLastCmdForFgTrans  = bLastStage;
     stDataPacket._nRow              = NAND_COMPOSE_ROW_RIGSTER(nDie, nPlane, nPbn, nPpo);
 
     return nRet;    
@@ -274,16 +329,16 @@ NV_RET NandStageBuilderTool::WriteNxPlaneRandomColSelection( NandStagePacket &st
 {
     NV_RET  nRet    = NAND_SUCCESS;
 
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        |= NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
     UINT8       nDie, nPlane, nPpo;
     UINT16      nPbn;
     breakdownSemiPhysicalAddr(nOpenRow, nDie, nPlane, nPbn, nPpo);
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
     // initialize data packet
     if (pStatusData != NULL && bLastStage)
     {
@@ -318,7 +373,7 @@ NV_RET NandStageBuilderTool::WriteNxPlaneCache( NandStagePacket &stDataPacket, U
     UINT16      nPbn;
     breakdownSemiPhysicalAddr(nSemiPhyRow, nDie, nPlane, nPbn, nPpo);
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
 
     // initialize data packet
     if (pStatusData != NULL && bLastPlane)
@@ -336,7 +391,7 @@ NV_RET NandStageBuilderTool::WriteNxPlaneCache( NandStagePacket &stDataPacket, U
     }
 
     stDataPacket._nCol              = nCol;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize - nCol;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     stDataPacket._pData             = pData;
     stDataPacket._pStatusData       = (bLastPlane) ? pStatusData : NULL;
     stDataPacket._bLastCmdForFgTrans  = bLastPlane;
@@ -353,7 +408,7 @@ NV_RET NandStageBuilderTool::ReadInternalPage(NandStagePacket &stDataPacket, UIN
     // initialize data packet
     stDataPacket._nCommand          = NAND_CMD_READ_INTERNAL;
     stDataPacket._nCol              = 0;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._pData             = NULL;
     stDataPacket._pStatusData       = NULL;
     stDataPacket._bLastCmdForFgTrans  = false;
@@ -381,7 +436,7 @@ NV_RET NandStageBuilderTool::WriteInternalPage(NandStagePacket &stDataPacket,  U
     // initialize data packet
     stDataPacket._nCommand          = NAND_CMD_PROG_INTERNAL;
     stDataPacket._nCol              = 0;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._pData             = NULL;
     stDataPacket._pStatusData       = pStatusData;
     stDataPacket._bLastCmdForFgTrans  = true;
@@ -410,7 +465,7 @@ NV_RET NandStageBuilderTool::ReadInternalPageNxPlane(NandStagePacket &stDataPack
     // initialize data packet
     stDataPacket._nCommand          = (bLast) ? NAND_CMD_READ_INTERNAL_MULTIPLANE_FIN : NAND_CMD_READ_INTERNAL_MULTIPLANE;
     stDataPacket._nCol              = 0;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._pData             = NULL;
     stDataPacket._pStatusData       = NULL;
     stDataPacket._bLastCmdForFgTrans  = false;
@@ -443,7 +498,7 @@ NV_RET NandStageBuilderTool::WriteInternalPageNxPlane(NandStagePacket &stDataPac
     // initialize data packet
     stDataPacket._nCommand          = (bLast) ? NAND_CMD_PROG_INTERNAL_MULTIPLANE_FIN : NAND_CMD_PROG_INTERNAL_MULTIPLANE;
     stDataPacket._nCol              = 0;
-    stDataPacket._nRandomBytes      = _stNandDevConfig._nPgSize;
+    stDataPacket._nRandomBytes      = NAND_FULL_PAGE_SIZE(_stNandDevConfig);
     stDataPacket._pData             = NULL;
     stDataPacket._pStatusData       = (bLast) ? pStatusData : NULL ;
     stDataPacket._bLastCmdForFgTrans  = bLast;
@@ -505,11 +560,11 @@ NV_RET NandStageBuilderTool::ReadPage(NandStagePacket &stDataPacket, UINT32 nSem
     
     NV_RET  nRet    = NAND_SUCCESS;
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        = NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
 
     stDataPacket._nCommand          = NAND_CMD_READ_PAGE;
@@ -526,21 +581,40 @@ NV_RET NandStageBuilderTool::ReadPage(NandStagePacket &stDataPacket, UINT32 nSem
     return nRet;
 }
 
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    ReadSpare
+// FullName:  NandStageBuilderTool::ReadSpare
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: NandStagePacket & stDataPacket
+// Parameter: UINT32 nSemiPhyRow
+// Parameter: UINT8 * pData
+//
+// Descriptions -
+// Page read whose column address points to the spare area, so that only the 
+// OOB bytes are carried out. As the other read stages, pData is indexed by 
+// column (spare bytes land at pData + page size).
+//////////////////////////////////////////////////////////////////////////////
+NV_RET NandStageBuilderTool::ReadSpare(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT8 *pData )
+{
+    return ReadPage(stDataPacket, nSemiPhyRow, _stNandDevConfig._nPgSize, pData, _stNandDevConfig._nSpareSize);
+}
 
 NV_RET NandStageBuilderTool::ReadRandomColSelection( NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse )
 {
     
     NV_RET  nRet    = NAND_SUCCESS;
-    assert(nCol <= _stNandDevConfig._nPgSize);
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
 
     UINT8       nDie, nPlane, nPpo;
     UINT16      nPbn;
     breakdownSemiPhysicalAddr(nOpenRow, nDie, nPlane, nPbn, nPpo);
 
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        |= NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
 
     stDataPacket._nCommand          = NAND_CMD_READ_RANDOM;
@@ -561,29 +635,31 @@ NV_RET NandStageBuilderTool::ReadNxPlaneRandomColSelection( NandStagePacket &stD
     return ReadRandomColSelection(stDataPacket, nOpenRow, nCol, pData, nNumsPulse);
 }
 
-NV_RET NandStageBuilderTool::WritePage(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bRandomIn /*= false*/ )
+NV_RET NandStageBuilderTool::WritePage(NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bRandomIn /*= false*/, bool bRandomLast /*= false*/ )
 {
     
     NV_RET  nRet    = NAND_SUCCESS;
+    // the serial data input (80h) of a random program is confirmed (10h) at once if it is the only data input.
+    bool    bConfirm = (!bRandomIn || bRandomLast);
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        = NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
 
     // initialize data packet
-    if (pStatusData != NULL && !bRandomIn)
+    if (pStatusData != NULL && bConfirm)
     {
         (*pStatusData)              = 0;
     }
-    stDataPacket._nCommand          = (bRandomIn) ? NAND_CMD_PROG_RANDOM : NAND_CMD_PROG_PAGE;
+    stDataPacket._nCommand          = (bRandomIn) ? ((bRandomLast) ? NAND_CMD_PROG_RANDOM_FIN : NAND_CMD_PROG_RANDOM) : NAND_CMD_PROG_PAGE;
     stDataPacket._nCol              = nCol;
     stDataPacket._nRandomBytes      = nNumsPulse;
     stDataPacket._pData             = pData;
-    stDataPacket._pStatusData       = (bRandomIn) ? NULL : pStatusData;
-    stDataPacket._bLastCmdForFgTrans  = (bRandomIn) ? false : true;
+    stDataPacket._pStatusData       = (bConfirm) ? pStatusData : NULL;
+    stDataPacket._bLastCmdForFgTrans  = bConfirm;
 
     UINT8       nDie, nPlane, nPpo;
     UINT16      nPbn;
@@ -600,11 +676,11 @@ NV_RET NandStageBuilderTool::WriteRandomColSelection( NandStagePacket &stDataPac
     
     NV_RET  nRet    = NAND_SUCCESS;
 
-    assert(nCol <= _stNandDevConfig._nPgSize);
-    if(nNumsPulse > _stNandDevConfig._nPgSize - nCol)
+    assert(nCol <= NAND_FULL_PAGE_SIZE(_stNandDevConfig));
+    if(nNumsPulse > NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol)
     {
         nRet        |= NAND_CTRL_ERROR_IOLENGTH;
-        nNumsPulse  = _stNandDevConfig._nPgSize - nCol;
+        nNumsPulse  = NAND_FULL_PAGE_SIZE(_stNandDevConfig) - nCol;
     }
     UINT8       nDie, nPlane, nPpo;
     UINT16      nPbn;
@@ -69,10 +69,14 @@ public :
     //////////////////////////////////////////////////////////////////////////
     // basic I/O        : ReadPage 
     // random I/O       : ReadPage -> ReadRandomColSelection -> ReadRandomColSelection
+    //                    WritePage(random) -> WriteRandomColSelection -> WriteRandomColSelection(with last flag)
+    //                    WritePage(random, with last flag) for a single data input
+    // spare only       : ReadSpare
     //////////////////////////////////////////////////////////////////////////
     NV_RET ReadPage                 (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse);
+    NV_RET ReadSpare                (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT8 *pData);
     NV_RET ReadRandomColSelection   (NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse);
-    NV_RET WritePage                (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bRandomIn = false);
+    NV_RET WritePage                (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bRandomIn = false, bool bRandomLast = false);
     NV_RET WriteRandomColSelection (NandStagePacket &stDataPacket, UINT32 nOpenAddr, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bRandomLast = false);
 
     //////////////////////////////////////////////////////////////////////////
@@ -90,6 +94,10 @@ public :
     // Nx Random READ   : ReadNxPlaneAddAddr -> ReadNxPlaneAddAddr(with last flag) -> 
     //                    ReadNxPlaneSelection -> ReadNxPlaneRandomColSelection -> ReadNxPlaneRandomColSelection ->
     //                    ReadNxPlaneSelection(with last flag) -> ReadNxPlaneRandomColSelection -> ReadNxPlaneRandomColSelection ->
+    // Nx READ(cache)   : ReadNxPlaneAddAddr -> ReadNxPlaneAddAddr(with last flag) -> 
+    //                    ReadNxPlaneCache -> ReadNxPlaneCacheSelection -> ReadNxPlaneCacheSelection ->
+    //                    ReadNxPlaneCache -> ReadNxPlaneCacheSelection -> ReadNxPlaneCacheSelection -> ...
+    //                    Each ReadNxPlaneCache moves the next pages of all planes to the cache registers.
     //
     // Nx WRITE         : WriteNxPlane -> WriteNxPlane -> WriteNxPlane(with last flag)
     // Nx WRITE(cache)  : WriteNxPlaneCache -> WriteNxPlaneCache (with last flag(plane)) -> 
@@ -97,13 +105,16 @@ public :
     //                    The order of plane addressing has high priority and the order of page addressing (cache) has low priority
     // Nx WRITE(RANDOM) : WriteNxPlaneForRandom -> WriteNxPlaneRandomColSelection -> WriteNxPlaneRandomColSelection (with last flag(plane)) ->
     //                    WriteNxPlaneForRandom -> WriteNxPlaneRandomColSelection -> WriteNxPlaneRandomColSelection (with last flag(trans))  ->
+    //                    WriteNxPlaneForRandom takes the last flags of a plane which has a single data input.
     //////////////////////////////////////////////////////////////////////////
     NV_RET ReadNxPlaneAddAddr       (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT16 nCol = 0, bool bLast = false); // no callback
     NV_RET ReadNxPlaneSelection     (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT8 *pData, UINT32 nNumsPulse, UINT16 nCol = 0, bool bLast = false);
     NV_RET ReadNxPlaneRandomColSelection(NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse);
+    NV_RET ReadNxPlaneCache         (NandStagePacket &stDataPacket, UINT32 nOpenRow);
+    NV_RET ReadNxPlaneCacheSelection(NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT8 *pData, UINT32 nNumsPulse, UINT16 nCol = 0);
     NV_RET WriteNxPlane             (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, bool bLastPlane);
     NV_RET WriteNxPlaneCache        (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, bool bLastPlane = false, bool bLastStage= false);
-    NV_RET WriteNxPlaneForRandom    (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse);
+    NV_RET WriteNxPlaneForRandom    (NandStagePacket &stDataPacket, UINT32 nSemiPhyRow, UINT32 nCol, UINT8 *pData, UINT32 nNumsPulse, UINT32 *pStatusData = NULL, bool bLastRand = false, bool bLastStage = false);
     NV_RET WriteNxPlaneRandomColSelection(NandStagePacket &stDataPacket, UINT32 nOpenRow, UINT32 nCol, UINT8 *pData, UINT32 *pStatusData, UINT32 nNumsPulse, bool bLastRand = false, bool bLastStage= false );
 
     //////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,7 @@ namespace NANDFlashSim {
 std::string  ParamManager::_inipath[INI_MAX_FILES];    
 UINT32       ParamManager::m_nEnvVal[INI_ENV_MAX];
 UINT32       ParamManager::m_nDeviceVal[INI_DEVICE_MAX];
+std::map< std::string, std::string > ParamManager::_rawDeviceTable;
 
 paramTypes gParamTypes[] = 
 {
@@ -79,6 +80,10 @@ paramTypes gParamTypes[] =
     { "TIME.tCBSY",      "", INI_ENV_MAX, ITV_tCBSY, FALSE, FALSE  },
     { "TIME.tDBSY",      "", INI_ENV_MAX, ITV_tDBSY, FALSE, FALSE  },
     { "TIME.tPROG",      "wtprog", INI_ENV_MAX, ITV_tPROG, FALSE, FALSE  },
+    { "TIME.tRPRE",      "", INI_ENV_MAX, ITV_tRPRE, FALSE, TRUE  },
+    { "TIME.tRPST",      "", INI_ENV_MAX, ITV_tRPST, FALSE, TRUE  },
+    { "TIME.tWPRE",      "", INI_ENV_MAX, ITV_tWPRE, FALSE, TRUE  },
+    { "TIME.tWPST",      "", INI_ENV_MAX, ITV_tWPST, FALSE, TRUE  },
 
     { "TYPMINTIME.tPROG",       "ttprog", INI_ENV_MAX, IMV_tPROG, FALSE, FALSE  },
     { "TYPMINTIME.tDCBSYR1",    "", INI_ENV_MAX, IMV_tDCBSYR1, FALSE, FALSE  },
@@ -95,6 +100,7 @@ paramTypes gParamTypes[] =
     { "DC.ISB2",    "", INI_ENV_MAX, IDV_ISB2, FALSE, FALSE  },
     { "DC.ILI",     "", INI_ENV_MAX, IDV_ILI, FALSE, FALSE  },
     { "DC.ILO",     "", INI_ENV_MAX, IDV_ILO, FALSE, FALSE  },
+    { "DC.POWER_BUDGET", "powerbudget", INI_ENV_MAX, IDV_POWER_BUDGET, FALSE, TRUE  },
 
     { "SYS.NOP",            "nop", INI_ENV_MAX, ISV_NOP, FALSE, FALSE  },
     { "SYS.NUMS_PLANE",     "plane", INI_ENV_MAX, ISV_NUMS_PLANE, FALSE, FALSE  },
@@ -106,6 +112,46 @@ paramTypes gParamTypes[] =
     { "SYS.NUMS_IOPINS",    "pins", INI_ENV_MAX, ISV_NUMS_IOPINS, FALSE, FALSE  },
     { "SYS.MAX_ERASE_CNT",  "erasecnt", INI_ENV_MAX, ISV_MAX_ERASE_CNT, FALSE, FALSE  },
     { "SYS.CLOCK_PERIODS",  "cp", INI_ENV_MAX, ISV_CLOCK_PERIODS, FALSE, FALSE  },
+    { "SYS.INTERFACE_MODE", "interface", INI_ENV_MAX, ISV_INTERFACE_MODE, FALSE, TRUE  },
+    { "SYS.DATA_RATE",      "datarate", INI_ENV_MAX, ISV_DATA_RATE, FALSE, TRUE  },
+
+    { "PAGETYPE.NUMS_TYPES", "pagetypes", INI_ENV_MAX, IPV_NUMS_TYPES, FALSE, TRUE  },
+    { "PAGETYPE.tPROG",      "", INI_ENV_MAX, IPV_tPROG, FALSE, TRUE  },
+    { "PAGETYPE.tR",         "", INI_ENV_MAX, IPV_tR, FALSE, TRUE  },
+    { "PAGETYPE.MAP",        "", INI_ENV_MAX, IPV_MAP, FALSE, TRUE  },
+    { "PAGETYPE.ONESHOT",    "oneshot", INI_ENV_MAX, IPV_ONESHOT, FALSE, TRUE  },
+
+    { "SLC.tPROG",      "", INI_ENV_MAX, IBV_SLC_tPROG, FALSE, TRUE  },
+    { "SLC.tR",         "", INI_ENV_MAX, IBV_SLC_tR, FALSE, TRUE  },
+    { "SLC.tBERS",      "", INI_ENV_MAX, IBV_SLC_tBERS, FALSE, TRUE  },
+    { "SLC.NUMS_PAGES", "slcpages", INI_ENV_MAX, IBV_SLC_NUMS_PAGES, FALSE, TRUE  },
+
+    { "RELIABILITY.READ_RETRY",          "readretry", INI_ENV_MAX, ILV_READ_RETRY, FALSE, TRUE  },
+    { "RELIABILITY.MAX_RETRY",           "", INI_ENV_MAX, ILV_MAX_RETRY, FALSE, TRUE  },
+    { "RELIABILITY.tECC",                "", INI_ENV_MAX, ILV_tECC, FALSE, TRUE  },
+    { "RELIABILITY.EC_PER_RETRY",        "", INI_ENV_MAX, ILV_EC_PER_RETRY, FALSE, TRUE  },
+    { "RELIABILITY.RETENTION_PER_RETRY", "", INI_ENV_MAX, ILV_RETENTION_PER_RETRY, FALSE, TRUE  },
+    { "RELIABILITY.READS_PER_RETRY",     "", INI_ENV_MAX, ILV_READS_PER_RETRY, FALSE, TRUE  },
+
+    { "FTL.OVERPROVISION", "overprovision", INI_ENV_MAX, IFV_OVERPROVISION, FALSE, TRUE  },
+    { "FTL.GC_POLICY", "gcpolicy", INI_ENV_MAX, IFV_GC_POLICY, FALSE, TRUE  },
+    { "FTL.GC_HIGH_WATERMARK", "gchigh", INI_ENV_MAX, IFV_GC_HIGH_WATERMARK, FALSE, TRUE  },
+    { "FTL.GC_LOW_WATERMARK", "gclow", INI_ENV_MAX, IFV_GC_LOW_WATERMARK, FALSE, TRUE  },
+    { "FTL.WL_THRESHOLD", "wlthreshold", INI_ENV_MAX, IFV_WL_THRESHOLD, FALSE, TRUE  },
+    { "FTL.MAP_CACHE_ENTRIES", "mapcache", INI_ENV_MAX, IFV_MAP_CACHE_ENTRIES, FALSE, TRUE  },
+    { "FTL.WRITE_BUFFER_PAGES", "writebuffer", INI_ENV_MAX, IFV_WRITE_BUFFER_PAGES, FALSE, TRUE  },
+    { "FTL.BUFFER_HIGH_WATERMARK", "bufferhigh", INI_ENV_MAX, IFV_BUFFER_HIGH_WATERMARK, FALSE, TRUE  },
+    { "FTL.BUFFER_LOW_WATERMARK", "bufferlow", INI_ENV_MAX, IFV_BUFFER_LOW_WATERMARK, FALSE, TRUE  },
+    { "FTL.BUFFER_IDLE_TIME", "bufferidle", INI_ENV_MAX, IFV_BUFFER_IDLE_TIME, FALSE, TRUE  },
+    { "FTL.DRAM_BANDWIDTH", "drambw", INI_ENV_MAX, IFV_DRAM_BANDWIDTH, FALSE, TRUE  },
+    { "FTL.PREFETCH_PAGES", "prefetch", INI_ENV_MAX, IFV_PREFETCH_PAGES, FALSE, TRUE  },
+    { "FTL.PREFETCH_TRIGGER", "prefetchtrigger", INI_ENV_MAX, IFV_PREFETCH_TRIGGER, FALSE, TRUE  },
+    { "FTL.PREFETCH_STREAMS", "prefetchstreams", INI_ENV_MAX, IFV_PREFETCH_STREAMS, FALSE, TRUE  },
+    { "FTL.SUPERBLOCK", "superblock", INI_ENV_MAX, IFV_SUPERBLOCK, FALSE, TRUE  },
+    { "FTL.WRITE_STREAMS", "write_streams", INI_ENV_MAX, IFV_WRITE_STREAMS, FALSE, TRUE  },
+    { "FTL.TRIM_STALE", "trim_stale", INI_ENV_MAX, IFV_TRIM_STALE, FALSE, TRUE  },
+    { "FTL.PRE_ERASE_TARGET", "pre_erase_target", INI_ENV_MAX, IFV_PRE_ERASE_TARGET, FALSE, TRUE  },
+    { "FTL.PRE_ERASE_IDLE_TIME", "pre_erase_idle", INI_ENV_MAX, IFV_PRE_ERASE_IDLE_TIME, FALSE, TRUE  },
 
     { "REPORT.SnoopNandPlaneRead", "readhistory", IRV_SNOOP_NAND_PLANE_READ, INI_DEVICE_MAX, TRUE, FALSE  },
     { "REPORT.SnoopNandPlaneWrite", "writehistory", IRV_SNOOP_NAND_PLANE_WRITE, INI_DEVICE_MAX, TRUE, FALSE  },
@@ -122,7 +168,7 @@ paramTypes gParamTypes[] =
     { "", "", INI_ENV_MAX, INI_DEVICE_MAX, FALSE, FALSE }
 };
 
-void ParamManager::readIni( std::string &iniPath, std::map< std::string, UINT32 > &paramTable )
+void ParamManager::readIni( std::string &iniPath, std::map< std::string, UINT32 > &paramTable, std::map< std::string, std::string > *pRawTable )
 {
     namespace pod = boost::program_options::detail;
     if(iniPath.empty() != true)
@@ -141,6 +187,10 @@ void ParamManager::readIni( std::string &iniPath, std::map< std::string, UINT32
         for (pod::config_file_iterator i(configure, option), e ; i != e; ++i)
         {
             paramTable[i->string_key] = atoi(i->value[0].c_str());
+            if(pRawTable != NULL)
+            {
+                (*pRawTable)[i->string_key] = i->value[0];
+            }
         }
     }
 }  
@@ -199,7 +249,7 @@ UINT32 ParamManager::GetParam(INI_DEVICE_VALUE eValue)
         memset(m_nDeviceVal, 0xFFFFFFFF, sizeof(m_nDeviceVal));
 
         assert(_inipath[INI_DEVICE].empty() == false);
-        readIni(_inipath[INI_DEVICE], paramTable);
+        readIni(_inipath[INI_DEVICE], paramTable, &_rawDeviceTable);
 
         std::map< std::string, UINT32 >::iterator it = paramTable.begin();
         for(; it != paramTable.end(); it++)
@@ -218,12 +268,144 @@ UINT32 ParamManager::GetParam(INI_DEVICE_VALUE eValue)
         if(m_nDeviceVal[ISV_CLOCK_PERIODS] == 0) m_nDeviceVal[ISV_CLOCK_PERIODS] = 1;
         if(m_nDeviceVal[ISV_NUMS_PLANE] == 0) m_nDeviceVal[ISV_NUMS_PLANE] = 2;
         if(m_nDeviceVal[ISV_NUMS_DIE] == 0) m_nDeviceVal[ISV_NUMS_DIE] = 2;
+
+        // interface parameters are optional; devices without them are SDR parts.
+        if(m_nDeviceVal[ISV_INTERFACE_MODE] == NULL_SIG(UINT32)) m_nDeviceVal[ISV_INTERFACE_MODE] = NAND_IF_SDR;
+        if(m_nDeviceVal[ISV_DATA_RATE] == NULL_SIG(UINT32)) m_nDeviceVal[ISV_DATA_RATE] = 0;
+        if(m_nDeviceVal[ITV_tRPRE] == NULL_SIG(UINT32)) m_nDeviceVal[ITV_tRPRE] = 0;
+        if(m_nDeviceVal[ITV_tRPST] == NULL_SIG(UINT32)) m_nDeviceVal[ITV_tRPST] = 0;
+        if(m_nDeviceVal[ITV_tWPRE] == NULL_SIG(UINT32)) m_nDeviceVal[ITV_tWPRE] = 0;
+        if(m_nDeviceVal[ITV_tWPST] == NULL_SIG(UINT32)) m_nDeviceVal[ITV_tWPST] = 0;
+        if(m_nDeviceVal[ISV_INTERFACE_MODE] >= NAND_IF_MAX || 
+           (m_nDeviceVal[ISV_INTERFACE_MODE] != NAND_IF_SDR && m_nDeviceVal[ISV_DATA_RATE] == 0))
+        {
+            std::cerr<<"invalid interface mode or data rate, SDR interface is used"<<std::endl;
+            m_nDeviceVal[ISV_INTERFACE_MODE] = NAND_IF_SDR;
+        }
+
+        // page type tables are optional; without them, the page offset patterns of CMLCStyleVariation are used.
+        if(m_nDeviceVal[IPV_NUMS_TYPES] == NULL_SIG(UINT32)) m_nDeviceVal[IPV_NUMS_TYPES] = 0;
+        if(m_nDeviceVal[IPV_ONESHOT] == NULL_SIG(UINT32)) m_nDeviceVal[IPV_ONESHOT] = 0;
+
+        // SLC mode blocks use the native timing which SLC.* doesn't give, and have a page per word line.
+        for(UINT32 nIdx = IBV_SLC_tPROG; nIdx <= IBV_SLC_tBERS; nIdx++)
+        {
+            if(m_nDeviceVal[nIdx] == NULL_SIG(UINT32)) m_nDeviceVal[nIdx] = 0;
+        }
+        if(m_nDeviceVal[IBV_SLC_NUMS_PAGES] == NULL_SIG(UINT32) || m_nDeviceVal[IBV_SLC_NUMS_PAGES] > m_nDeviceVal[ISV_NUMS_PAGES])
+        {
+            UINT32 nBitsPerCell = (m_nDeviceVal[IPV_NUMS_TYPES] > 1) ? m_nDeviceVal[IPV_NUMS_TYPES] : 2;
+            m_nDeviceVal[IBV_SLC_NUMS_PAGES] = m_nDeviceVal[ISV_NUMS_PAGES] / nBitsPerCell;
+        }
+
+        // no power budget means the dies of a logical unit are not throttled by their array currents.
+        if(m_nDeviceVal[IDV_POWER_BUDGET] == NULL_SIG(UINT32)) m_nDeviceVal[IDV_POWER_BUDGET] = 0;
+
+        // read-retry model is optional; a zero divisor disables the corresponding factor and no MAX_RETRY means no cap.
+        for(UINT32 nIdx = ILV_READ_RETRY; nIdx <= ILV_READS_PER_RETRY; nIdx++)
+        {
+            if(nIdx != ILV_MAX_RETRY && m_nDeviceVal[nIdx] == NULL_SIG(UINT32)) m_nDeviceVal[nIdx] = 0;
+        }
+
+        // the spare capacity of NandFtl in percent of the physical pages.
+        if(m_nDeviceVal[IFV_OVERPROVISION] == NULL_SIG(UINT32) || m_nDeviceVal[IFV_OVERPROVISION] >= 100) m_nDeviceVal[IFV_OVERPROVISION] = 7;
+
+        // greedy GC by default; the watermarks are free block groups per die and are clamped by NandFtl.
+        if(m_nDeviceVal[IFV_GC_POLICY] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_GC_POLICY] = 0;
+        if(m_nDeviceVal[IFV_GC_HIGH_WATERMARK] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_GC_HIGH_WATERMARK] = 16;
+        if(m_nDeviceVal[IFV_GC_LOW_WATERMARK] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_GC_LOW_WATERMARK] = 4;
+
+        // static wear leveling of NandFtl starts at this erase count spread; 0 leaves only the dynamic one.
+        if(m_nDeviceVal[IFV_WL_THRESHOLD] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_WL_THRESHOLD] = 16;
+
+        // no mapping cache means the whole page map of NandFtl is in DRAM.
+        if(m_nDeviceVal[IFV_MAP_CACHE_ENTRIES] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_MAP_CACHE_ENTRIES] = 0;
+
+        // no write buffer by default; the watermarks are percent of the buffer, the idle time is ns and the bandwidth MB/s.
+        if(m_nDeviceVal[IFV_WRITE_BUFFER_PAGES] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_WRITE_BUFFER_PAGES] = 0;
+        if(m_nDeviceVal[IFV_BUFFER_HIGH_WATERMARK] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_BUFFER_HIGH_WATERMARK] = 75;
+        if(m_nDeviceVal[IFV_BUFFER_LOW_WATERMARK] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_BUFFER_LOW_WATERMARK] = 25;
+        if(m_nDeviceVal[IFV_BUFFER_IDLE_TIME] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_BUFFER_IDLE_TIME] = 1000000;
+        if(m_nDeviceVal[IFV_DRAM_BANDWIDTH] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_DRAM_BANDWIDTH] = 1600;
+
+        // no read-ahead by default; a stream is followed after its trigger pages are read in a row.
+        if(m_nDeviceVal[IFV_PREFETCH_PAGES] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_PREFETCH_PAGES] = 0;
+        if(m_nDeviceVal[IFV_PREFETCH_TRIGGER] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_PREFETCH_TRIGGER] = 4;
+        if(m_nDeviceVal[IFV_PREFETCH_STREAMS] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_PREFETCH_STREAMS] = 4;
+
+        // host writes go to the block groups of each die unless superblocks are asked for.
+        if(m_nDeviceVal[IFV_SUPERBLOCK] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_SUPERBLOCK] = 0;
+
+        // hot and cold data share the open blocks by default.
+        if(m_nDeviceVal[IFV_WRITE_STREAMS] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_WRITE_STREAMS] = 1;
+
+        // a trim only unmaps the logical pages unless the planes are told about it.
+        if(m_nDeviceVal[IFV_TRIM_STALE] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_TRIM_STALE] = 0;
+
+        // GC erases its victims at once unless a pre-erase target is given.
+        if(m_nDeviceVal[IFV_PRE_ERASE_TARGET] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_PRE_ERASE_TARGET] = 0;
+        if(m_nDeviceVal[IFV_PRE_ERASE_IDLE_TIME] == NULL_SIG(UINT32)) m_nDeviceVal[IFV_PRE_ERASE_IDLE_TIME] = 100000;
     }
 
     return m_nDeviceVal[eValue];
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Method:    GetParamList
+// FullName:  ParamManager::GetParamList
+// Access:    public static 
+// Returns:   bool
+// Parameter: INI_DEVICE_VALUE eValue
+// Parameter: std::vector<UINT32> & vctList
+//
+// Descriptions -
+// Parse a comma separated device parameter (e.g., MAP=0,1,0,1) into vctList.
+// GetParam only keeps the first value of such a list.
+// Return false if the parameter is not given by ini file.
+//
+//////////////////////////////////////////////////////////////////////////////
+bool ParamManager::GetParamList(INI_DEVICE_VALUE eValue, std::vector<UINT32> &vctList)
+{
+    GetParam(eValue);
+    vctList.clear();
+
+    for(int i = 0; gParamTypes[i].szTypeIniName[0] != '\0'; i++)
+    {
+        if(gParamTypes[i].bIsEnv == TRUE || gParamTypes[i].eDeviceValue != eValue)
+        {
+            continue;
+        }
+
+        std::map< std::string, std::string >::iterator it = _rawDeviceTable.find(gParamTypes[i].szTypeIniName);
+        if(it == _rawDeviceTable.end())
+        {
+            return false;
+        }
+
+        std::string::size_type nPos = 0;
+        while(nPos <= it->second.size())
+        {
+            std::string::size_type nNext = it->second.find(',', nPos);
+            if(nNext == std::string::npos)
+            {
+                nNext = it->second.size();
+            }
+            std::string strToken = it->second.substr(nPos, nNext - nPos);
+            if(strToken.find_first_not_of(" \t") != std::string::npos)
+            {
+                vctList.push_back(atoi(strToken.c_str()));
+            }
+            nPos = nNext + 1;
+        }
+        return (vctList.empty() == false);
+    }
+
+    return false;
+}
+
+
 void ParamManager::SetParam(INI_DEVICE_VALUE eType, UINT32 nTypeIdx, UINT32 nValue)
 {
     m_nDeviceVal[eType] = nValue;
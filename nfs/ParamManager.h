@@ -97,6 +97,10 @@ typedef enum
     ITV_tCBSY,
     ITV_tDBSY,
     ITV_tPROG,
+    ITV_tRPRE,
+    ITV_tRPST,
+    ITV_tWPRE,
+    ITV_tWPST,
     
     IMV_tPROG,
     IMV_tDCBSYR1,
@@ -113,6 +117,7 @@ typedef enum
     IDV_ISB2,
     IDV_ILI,
     IDV_ILO,
+    IDV_POWER_BUDGET,
 
     ISV_NOP,
     ISV_NUMS_PLANE,
@@ -124,6 +129,46 @@ typedef enum
     ISV_NUMS_IOPINS,
     ISV_MAX_ERASE_CNT,
     ISV_CLOCK_PERIODS,
+    ISV_INTERFACE_MODE,
+    ISV_DATA_RATE,
+
+    IPV_NUMS_TYPES,
+    IPV_tPROG,
+    IPV_tR,
+    IPV_MAP,
+    IPV_ONESHOT,
+
+    IBV_SLC_tPROG,
+    IBV_SLC_tR,
+    IBV_SLC_tBERS,
+    IBV_SLC_NUMS_PAGES,
+
+    ILV_READ_RETRY,
+    ILV_MAX_RETRY,
+    ILV_tECC,
+    ILV_EC_PER_RETRY,
+    ILV_RETENTION_PER_RETRY,
+    ILV_READS_PER_RETRY,
+
+    IFV_OVERPROVISION,
+    IFV_GC_POLICY,
+    IFV_GC_HIGH_WATERMARK,
+    IFV_GC_LOW_WATERMARK,
+    IFV_WL_THRESHOLD,
+    IFV_MAP_CACHE_ENTRIES,
+    IFV_WRITE_BUFFER_PAGES,
+    IFV_BUFFER_HIGH_WATERMARK,
+    IFV_BUFFER_LOW_WATERMARK,
+    IFV_BUFFER_IDLE_TIME,
+    IFV_DRAM_BANDWIDTH,
+    IFV_PREFETCH_PAGES,
+    IFV_PREFETCH_TRIGGER,
+    IFV_PREFETCH_STREAMS,
+    IFV_SUPERBLOCK,
+    IFV_WRITE_STREAMS,
+    IFV_TRIM_STALE,
+    IFV_PRE_ERASE_TARGET,
+    IFV_PRE_ERASE_IDLE_TIME,
 
     INI_DEVICE_MAX
 }INI_DEVICE_VALUE;
@@ -145,12 +190,14 @@ private :
 	// singletone
 	ParamManager();
     static std::string                      _inipath[INI_MAX_FILES];    
-    static void     readIni(std::string &iniPath, std::map< std::string, UINT32 > &paramTable);
+    static std::map< std::string, std::string > _rawDeviceTable;     // raw strings of device parameters (for list values)
+    static void     readIni(std::string &iniPath, std::map< std::string, UINT32 > &paramTable, std::map< std::string, std::string > *pRawTable = NULL);
 
 public :
     static void     SetIniInfo(const char * deviceIniPath, const char * envIniPath);
     static UINT32   GetParam(INI_DEVICE_VALUE eValue);
     static UINT32   GetEnv(INI_ENV_VALUE eValue);
+    static bool     GetParamList(INI_DEVICE_VALUE eValue, std::vector<UINT32> &vctList);
 
     static void     SetParam(INI_DEVICE_VALUE eType, UINT32 nTypeIdx, UINT32 nValue);
     static void     SetEnv(INI_ENV_VALUE eType, UINT32 nTypeIdx, UINT32 nValue);
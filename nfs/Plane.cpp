@@ -28,23 +28,34 @@
 #ifndef NO_STORAGE
 #include "boost/filesystem/path.hpp"
 #include "boost/filesystem.hpp"
+#ifdef ASYNC_STORAGE
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#elif !defined(COMPRESSED_STORAGE)
 #include "boost/iostreams/code_converter.hpp"
 #include "boost/iostreams/device/mapped_file.hpp"
 #endif
+#endif
 
 #include <iostream>
 #include <sstream>
 #include "boost/shared_array.hpp"
 
 #include "Tools.h"
+#include "NandCheckpoint.h"
 #include "Plane.h"
 #include "NandLogger.h"
 #include <memory.h>
 
 #ifndef NO_STORAGE
 namespace fs    = boost::filesystem;
+#if !defined(ASYNC_STORAGE) && !defined(COMPRESSED_STORAGE)
 namespace io    = boost::iostreams;
 #endif
+#endif
 
 
 namespace NANDFlashSim {
@@ -54,18 +65,39 @@ Plane::Plane( NandDeviceConfig &stDevConfig)
 #ifndef NO_STORAGE
     _vctpVirtualBlk(stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION, NULL),
 #endif
-    _stDevConfig(stDevConfig)
+    _stDevConfig(stDevConfig),
+    _nStatNopViolation(0),
+    _nStateDataCorruption(0),
+    _nStatWearout(0),
+    _nStatStaleReads(0)
 {
-#ifndef NO_STORAGE
+#if !defined(NO_STORAGE) && defined(COMPRESSED_STORAGE)
+    _vctPgBuf           = std::vector<UINT8>(NAND_FULL_PAGE_SIZE(stDevConfig), 0x0);
+#elif !defined(NO_STORAGE)
     if(fs::exists(".\\phyicalData") == false)
     {
         fs::create_directory(".\\phyicalData");
     } 
-    _vctVirtualBlk.resize(stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+#ifdef ASYNC_STORAGE
+    _vctVirtualBlkFd    = std::vector<int>(stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION, -1);
+    _bIoPending         = false;
+    _saZeroBlk          = PNOP_PGS(new UINT8[NAND_BLOCK_SIZE(stDevConfig)]);
+    memset(_saZeroBlk.get(), 0x0, NAND_BLOCK_SIZE(stDevConfig));
+#else
+    // mapped_file copies share their handle, so each virtual block needs its own instance.
+    for(UINT32 nIdx = 0; nIdx < stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION; nIdx++)
+    {
+        _vctVirtualBlk.push_back(VIRTUABLK_FILE());
+    }
+#endif
 #endif
 
     _vctEcBlkInfo   = std::vector<UINT32>(stDevConfig._nNumsBlk, 0);
     _vctLppBlkInfo  = std::vector<UINT32>(stDevConfig._nNumsBlk, 0);
+    _vctReadCntBlkInfo  = std::vector<UINT32>(stDevConfig._nNumsBlk, 0);
+    _vctProgTimeBlkInfo = std::vector<UINT64>(stDevConfig._nNumsBlk, NULL_SIG(UINT64));
+    _vctModeBlkInfo     = std::vector<UINT8>(stDevConfig._nNumsBlk, (UINT8)NAND_BLOCK_NATIVE);
+    _vctStalePgInfo     = std::vector<UINT8>(stDevConfig._nNumsBlk * stDevConfig._nNumsPgPerBlk, 0);
     _vctsaNopPgInfo.resize(stDevConfig._nNumsBlk);
     for (UINT32 nIdx = 0; nIdx < stDevConfig._nNumsBlk; nIdx++)
     {
@@ -96,12 +128,38 @@ NV_RET Plane::Read( UINT16 nCol, UINT32 nRow, UINT8 *pData )
     UINT16  nPgoff  = NAND_PGO_PARSE_REGISTER(nRow);
 
     REPORT_NAND(NANDLOG_SNOOP_NANDPLANE_READ, _nId << " , " << nPbn << " , " << nPgoff );
+    _vctReadCntBlkInfo[nPbn]++;
+
+    // a deallocated page reads as zero without going to the storage.
+    if(IsStale(nPbn, nPgoff))
+    {
+        _nStatStaleReads++;
+        if(pData != NULL)
+        {
+            memset(pData + nCol, 0x0, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol);
+        }
+        return nRet;
+    }
 
 #ifndef NO_STORAGE
 
     size_t  nVirtualBlkIdx  = nPbn / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
     size_t  nVirtualPgIdx   = (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * _stDevConfig._nNumsPgPerBlk + nPgoff;
 
+#ifdef ASYNC_STORAGE
+    // the data will be ready when the die needs it (TOR); see WaitIo().
+    if(pData != NULL)
+    {
+        nRet |= submitIo(nVirtualBlkIdx, nVirtualPgIdx * NAND_FULL_PAGE_SIZE(_stDevConfig) + nCol, pData + nCol, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol, false);
+    }
+#elif defined(COMPRESSED_STORAGE)
+    (void)nVirtualBlkIdx; (void)nVirtualPgIdx;
+    if(pData != NULL)
+    {
+        loadCompressedPage(nPbn * _stDevConfig._nNumsPgPerBlk + nPgoff, &_vctPgBuf[0]);
+        memcpy(pData + nCol, &_vctPgBuf[nCol], NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol);
+    }
+#else
     if(_vctpVirtualBlk[nVirtualBlkIdx] == NULL)
     {
         // for minimizing to allocate mapped file, it will be created on demand.
@@ -111,9 +169,10 @@ NV_RET Plane::Read( UINT16 nCol, UINT32 nRow, UINT8 *pData )
 
     if(pData != NULL)
     {
-        UINT8 * memoryoffset = _vctpVirtualBlk[nVirtualBlkIdx] + (nVirtualPgIdx * _stDevConfig._nPgSize + nCol);
-        memcpy(pData + nCol, memoryoffset, _stDevConfig._nPgSize - nCol);
+        UINT8 * memoryoffset = _vctpVirtualBlk[nVirtualBlkIdx] + (nVirtualPgIdx * NAND_FULL_PAGE_SIZE(_stDevConfig) + nCol);
+        memcpy(pData + nCol, memoryoffset, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol);
     }
+#endif
 #endif
     return nRet;
 }
@@ -163,12 +222,38 @@ NV_RET Plane::Write( UINT16 nCol, UINT32 nRow, UINT8 *pData )
         //
     }
 
+    if(nPgoff >= UsablePages(nPbn))
+    {
+        nRet |= NAND_PLANE_ERROR_ADDRESS;
+        NV_ERROR("try to write beyond the pages of SLC mode block :" << nPbn);
+    }
+
     _vctLppBlkInfo[nPbn]    = nPgoff;
+    _vctStalePgInfo[nPbn * _stDevConfig._nNumsPgPerBlk + nPgoff] = 0;
 
 #ifndef NO_STORAGE
     size_t  nVirtualBlkIdx  = nPbn / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
     size_t  nVirtualPgIdx   = (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * _stDevConfig._nNumsPgPerBlk + nPgoff;
 
+#ifdef ASYNC_STORAGE
+    // pData (cache register) must not be overwritten until WaitIo() returns.
+    if(pData != NULL)
+    {
+        nRet |= submitIo(nVirtualBlkIdx, nVirtualPgIdx * NAND_FULL_PAGE_SIZE(_stDevConfig) + nCol, pData + nCol, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol, true);
+    }
+#elif defined(COMPRESSED_STORAGE)
+    (void)nVirtualBlkIdx; (void)nVirtualPgIdx;
+    if(pData != NULL)
+    {
+        UINT32 nPgIdx = nPbn * _stDevConfig._nNumsPgPerBlk + nPgoff;
+        if(nCol != 0)
+        {
+            loadCompressedPage(nPgIdx, &_vctPgBuf[0]);
+        }
+        memcpy(&_vctPgBuf[nCol], pData + nCol, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol);
+        storeCompressedPage(nPgIdx, &_vctPgBuf[0]);
+    }
+#else
     if(_vctpVirtualBlk[nVirtualBlkIdx] == NULL)
     {
         // for minimizing to allocate mapped file, it will be created on demand.
@@ -178,27 +263,32 @@ NV_RET Plane::Write( UINT16 nCol, UINT32 nRow, UINT8 *pData )
 
     if(pData != NULL)
     {
-        UINT8 * memoryoffset = _vctpVirtualBlk[nVirtualBlkIdx] + (nVirtualPgIdx * _stDevConfig._nPgSize + nCol);
-        memcpy(memoryoffset, pData + nCol, _stDevConfig._nPgSize - nCol);
+        UINT8 * memoryoffset = _vctpVirtualBlk[nVirtualBlkIdx] + (nVirtualPgIdx * NAND_FULL_PAGE_SIZE(_stDevConfig) + nCol);
+        memcpy(memoryoffset, pData + nCol, NAND_FULL_PAGE_SIZE(_stDevConfig) - nCol);
 
     }
+#endif
 #endif    
     return nRet;
 }
 
+std::string Plane::virtualNANDBlockPath(UINT32 nVirtualBlkIdx)
+{
+    std::ostringstream  strstream;
+    strstream << ".\\phyicalData\\DEVID_" << _stDevConfig._nDeviceId << "_PLID" << _nId << "_VND" << nVirtualBlkIdx;
+    return strstream.str();
+}
+
 UINT8* Plane::allocateVirtualNANDBlock(UINT32 nVirtualBlkIdx)
 {
     UINT8*                  pAllocatedBlk = NULL;
-#ifndef NO_STORAGE
+#if !defined(NO_STORAGE) && !defined(ASYNC_STORAGE) && !defined(COMPRESSED_STORAGE)
     //
     // load nand plane
     //
     io::mapped_file_params  mapParam;
 
-    std::ostringstream  strstream;
-    strstream << ".\\phyicalData\\DEVID_" << _stDevConfig._nDeviceId << "_PLID" << _nId << "_VND" << nVirtualBlkIdx;
-
-    mapParam.path           = strstream.str();
+    mapParam.path           = virtualNANDBlockPath(nVirtualBlkIdx);
     mapParam.flags          = io::mapped_file::readwrite;
 
     if(fs::exists(mapParam.path) == false)
@@ -218,8 +308,10 @@ UINT8* Plane::allocateVirtualNANDBlock(UINT32 nVirtualBlkIdx)
     }
     else
     {
-        NV_ERROR("open fail for NAND plane data : " + strstream.str());
+        NV_ERROR("open fail for NAND plane data : " + mapParam.path);
     }
+#else
+    (void)nVirtualBlkIdx;
 #endif
     return pAllocatedBlk;
 
@@ -237,6 +329,9 @@ NV_RET Plane::Erase( UINT32 nRow )
     }
     _vctLppBlkInfo[nPbn]  = 0;
     memset(_vctsaNopPgInfo[nPbn].get(), 0x0, _stDevConfig._nNumsPgPerBlk);
+    _vctReadCntBlkInfo[nPbn]    = 0;
+    _vctProgTimeBlkInfo[nPbn]   = NULL_SIG(UINT64);
+    memset(&_vctStalePgInfo[nPbn * _stDevConfig._nNumsPgPerBlk], 0x0, _stDevConfig._nNumsPgPerBlk);
 
     //
     // Assume that the erase operation fill '0' rather than '1' that is used by real NAND.
@@ -244,7 +339,20 @@ NV_RET Plane::Erase( UINT32 nRow )
     //
 #ifndef NO_STORAGE
     size_t  nVirtualBlkIdx = nPbn / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
-    memset((void *)_vctpVirtualBlk[nVirtualBlkIdx], 0x0, NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+#ifdef ASYNC_STORAGE
+    nRet |= submitIo(nVirtualBlkIdx, (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * NAND_BLOCK_SIZE(_stDevConfig), _saZeroBlk.get(), NAND_BLOCK_SIZE(_stDevConfig), true);
+#elif defined(COMPRESSED_STORAGE)
+    (void)nVirtualBlkIdx;
+    eraseCompressedPages(nPbn * _stDevConfig._nNumsPgPerBlk, _stDevConfig._nNumsPgPerBlk);
+#else
+    if(_vctpVirtualBlk[nVirtualBlkIdx] == NULL)
+    {
+        _vctpVirtualBlk[nVirtualBlkIdx] = allocateVirtualNANDBlock(nVirtualBlkIdx);
+        assert(_vctpVirtualBlk[nVirtualBlkIdx] != NULL);
+    }
+    // a virtual block groups several physical blocks; only the erased one is cleared.
+    memset((void *)(_vctpVirtualBlk[nVirtualBlkIdx] + (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * NAND_BLOCK_SIZE(_stDevConfig)), 0x0, NAND_BLOCK_SIZE(_stDevConfig));
+#endif
 #endif
    _vctEcBlkInfo[nPbn]++;
 
@@ -258,9 +366,135 @@ NV_RET Plane::Erase( UINT32 nRow )
    return nRet;
 }
 
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    BlockMode
+// FullName:  Plane::BlockMode
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT16 nPbn
+// Parameter: NAND_BLOCK_MODE eMode
+//
+// Descriptions -
+// Choose the cell mode of a block. Like the SLC mode of real devices, the mode
+// can be changed only while the block is erased, and it is kept over erases.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Plane::BlockMode( UINT16 nPbn, NAND_BLOCK_MODE eMode )
+{
+    if(nPbn >= _stDevConfig._nNumsBlk || eMode >= NAND_BLOCK_MODE_MAX)
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+
+    if(_vctModeBlkInfo[nPbn] != (UINT8)eMode && _vctProgTimeBlkInfo[nPbn] != NULL_SIG(UINT64))
+    {
+        NV_ERROR("block mode is changed for a programmed block :" << nPbn);
+        return NAND_PLANE_ERROR_BLOCK_MODE;
+    }
+
+    _vctModeBlkInfo[nPbn] = (UINT8)eMode;
+    return NAND_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Precondition
+// FullName:  Plane::Precondition
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT16 nPbn
+// Parameter: UINT32 nProgrammedPgs
+// Parameter: UINT32 nEc
+// Parameter: UINT8 * pSignature
+//
+// Descriptions -
+// Put a block directly into the state it would have after being erased nEc 
+// times and then programmed from page 0 up to nProgrammedPgs - 1. No timing is 
+// accounted. If storage is enabled and pSignature is not NULL, the data area of 
+// every programmed page is filled with the page-sized signature; the spare area
+// and the rest of the block are left erased.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Plane::Precondition( UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature )
+{
+    NV_RET nRet = NAND_SUCCESS;
+    if(nPbn >= _stDevConfig._nNumsBlk || nProgrammedPgs > UsablePages(nPbn))
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+
+    _vctEcBlkInfo[nPbn]     = nEc;
+    _vctLppBlkInfo[nPbn]    = (nProgrammedPgs != 0) ? nProgrammedPgs - 1 : 0;
+    _vctReadCntBlkInfo[nPbn]    = 0;
+    _vctProgTimeBlkInfo[nPbn]   = (nProgrammedPgs != 0) ? 0 : NULL_SIG(UINT64);
+    memset(_vctsaNopPgInfo[nPbn].get(), 0x0, _stDevConfig._nNumsPgPerBlk);
+    memset(_vctsaNopPgInfo[nPbn].get(), 0x1, nProgrammedPgs);
+    memset(&_vctStalePgInfo[nPbn * _stDevConfig._nNumsPgPerBlk], 0x0, _stDevConfig._nNumsPgPerBlk);
+
+    if(_stDevConfig._nEc <= nEc)
+    {
+        nRet |= NAND_PLANE_ERROR_WEAROUT;
+    }
+
+#if !defined(NO_STORAGE) && defined(COMPRESSED_STORAGE)
+    UINT32  nFirstPgIdx = nPbn * _stDevConfig._nNumsPgPerBlk;
+    eraseCompressedPages(nFirstPgIdx, _stDevConfig._nNumsPgPerBlk);
+    if(pSignature != NULL && nProgrammedPgs != 0)
+    {
+        memset(&_vctPgBuf[0], 0x0, NAND_FULL_PAGE_SIZE(_stDevConfig));
+        memcpy(&_vctPgBuf[0], pSignature, _stDevConfig._nPgSize);
+        storeCompressedPage(nFirstPgIdx, &_vctPgBuf[0]);
+
+        // all programmed pages have the same content, so it is compressed only once.
+        std::map< UINT32, std::vector<UINT8> >::iterator iPage = _mapCompressedPg.find(nFirstPgIdx);
+        for(UINT32 nPgoff = 1; nPgoff < nProgrammedPgs && iPage != _mapCompressedPg.end(); nPgoff++)
+        {
+            _mapCompressedPg[nFirstPgIdx + nPgoff] = iPage->second;
+        }
+    }
+#elif !defined(NO_STORAGE)
+    size_t  nVirtualBlkIdx = nPbn / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
+#ifdef ASYNC_STORAGE
+    std::vector<UINT8> vctBlk(NAND_BLOCK_SIZE(_stDevConfig), 0x0);
+    UINT8 *pBlk = &vctBlk[0];
+#else
+    if(_vctpVirtualBlk[nVirtualBlkIdx] == NULL)
+    {
+        _vctpVirtualBlk[nVirtualBlkIdx] = allocateVirtualNANDBlock(nVirtualBlkIdx);
+        assert(_vctpVirtualBlk[nVirtualBlkIdx] != NULL);
+    }
+    UINT8 *pBlk = _vctpVirtualBlk[nVirtualBlkIdx] + (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * NAND_BLOCK_SIZE(_stDevConfig);
+    memset(pBlk, 0x0, NAND_BLOCK_SIZE(_stDevConfig));
+#endif
+    if(pSignature != NULL)
+    {
+        for(UINT32 nPgoff = 0; nPgoff < nProgrammedPgs; nPgoff++)
+        {
+            memcpy(pBlk + nPgoff * NAND_FULL_PAGE_SIZE(_stDevConfig), pSignature, _stDevConfig._nPgSize);
+        }
+    }
+#ifdef ASYNC_STORAGE
+    nRet |= WaitIo();
+    nRet |= syncIo(nVirtualBlkIdx, (nPbn % NAND_VIRTUAL_BLOCK_IDX_RESOLUTION) * NAND_BLOCK_SIZE(_stDevConfig), pBlk, NAND_BLOCK_SIZE(_stDevConfig), true);
+#endif
+#else
+    (void)pSignature;
+#endif
+    return nRet;
+}
+
 void Plane::resetPhysicalPlane()
 {
-#ifndef NO_STORAGE
+#ifdef ASYNC_STORAGE
+    WaitIo();
+    for(size_t nIdx = 0; nIdx < _vctVirtualBlkFd.size(); ++nIdx)
+    {
+        if(_vctVirtualBlkFd[nIdx] != -1)
+        {
+            close(_vctVirtualBlkFd[nIdx]);
+            _vctVirtualBlkFd[nIdx] = -1;
+        }
+    }
+#elif !defined(NO_STORAGE) && !defined(COMPRESSED_STORAGE)
 	size_t nTotalVirtualBlk = _stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
 	for(size_t nIdx = 0; nIdx < nTotalVirtualBlk; ++nIdx)
 	{
@@ -285,9 +519,405 @@ void Plane::HardReset( NandDeviceConfig &stDevConfig )
     {
         _vctEcBlkInfo[nIdx]     = 0;
         _vctLppBlkInfo[nIdx]    = 0;
+        _vctReadCntBlkInfo[nIdx]    = 0;
+        _vctProgTimeBlkInfo[nIdx]   = NULL_SIG(UINT64);
+        _vctModeBlkInfo[nIdx]       = (UINT8)NAND_BLOCK_NATIVE;
         
         memset(_vctsaNopPgInfo[nIdx].get(), 0x0, _stDevConfig._nNumsPgPerBlk);
     }
+    _vctStalePgInfo.assign(_stDevConfig._nNumsBlk * _stDevConfig._nNumsPgPerBlk, 0);
+    _nStatStaleReads    = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Deallocate
+// FullName:  Plane::Deallocate
+// Access:    public 
+// Returns:   NV_RET
+// Parameter: UINT16 nPbn
+// Parameter: UINT32 nPgoff
+//
+// Descriptions -
+// Mark a page stale, as the host has deallocated (trimmed) its data. It is only
+// a hint for the metadata; the page keeps its data until it is programmed again
+// or its block is erased, but a read of the stale page returns zero.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Plane::Deallocate( UINT16 nPbn, UINT32 nPgoff )
+{
+    if(nPbn >= _stDevConfig._nNumsBlk || nPgoff >= _stDevConfig._nNumsPgPerBlk)
+    {
+        return NAND_PLANE_ERROR_ADDRESS;
+    }
+
+    _vctStalePgInfo[nPbn * _stDevConfig._nNumsPgPerBlk + nPgoff] = 1;
+    return NAND_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    Save
+// FullName:  Plane::Save
+// Access:    public 
+// Returns:   void
+// Parameter: NandCheckpoint & ckpt
+//
+// Descriptions -
+// Serialize block metadata (EC, LPP, read count, program time, NOP, stale pages) and, if storage is enabled, the 
+// contents of every virtual block which has been touched so far.
+//////////////////////////////////////////////////////////////////////////////
+void Plane::Save( NandCheckpoint &ckpt )
+{
+    ckpt.PutVector(_vctEcBlkInfo);
+    ckpt.PutVector(_vctLppBlkInfo);
+    ckpt.PutVector(_vctReadCntBlkInfo);
+    ckpt.PutVector(_vctProgTimeBlkInfo);
+    ckpt.PutVector(_vctModeBlkInfo);
+    ckpt.PutVector(_vctStalePgInfo);
+    for (UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsBlk; nIdx++)
+    {
+        ckpt.PutBytes(_vctsaNopPgInfo[nIdx].get(), _stDevConfig._nNumsPgPerBlk);
+    }
+    ckpt.Put(_nStatNopViolation);
+    ckpt.Put(_nStateDataCorruption);
+    ckpt.Put(_nStatWearout);
+    ckpt.Put(_nStatStaleReads);
+
+#ifdef ASYNC_STORAGE
+    WaitIo();
+    std::vector<UINT8> vctVirtualBlk(NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+    for(size_t nIdx = 0; nIdx < _vctVirtualBlkFd.size(); ++nIdx)
+    {
+        UINT8 bAllocated = (_vctVirtualBlkFd[nIdx] != -1) ? TRUE : FALSE;
+        ckpt.Put(bAllocated);
+        if(bAllocated)
+        {
+            syncIo(nIdx, 0, &vctVirtualBlk[0], vctVirtualBlk.size(), false);
+            ckpt.PutBytes(&vctVirtualBlk[0], vctVirtualBlk.size());
+        }
+    }
+#elif !defined(NO_STORAGE) && defined(COMPRESSED_STORAGE)
+    // the image keeps the layout of the uncompressed storage, so a checkpoint can be restored under either build.
+    UINT32  nPgsPerVirtualBlk = _stDevConfig._nNumsPgPerBlk * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
+    for(UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION; ++nIdx)
+    {
+        std::map< UINT32, std::vector<UINT8> >::iterator iPage = _mapCompressedPg.lower_bound(nIdx * nPgsPerVirtualBlk);
+        UINT8 bAllocated = (iPage != _mapCompressedPg.end() && iPage->first < (nIdx + 1) * nPgsPerVirtualBlk) ? TRUE : FALSE;
+        ckpt.Put(bAllocated);
+        if(bAllocated)
+        {
+            for(UINT32 nPgIdx = nIdx * nPgsPerVirtualBlk; nPgIdx < (nIdx + 1) * nPgsPerVirtualBlk; ++nPgIdx)
+            {
+                loadCompressedPage(nPgIdx, &_vctPgBuf[0]);
+                ckpt.PutBytes(&_vctPgBuf[0], NAND_FULL_PAGE_SIZE(_stDevConfig));
+            }
+        }
+    }
+#elif !defined(NO_STORAGE)
+    for(size_t nIdx = 0; nIdx < _vctpVirtualBlk.size(); ++nIdx)
+    {
+        UINT8 bAllocated = (_vctpVirtualBlk[nIdx] != NULL) ? TRUE : FALSE;
+        ckpt.Put(bAllocated);
+        if(bAllocated)
+        {
+            ckpt.PutBytes(_vctpVirtualBlk[nIdx], NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+        }
+    }
+#endif
+}
+
+void Plane::Restore( NandCheckpoint &ckpt )
+{
+    ckpt.GetVector(_vctEcBlkInfo);
+    ckpt.GetVector(_vctLppBlkInfo);
+    ckpt.GetVector(_vctReadCntBlkInfo);
+    ckpt.GetVector(_vctProgTimeBlkInfo);
+    ckpt.GetVector(_vctModeBlkInfo);
+    ckpt.GetVector(_vctStalePgInfo);
+    for (UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsBlk; nIdx++)
+    {
+        ckpt.GetBytes(_vctsaNopPgInfo[nIdx].get(), _stDevConfig._nNumsPgPerBlk);
+    }
+    ckpt.Get(_nStatNopViolation);
+    ckpt.Get(_nStateDataCorruption);
+    ckpt.Get(_nStatWearout);
+    ckpt.Get(_nStatStaleReads);
+
+#ifdef ASYNC_STORAGE
+    WaitIo();
+    std::vector<UINT8> vctVirtualBlk(NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION, 0x0);
+    for(size_t nIdx = 0; nIdx < _vctVirtualBlkFd.size() && ckpt.IsBroken() == false; ++nIdx)
+    {
+        UINT8 bAllocated = FALSE;
+        ckpt.Get(bAllocated);
+        if(bAllocated == FALSE && _vctVirtualBlkFd[nIdx] == -1)
+        {
+            continue;
+        }
+
+        if(bAllocated)
+        {
+            ckpt.GetBytes(&vctVirtualBlk[0], vctVirtualBlk.size());
+        }
+        else
+        {
+            // untouched in the image means erased.
+            memset(&vctVirtualBlk[0], 0x0, vctVirtualBlk.size());
+        }
+        syncIo(nIdx, 0, &vctVirtualBlk[0], vctVirtualBlk.size(), true);
+    }
+#elif !defined(NO_STORAGE) && defined(COMPRESSED_STORAGE)
+    UINT32  nPgsPerVirtualBlk = _stDevConfig._nNumsPgPerBlk * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
+    for(UINT32 nIdx = 0; nIdx < _stDevConfig._nNumsBlk / NAND_VIRTUAL_BLOCK_IDX_RESOLUTION && ckpt.IsBroken() == false; ++nIdx)
+    {
+        UINT8 bAllocated = FALSE;
+        ckpt.Get(bAllocated);
+
+        // untouched in the image means erased.
+        eraseCompressedPages(nIdx * nPgsPerVirtualBlk, nPgsPerVirtualBlk);
+        for(UINT32 nPgIdx = nIdx * nPgsPerVirtualBlk; bAllocated && nPgIdx < (nIdx + 1) * nPgsPerVirtualBlk; ++nPgIdx)
+        {
+            ckpt.GetBytes(&_vctPgBuf[0], NAND_FULL_PAGE_SIZE(_stDevConfig));
+            storeCompressedPage(nPgIdx, &_vctPgBuf[0]);
+        }
+    }
+#elif !defined(NO_STORAGE)
+    for(size_t nIdx = 0; nIdx < _vctpVirtualBlk.size() && ckpt.IsBroken() == false; ++nIdx)
+    {
+        UINT8 bAllocated = FALSE;
+        ckpt.Get(bAllocated);
+        if(bAllocated == FALSE && _vctpVirtualBlk[nIdx] == NULL)
+        {
+            continue;
+        }
+
+        if(_vctpVirtualBlk[nIdx] == NULL)
+        {
+            _vctpVirtualBlk[nIdx] = allocateVirtualNANDBlock(nIdx);
+            assert(_vctpVirtualBlk[nIdx] != NULL);
+        }
+
+        if(bAllocated)
+        {
+            ckpt.GetBytes(_vctpVirtualBlk[nIdx], NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+        }
+        else
+        {
+            // untouched in the image means erased.
+            memset(_vctpVirtualBlk[nIdx], 0x0, NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION);
+        }
+    }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    WaitIo
+// FullName:  Plane::WaitIo
+// Access:    public 
+// Returns:   NV_RET
+//
+// Descriptions -
+// Block until the array access issued last to this plane has reached the 
+// host storage. Without ASYNC_STORAGE, every access is already synchronous.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Plane::WaitIo()
+{
+    NV_RET nRet = NAND_SUCCESS;
+#ifdef ASYNC_STORAGE
+    if(_bIoPending == true)
+    {
+        const struct aiocb *pIo = &_stPendingIo;
+        while(aio_error(pIo) == EINPROGRESS)
+        {
+            aio_suspend(&pIo, 1, NULL);
+        }
+
+        if(aio_return(&_stPendingIo) != (ssize_t)_stPendingIo.aio_nbytes)
+        {
+            nRet |= NAND_PLANE_ERROR_STORAGE;
+            NV_ERROR("asynchronous I/O fail for NAND plane data : PLID" << _nId);
+        }
+        _bIoPending = false;
+    }
+#endif
+    return nRet;
+}
+
+#ifdef ASYNC_STORAGE
+int Plane::openVirtualNANDBlock(UINT32 nVirtualBlkIdx)
+{
+    if(_vctVirtualBlkFd[nVirtualBlkIdx] == -1)
+    {
+        std::string strPath = virtualNANDBlockPath(nVirtualBlkIdx);
+        int         nFd     = open(strPath.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat stStat;
+
+        if(nFd == -1 || fstat(nFd, &stStat) != 0)
+        {
+            NV_ERROR("open fail for NAND plane data : " + strPath);
+            return -1;
+        }
+
+        // a sparse file reads back as erased ('0') pages, just like a new mapped file.
+        off_t nVirtualBlkSize = NAND_BLOCK_SIZE(_stDevConfig) * NAND_VIRTUAL_BLOCK_IDX_RESOLUTION;
+        if(stStat.st_size < nVirtualBlkSize && ftruncate(nFd, nVirtualBlkSize) != 0)
+        {
+            NV_ERROR("cannot resize NAND plane data : " + strPath);
+        }
+        _vctVirtualBlkFd[nVirtualBlkIdx] = nFd;
+    }
+    return _vctVirtualBlkFd[nVirtualBlkIdx];
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    submitIo
+// FullName:  Plane::submitIo
+// Access:    private 
+// Returns:   NV_RET
+// Parameter: UINT32 nVirtualBlkIdx
+// Parameter: size_t nOffset
+// Parameter: UINT8 * pBuf
+// Parameter: size_t nBytes
+// Parameter: bool bWrite
+//
+// Descriptions -
+// Issue an array access without waiting for it. A plane has a single cache
+// register, so the previous access is retired first; this keeps the file
+// and the register consistent while different planes and dies overlap their
+// host I/O with simulated array time. If the request cannot be queued, it 
+// falls back to a synchronous access.
+//////////////////////////////////////////////////////////////////////////////
+NV_RET Plane::submitIo( UINT32 nVirtualBlkIdx, size_t nOffset, UINT8 *pBuf, size_t nBytes, bool bWrite )
+{
+    NV_RET  nRet    = WaitIo();
+    int     nFd     = openVirtualNANDBlock(nVirtualBlkIdx);
+    if(nFd == -1)
+    {
+        return nRet | NAND_PLANE_ERROR_STORAGE;
+    }
+
+    memset(&_stPendingIo, 0x0, sizeof(_stPendingIo));
+    _stPendingIo.aio_fildes = nFd;
+    _stPendingIo.aio_offset = nOffset;
+    _stPendingIo.aio_buf    = pBuf;
+    _stPendingIo.aio_nbytes = nBytes;
+
+    if(((bWrite) ? aio_write(&_stPendingIo) : aio_read(&_stPendingIo)) == 0)
+    {
+        _bIoPending = true;
+    }
+    else
+    {
+        nRet |= syncIo(nVirtualBlkIdx, nOffset, pBuf, nBytes, bWrite);
+    }
+    return nRet;
+}
+
+NV_RET Plane::syncIo( UINT32 nVirtualBlkIdx, size_t nOffset, UINT8 *pBuf, size_t nBytes, bool bWrite )
+{
+    int     nFd     = openVirtualNANDBlock(nVirtualBlkIdx);
+    ssize_t nDone   = -1;
+    if(nFd != -1)
+    {
+        nDone = (bWrite) ? pwrite(nFd, pBuf, nBytes, nOffset) : pread(nFd, pBuf, nBytes, nOffset);
+    }
+
+    if(nDone != (ssize_t)nBytes)
+    {
+        NV_ERROR("I/O fail for NAND plane data : PLID" << _nId << "_VND" << nVirtualBlkIdx);
+        return NAND_PLANE_ERROR_STORAGE;
+    }
+    return NAND_SUCCESS;
 }
+#endif
 
-}
\ No newline at end of file
+#ifdef COMPRESSED_STORAGE
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    loadCompressedPage
+// FullName:  Plane::loadCompressedPage
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nPgIdx
+// Parameter: UINT8 * pPage
+//
+// Descriptions -
+// It decompresses a full page (data and spare) into pPage. A page which has never
+// been stored is the erased page.
+//////////////////////////////////////////////////////////////////////////////
+void Plane::loadCompressedPage( UINT32 nPgIdx, UINT8 *pPage )
+{
+    std::map< UINT32, std::vector<UINT8> >::iterator iPage = _mapCompressedPg.find(nPgIdx);
+    if(iPage == _mapCompressedPg.end())
+    {
+        memset(pPage, 0x0, NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+    else if(iPage->second.size() == NAND_FULL_PAGE_SIZE(_stDevConfig))
+    {
+        // incompressible page kept as it is.
+        memcpy(pPage, &iPage->second[0], NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+    else if(tool::LzDecompress(&iPage->second[0], iPage->second.size(), pPage, NAND_FULL_PAGE_SIZE(_stDevConfig)) == false)
+    {
+        NV_ERROR("Broken compressed page : PLID" << _nId << "_PG" << nPgIdx);
+        memset(pPage, 0x0, NAND_FULL_PAGE_SIZE(_stDevConfig));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    storeCompressedPage
+// FullName:  Plane::storeCompressedPage
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nPgIdx
+// Parameter: UINT8 * pPage
+//
+// Descriptions -
+// It compresses a full page and keeps it. An all-zero page is not kept at all,
+// and a page which does not shrink is kept without compression.
+//////////////////////////////////////////////////////////////////////////////
+void Plane::storeCompressedPage( UINT32 nPgIdx, UINT8 *pPage )
+{
+    UINT32  nPgSize = NAND_FULL_PAGE_SIZE(_stDevConfig);
+    UINT32  nOff    = 0;
+    while(nOff < nPgSize && pPage[nOff] == 0x0)
+    {
+        nOff++;
+    }
+    if(nOff == nPgSize)
+    {
+        _mapCompressedPg.erase(nPgIdx);
+        return;
+    }
+
+    std::vector<UINT8> vctCompressed;
+    tool::LzCompress(pPage, nPgSize, vctCompressed);
+    if(vctCompressed.size() >= nPgSize)
+    {
+        vctCompressed.assign(pPage, pPage + nPgSize);
+    }
+    _mapCompressedPg[nPgIdx].swap(vctCompressed);
+}
+
+//////////////////////////////////////////////////////////////////////////////// 
+//
+// Method:    eraseCompressedPages
+// FullName:  Plane::eraseCompressedPages
+// Access:    private 
+// Returns:   void
+// Parameter: UINT32 nFirstPgIdx
+// Parameter: UINT32 nNumsPg
+//
+// Descriptions -
+// It drops the pages in [nFirstPgIdx, nFirstPgIdx + nNumsPg).
+//////////////////////////////////////////////////////////////////////////////
+void Plane::eraseCompressedPages( UINT32 nFirstPgIdx, UINT32 nNumsPg )
+{
+    _mapCompressedPg.erase(_mapCompressedPg.lower_bound(nFirstPgIdx), _mapCompressedPg.lower_bound(nFirstPgIdx + nNumsPg));
+}
+#endif
+
+}
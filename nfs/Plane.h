@@ -38,16 +38,39 @@
 
 #include "boost/shared_array.hpp"
 #ifndef NO_STORAGE
+#if defined(ASYNC_STORAGE) && defined(COMPRESSED_STORAGE)
+#error "ASYNC_STORAGE and COMPRESSED_STORAGE are exclusive"
+#endif
+#if defined(ASYNC_STORAGE)
+#include <aio.h>
+#elif !defined(COMPRESSED_STORAGE)
 #include "boost/iostreams/device/mapped_file.hpp"
 #endif
+#endif
 
 namespace NANDFlashSim {
 
+class NandCheckpoint;
+
 class Plane {
     typedef     boost::shared_array<UINT8>          PNOP_PGS;
 #ifndef NO_STORAGE 
+#ifdef ASYNC_STORAGE
+    // out-of-core mode: virtual blocks are accessed through file descriptors and
+    // array accesses are issued asynchronously. One request is in flight per plane.
+    std::vector < int >                 _vctVirtualBlkFd;
+    struct aiocb                        _stPendingIo;
+    bool                                _bIoPending;
+    PNOP_PGS                            _saZeroBlk;
+#elif defined(COMPRESSED_STORAGE)
+    // in-memory mode: written pages are kept compressed (page index in plane -> stream).
+    // A page which is not in the map is erased.
+    std::map < UINT32, std::vector<UINT8> > _mapCompressedPg;
+    std::vector < UINT8 >               _vctPgBuf;
+#else
     typedef     boost::iostreams::mapped_file       VIRTUABLK_FILE;    
     std::vector < VIRTUABLK_FILE >      _vctVirtualBlk;
+#endif
 #endif
     std::vector < UINT8 * >             _vctpVirtualBlk;
     NandDeviceConfig                    _stDevConfig;
@@ -55,10 +78,15 @@ class Plane {
     std::vector<PNOP_PGS>               _vctsaNopPgInfo;
     std::vector<UINT32>                 _vctLppBlkInfo; // last programmed page offset
     std::vector<UINT32>                 _vctEcBlkInfo;
+    std::vector<UINT32>                 _vctReadCntBlkInfo;     // reads since the last erase (read disturb)
+    std::vector<UINT64>                 _vctProgTimeBlkInfo;    // time of the last program, NULL_SIG if erased
+    std::vector<UINT8>                  _vctModeBlkInfo;        // NAND_BLOCK_MODE of each block
+    std::vector<UINT8>                  _vctStalePgInfo;        // the page is deallocated (TRIM) since its program, one per page
 
     UINT32                              _nStatNopViolation;
     UINT32                              _nStateDataCorruption;
     UINT32                              _nStatWearout;
+    UINT64                              _nStatStaleReads;
 
 public :
     Plane(NandDeviceConfig &stDevConfig);
@@ -67,12 +95,37 @@ public :
     NV_RET  Write(UINT16 nCol, UINT32 nRow, UINT8 *pData);
     NV_RET  Read(UINT16 nCol, UINT32 nRow, UINT8 *pData);
     NV_RET  Erase(UINT32 nRow);
+    NV_RET  Precondition(UINT16 nPbn, UINT32 nProgrammedPgs, UINT32 nEc, UINT8 *pSignature);
+    NV_RET  WaitIo();
     UINT32  ID() const { return _nId; }
     void    ID(UINT32 val) { _nId = val; }
+    UINT32  EraseCount(UINT16 nPbn) const { return _vctEcBlkInfo[nPbn]; }
+    UINT32  ReadCount(UINT16 nPbn) const { return _vctReadCntBlkInfo[nPbn]; }
+    UINT64  ProgramTime(UINT16 nPbn) const { return _vctProgTimeBlkInfo[nPbn]; }
+    void    ProgramTime(UINT16 nPbn, UINT64 nTime) { _vctProgTimeBlkInfo[nPbn] = nTime; }
+    NAND_BLOCK_MODE BlockMode(UINT16 nPbn) const { return (NAND_BLOCK_MODE)_vctModeBlkInfo[nPbn]; }
+    NV_RET  BlockMode(UINT16 nPbn, NAND_BLOCK_MODE eMode);
+    UINT32  UsablePages(UINT16 nPbn) const { return (_vctModeBlkInfo[nPbn] == NAND_BLOCK_SLC) ? _stDevConfig._nNumsSlcPgPerBlk : _stDevConfig._nNumsPgPerBlk; }
+    NV_RET  Deallocate(UINT16 nPbn, UINT32 nPgoff);
+    bool    IsStale(UINT16 nPbn, UINT32 nPgoff) const { return _vctStalePgInfo[nPbn * _stDevConfig._nNumsPgPerBlk + nPgoff] != 0; }
+    UINT64  StaleReadCount() const { return _nStatStaleReads; }
     void    HardReset(NandDeviceConfig &stDevConfig);
+    void    Save(NandCheckpoint &ckpt);
+    void    Restore(NandCheckpoint &ckpt);
 
 private :
+    std::string virtualNANDBlockPath(UINT32 nVirtualBlkIdx);
     UINT8*  allocateVirtualNANDBlock(UINT32 nVirtualBlkIdx);
+#ifdef ASYNC_STORAGE
+    int     openVirtualNANDBlock(UINT32 nVirtualBlkIdx);
+    NV_RET  submitIo(UINT32 nVirtualBlkIdx, size_t nOffset, UINT8 *pBuf, size_t nBytes, bool bWrite);
+    NV_RET  syncIo(UINT32 nVirtualBlkIdx, size_t nOffset, UINT8 *pBuf, size_t nBytes, bool bWrite);
+#endif
+#ifdef COMPRESSED_STORAGE
+    void    loadCompressedPage(UINT32 nPgIdx, UINT8 *pPage);
+    void    storeCompressedPage(UINT32 nPgIdx, UINT8 *pPage);
+    void    eraseCompressedPages(UINT32 nFirstPgIdx, UINT32 nNumsPg);
+#endif
     void    resetPhysicalPlane();
 };
 
@@ -46,8 +46,10 @@
 #include "NandStageBuilderTool.h"
 #include "NandController.h"
 #include "NandFlashSystem.h"
+#include "NandFtl.h"
 
 #include <string>
+#include <cstdlib>
 
 #include "boost/program_options.hpp"
 
@@ -91,6 +93,69 @@ void MultiDieTest(TESTUNIT_OP nTuOp, UINT32 nNumsBlocks, UINT32 nTransferSizeUni
 void MultiDieSequentialAccessTest(UINT32 nNumsBlocks, UINT32 nTransferSizeUnit, NandFlashSystem &flash, NandDeviceConfig &stDevConfig);
 void SingleDieTests( NandFlashSystem &flash, NandDeviceConfig stDevConfig );
 void MultiDieTests( NandFlashSystem &flash, NandDeviceConfig stDevConfig );
+UINT64 SubPageRead( NandFlashSystem &flash, NAND_TRANS_OP nTransOp, UINT32 nAddr, UINT32 nByteOff, UINT32 nNumsByte, UINT32 nNumsTrans );
+bool SubPageReadTest( void );
+
+/************************************************************************/
+/* FTL exerciser                                                        */
+/************************************************************************/
+#define FTL_HOST_QUEUE_DEPTH    (32)
+
+// a host of NandFtl which keeps up to FTL_HOST_QUEUE_DEPTH requests outstanding, each in its own page slot.
+// The v-th write of a logical page carries a pattern of (lpn, v), so that a read is checked against 
+// the version written last before it.
+class FtlHost {
+    struct HostSlot {
+        NAND_FTL_OP     _nOp;
+        UINT32          _nLpn;
+        UINT32          _nVersion;
+    };
+
+    CallbackRepository<FtlHost, void, UINT32, UINT64, UINT64> _callback;
+    NandFtl                     _ftl;
+    UINT32                      _nPgSize;
+    std::vector<UINT32>         _vctVersion;        // version of each logical page, 0 if it reads as zero
+    std::vector<HostSlot>       _vctSlots;
+    std::vector<UINT8>          _vctData;
+    std::vector<UINT8>          _vctExpected;
+    std::list<UINT32>           _lstFreeSlots;
+    UINT64                      _nReqs;
+    UINT64                      _nLatency;
+    UINT64                      _nChecked;
+    UINT64                      _nMismatched;
+
+public :
+    FtlHost( NandDeviceConfig &stDevConfig );
+    void        Write( UINT32 nLpn );
+    void        Read( UINT32 nLpn );
+    void        Trim( UINT32 nLpn, UINT32 nNumsPage );
+    void        Drain( void );
+    void        Sync( void );
+    void        Complete( UINT32 nHostReqId, UINT64 nArrivalTime, UINT64 nCompletionTime );
+    void        ReportStatistics( void );
+    UINT64      CheckMapping( void );
+    UINT64      GetMismatched( void )   { return _nMismatched; }
+    NandFtl     &Ftl( void )            { return _ftl; }
+
+private :
+    UINT32      takeSlot( void );
+    void        pattern( UINT8 *pData, UINT32 nLpn, UINT32 nVersion );
+};
+
+// a case of the FTL exerciser : up to two device parameters over-set for the case (INI_DEVICE_MAX if unused), 
+// and the statistic of NandFtl which the case has to move (NULL if none).
+struct FtlCase {
+    const char          *szCase;
+    INI_DEVICE_VALUE    eParams[2];
+    UINT32              nValues[2];
+    UINT64              (NandFtl::*pCounter)( void );
+    const char          *szCounter;
+};
+
+UINT32 OverSetParam( INI_DEVICE_VALUE eValue, UINT32 nValue );
+void FtlWorkload( FtlHost &host, UINT32 nNumsOp, UINT32 nHotLpns, UINT32 nHotPercent );
+bool FtlTest( FtlCase &stCase, NandDeviceConfig &stDevConfig, UINT32 nPasses );
+bool FtlTests( NandDeviceConfig &stDevConfig, UINT32 nPasses );
 
 
 
@@ -151,8 +216,14 @@ int main(int argc, char* argv[])
         ("variation", po::value<UINT32>(), "Choose variation generator model")
         ;
 
+    po::options_description odFtl("FTL options");
+    odFtl.add_options()
+        ("ftl", po::value<UINT32>(), "Exercise NandFtl by host workloads instead of the flash memory tests (1 or 0). A few blocks and pages keep it short (e.g. --blocks 32 --pages 16).")
+        ("ftlpasses", po::value<UINT32>()->default_value(2), "Host operations of each FTL workload, in times of the logical pages")
+        ;
+
     po::options_description desc("NANDFlashSim v1.0 Parameter description");
-    desc.add(odIni).add(odTime).add(odSys).add(odEnv);
+    desc.add(odIni).add(odTime).add(odSys).add(odEnv).add(odFtl);
 
     po::variables_map vm;
     try
@@ -221,6 +292,20 @@ int main(int argc, char* argv[])
     
     NandDeviceConfig stDevConfig;
     NANDFlashSim::tool::LoadDeviceConfig(stDevConfig);
+    if(vm.count("ftl") && vm["ftl"].as<UINT32>() != 0)
+    {
+        // NandFtl builds its own flash memory system.
+        try
+        {
+            return FtlTests(stDevConfig, vm["ftlpasses"].as<UINT32>()) ? 0 : 1;
+        }
+        catch (std::string strExption)
+        {
+            std::cout << strExption << std::endl;
+        }
+        return 1;
+    }
+
     NandFlashSystem     flash(0, stDevConfig);
     
     flash.ReportConfiguration();
@@ -243,6 +328,10 @@ int main(int argc, char* argv[])
         MultiDieTests(flash, stDevConfig);
         MultiDieSequentialAccessTest(8, 64, flash, stDevConfig);
 
+        if(!SubPageReadTest())
+        {
+            return 1;
+        }
     }
     catch (std::string strExption)
     {
@@ -261,14 +350,11 @@ void SingleDieSequentialAccessTest(UINT32 nNumsBlocks, UINT32 nTransferSizeUnit,
         if(nTuOp != TESTUNIT_OP_COPYBACK)
         {
             std::cout << "********************************************************" << std::endl;
-            if(nTuOp != TESTUNIT_OP_NX_CACHE)
-            {
-                // read case
-                std::cout << "Unit Test Operation Type [READ]: " << nTuOp << std::endl;
-                BasicPagebasedOpTest((TESTUNIT_OP)nTuOp , flash, 0, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, false);
-                flash.ReportStatistics();
-                flash.HardReset(0, stDevConfig);
-            }
+            // read case
+            std::cout << "Unit Test Operation Type [READ]: " << nTuOp << std::endl;
+            BasicPagebasedOpTest((TESTUNIT_OP)nTuOp , flash, 0, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, false);
+            flash.ReportStatistics();
+            flash.HardReset(0, stDevConfig);
 
             std::cout << "Unit Test Operation Type [WRITE]: " << nTuOp << std::endl;
             BasicPagebasedOpTest((TESTUNIT_OP)nTuOp , flash, 0, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, true);
@@ -324,14 +410,11 @@ void MultiDieSequentialAccessTest(UINT32 nNumsBlocks, UINT32 nTransferSizeUnit,
         if(nTuOp != TESTUNIT_OP_COPYBACK)
         {
             std::cout << "********************************************************" << std::endl;
-            if(nTuOp != TESTUNIT_OP_NX_CACHE)
-            {
-                // read case
-                std::cout << "Unit Test Operation Type [READ]: " << nTuOp << std::endl;
-                DieInterleavedOpTest((TESTUNIT_OP)nTuOp , flash, stDevConfig._nNumsDie, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, false);
-                flash.ReportStatistics();
-                flash.HardReset(0, stDevConfig);
-            }
+            // read case
+            std::cout << "Unit Test Operation Type [READ]: " << nTuOp << std::endl;
+            DieInterleavedOpTest((TESTUNIT_OP)nTuOp , flash, stDevConfig._nNumsDie, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, false);
+            flash.ReportStatistics();
+            flash.HardReset(0, stDevConfig);
 
             std::cout << "Unit Test Operation Type [WRITE]: " << nTuOp << std::endl;
             DieInterleavedOpTest((TESTUNIT_OP)nTuOp , flash, stDevConfig._nNumsDie, nNumsBlocks, stDevConfig._nNumsPgPerBlk, nTransferSizeUnit, true);
@@ -456,7 +539,15 @@ void BasicPagebasedOpTest( TESTUNIT_OP tuOp, NandFlashSystem &flash, UINT16 nDie
                 // use auto plane addressing mode
                 if(!bWrite)
                 {
-                    throw "No support for read cache mode";
+                    for(UINT32 nIdx = 0; nIdx < nTransferPageSize; nIdx++)
+                    {
+                        // build translations for each planes
+                        for(UINT16 nPlane = 0; nPlane < stDevConfig._nNumsPlane; nPlane++)
+                        {
+                            nRet = flash.AddTransaction(NULL_SIG(UINT32), NAND_OP_READ_MULTIPLANE_CACHE, BUILD_PHYSICAL_ADDR(nDie, 0, nIterBlk, nIterPage + nIdx, stDevConfig));
+                            if(!CheckReturnValue(nRet)) continue;
+                        }
+                    }
                 }
                 else
                 {
@@ -536,6 +627,7 @@ bool CheckReturnValue( NV_RET nRet )
             strException += " Unsupported";
     }
     if(nMajorCode & NAND_PLANE)   strException += " Plane";
+    if(nMajorCode & NAND_FTL)   strException += " FTL";
 
     throw strException;
     return false;
@@ -630,7 +722,18 @@ void DieInterleavedOpTest(TESTUNIT_OP tuOp, NandFlashSystem &flash, UINT16 nNums
                 // use plane auto addressing mode
                 if(!bWrite)
                 {
-                    throw "No support for read cache mode";
+                    for(UINT32 nIdx = 0; nIdx < nTransferPageSize; nIdx++)
+                    {
+                        for(UINT16 nDie = 0; nDie < nNumsDie; nDie++)
+                        {
+                            // all planes of a die read the same page in cache mode.
+                            for(UINT16 nPlane = 0; nPlane < stDevConfig._nNumsPlane; nPlane++)
+                            {
+                                nRet = flash.AddTransaction(NULL_SIG(UINT32), NAND_OP_READ_MULTIPLANE_CACHE, BUILD_PHYSICAL_ADDR(nDie, 0, nIterBlk, nIterPage + nIdx, stDevConfig));
+                                if(!CheckReturnValue(nRet)) continue;
+                            }
+                        }
+                    }
                 }
                 else
                 {
@@ -674,3 +777,379 @@ void DieInterleavedOpTest(TESTUNIT_OP tuOp, NandFlashSystem &flash, UINT16 nNums
     }
 }
 
+
+// issue nNumsTrans transactions of the same address (one for each plane of a multi-plane read), and return 
+// the cycles until the die is idle again.
+UINT64 SubPageRead( NandFlashSystem &flash, NAND_TRANS_OP nTransOp, UINT32 nAddr, UINT32 nByteOff, UINT32 nNumsByte, UINT32 nNumsTrans )
+{
+    for(UINT32 nTrans = 0; nTrans < nNumsTrans; nTrans++)
+    {
+        CheckReturnValue(flash.AddTransaction(NULL_SIG(UINT32), nTransOp, nAddr, nByteOff, nNumsByte));
+    }
+
+    UINT64 nCycles = 0;
+    while(flash.IsActiveMode())
+    {
+        nCycles += flash.UpdateWithoutIdleCycles();
+    }
+    return nCycles;
+}
+
+// A 4 KB read of a 16 KB page carries out only 4 KB (TOR), and random reads change the column 
+// of a sensed page without tR. The TOR cycles of a 4 KB chunk are the difference of an 8 KB and a 4 KB read,
+// so that the full page read must take the TOR of the rest of the page (spare area included) more.
+bool SubPageReadTest( void )
+{
+    const UINT32        nChunk  = 4096;
+    UINT32              nFormer = OverSetParam(ISV_NUMS_PGSIZE, 4 * nChunk);
+    NandDeviceConfig    stSubConfig;
+    NANDFlashSim::tool::LoadDeviceConfig(stSubConfig);
+    OverSetParam(ISV_NUMS_PGSIZE, nFormer);
+
+    NandFlashSystem     flash(0, stSubConfig);
+    UINT64  nFull       = SubPageRead(flash, NAND_OP_READ, BUILD_PHYSICAL_ADDR(0, 0, 0, 0, stSubConfig), 0, NAND_FULL_PAGE_SIZE(stSubConfig), 1);
+    UINT64  nSub        = SubPageRead(flash, NAND_OP_READ, BUILD_PHYSICAL_ADDR(0, 0, 0, 1, stSubConfig), nChunk, nChunk, 1);
+    UINT64  nSub2       = SubPageRead(flash, NAND_OP_READ, BUILD_PHYSICAL_ADDR(0, 0, 0, 2, stSubConfig), nChunk, 2 * nChunk, 1);
+    UINT64  nChunkTor   = nSub2 - nSub;
+    UINT64  nSaved      = nFull - nSub;
+    UINT64  nRestTor    = nChunkTor * (NAND_FULL_PAGE_SIZE(stSubConfig) - nChunk) / nChunk;
+
+    UINT64  nSensed     = SubPageRead(flash, NAND_OP_READ_RANDOM, BUILD_PHYSICAL_ADDR(0, 0, 0, 3, stSubConfig), 0, nChunk, 1);
+    UINT64  nColumn     = SubPageRead(flash, NAND_OP_READ_RANDOM, BUILD_PHYSICAL_ADDR(0, 0, 0, 3, stSubConfig), 2 * nChunk, nChunk, 1);
+
+    UINT64  nNxSensed   = 0;
+    UINT64  nNxColumn   = 0;
+    if(stSubConfig._nNumsPlane > 1)
+    {
+        nNxSensed       = SubPageRead(flash, NAND_OP_READ_MULTIPLANE_RANDOM, BUILD_PHYSICAL_ADDR(0, 0, 0, 4, stSubConfig), 0, nChunk, stSubConfig._nNumsPlane);
+        nNxColumn       = SubPageRead(flash, NAND_OP_READ_MULTIPLANE_RANDOM, BUILD_PHYSICAL_ADDR(0, 1, 0, 4, stSubConfig), 2 * nChunk, nChunk, 1);
+    }
+
+    std::cout << "********************************************************" << std::endl;
+    std::cout << "Sub-page Read Test [" << stSubConfig._nPgSize << "+" << stSubConfig._nSpareSize << " byte page, " << nChunk << " byte chunk]" << std::endl;
+    std::cout << "Full page read (cycles)                      :" << std::dec << nFull << std::endl;
+    std::cout << "Sub-page read of a chunk (cycles)            :" << nSub << std::endl;
+    std::cout << "TOR of a chunk (cycles)                      :" << nChunkTor << std::endl;
+    std::cout << "TOR saved by the sub-page read (cycles)      :" << nSaved << " (the rest of the page: " << nRestTor << ")" << std::endl;
+    std::cout << "Random read, sensed / column change (cycles) :" << nSensed << " / " << nColumn << std::endl;
+    if(stSubConfig._nNumsPlane > 1)
+    {
+        std::cout << "Multi-plane random read, sensed / column change (cycles) :" << nNxSensed << " / " << nNxColumn << std::endl;
+    }
+
+    // each UpdateWithoutIdleCycles() rounds up to a clock period.
+    const UINT64 nTolerance = 8;
+    const UINT64 nTr        = NFS_GET_PARAM(ITV_tR) / NFS_GET_PARAM(ISV_CLOCK_PERIODS);
+    bool    bPassed         = true;
+    if(nSaved + nTolerance < nRestTor || nRestTor + nTolerance < nSaved)
+    {
+        std::cout << "ERROR: the sub-page read does not carry out only the chunk" << std::endl;
+        bPassed = false;
+    }
+    if(nColumn + nTr > nSensed + nTolerance || 
+       (stSubConfig._nNumsPlane > 1 && nNxColumn + nTr > nNxSensed + nTolerance))
+    {
+        std::cout << "ERROR: the column change of a random read senses the page again" << std::endl;
+        bPassed = false;
+    }
+    return bPassed;
+}
+
+
+FtlHost::FtlHost( NandDeviceConfig &stDevConfig ) :
+            _callback(this, &FtlHost::Complete),
+            _ftl(0, stDevConfig, &_callback)
+{
+    _nPgSize        = stDevConfig._nPgSize;
+    _vctVersion.assign(_ftl.GetNumsLogicalPages(), 0);
+    _vctSlots.resize(FTL_HOST_QUEUE_DEPTH);
+    _vctData.assign((UINT64)FTL_HOST_QUEUE_DEPTH * _nPgSize, 0);
+    _vctExpected.assign(_nPgSize, 0);
+    for(UINT32 nSlot = 0; nSlot < FTL_HOST_QUEUE_DEPTH; nSlot++)
+    {
+        _lstFreeSlots.push_back(nSlot);
+    }
+    _nReqs          = 0;
+    _nLatency       = 0;
+    _nChecked       = 0;
+    _nMismatched    = 0;
+}
+
+void FtlHost::Write( UINT32 nLpn )
+{
+    UINT32 nSlot                = takeSlot();
+    _vctSlots[nSlot]._nOp       = NAND_FTL_WRITE;
+    _vctSlots[nSlot]._nLpn      = nLpn;
+    _vctSlots[nSlot]._nVersion  = ++_vctVersion[nLpn];
+    pattern(&_vctData[(UINT64)nSlot * _nPgSize], nLpn, _vctVersion[nLpn]);
+    CheckReturnValue(_ftl.Write(nSlot, nLpn, 1, &_vctData[(UINT64)nSlot * _nPgSize]));
+}
+
+void FtlHost::Read( UINT32 nLpn )
+{
+    // NandFtl never lets a read bypass a former write of the same page, nor a later write bypass the read.
+    UINT32 nSlot                = takeSlot();
+    _vctSlots[nSlot]._nOp       = NAND_FTL_READ;
+    _vctSlots[nSlot]._nLpn      = nLpn;
+    _vctSlots[nSlot]._nVersion  = _vctVersion[nLpn];
+    CheckReturnValue(_ftl.Read(nSlot, nLpn, 1, &_vctData[(UINT64)nSlot * _nPgSize]));
+}
+
+// trimmed pages read as zero.
+void FtlHost::Trim( UINT32 nLpn, UINT32 nNumsPage )
+{
+    UINT32 nSlot                = takeSlot();
+    _vctSlots[nSlot]._nOp       = NAND_FTL_TRIM;
+    _vctSlots[nSlot]._nLpn      = nLpn;
+    _vctSlots[nSlot]._nVersion  = 0;
+    for(UINT32 nIdx = 0; nIdx < nNumsPage; nIdx++)
+    {
+        _vctVersion[nLpn + nIdx] = 0;
+    }
+    CheckReturnValue(_ftl.Trim(nSlot, nLpn, nNumsPage));
+}
+
+void FtlHost::Drain( void )
+{
+    while(_ftl.IsActiveMode())
+    {
+        _ftl.UpdateWithoutIdleCycles();
+    }
+}
+
+// wait for the outstanding host requests only.
+void FtlHost::Sync( void )
+{
+    while(_lstFreeSlots.size() < FTL_HOST_QUEUE_DEPTH)
+    {
+        _ftl.UpdateWithoutIdleCycles();
+    }
+}
+
+void FtlHost::Complete( UINT32 nHostReqId, UINT64 nArrivalTime, UINT64 nCompletionTime )
+{
+    _nReqs++;
+    _nLatency += nCompletionTime - nArrivalTime;
+#ifndef NO_STORAGE
+    // the data can be checked only if the planes store it.
+    HostSlot &stSlot = _vctSlots[nHostReqId];
+    if(stSlot._nOp == NAND_FTL_READ)
+    {
+        pattern(&_vctExpected[0], stSlot._nLpn, stSlot._nVersion);
+        if(memcmp(&_vctData[(UINT64)nHostReqId * _nPgSize], &_vctExpected[0], _nPgSize) != 0)
+        {
+            _nMismatched++;
+        }
+        _nChecked++;
+    }
+#endif
+    _lstFreeSlots.push_back(nHostReqId);
+}
+
+void FtlHost::ReportStatistics( void )
+{
+    std::cout << "Host requests                                :" << std::dec << _nReqs << std::endl;
+    std::cout << "Host average latency (ns)                    :" << ((_nReqs != 0) ? _nLatency / _nReqs : 0) << std::endl;
+#ifndef NO_STORAGE
+    std::cout << "Integrity check (read pages / mismatched)    :" << _nChecked << " / " << _nMismatched << std::endl;
+#else
+    std::cout << "Integrity check                              :skipped (NO_STORAGE)" << std::endl;
+#endif
+    _ftl.ReportStatistics();
+}
+
+// every logical page written and not trimmed since is mapped to a page of its own, and no other is.
+// It holds without the data stored in the planes as well.
+UINT64 FtlHost::CheckMapping( void )
+{
+    std::set<UINT32>    setPhysical;
+    UINT64              nMapped = 0;
+    UINT64              nFaults = 0;
+    for(UINT32 nLpn = 0; nLpn < _vctVersion.size(); nLpn++)
+    {
+        UINT32 nAddr = _ftl.GetPhysicalAddr(nLpn);
+        if((nAddr != NULL_SIG(UINT32)) != (_vctVersion[nLpn] != 0))
+        {
+            nFaults++;
+        }
+        else if(nAddr != NULL_SIG(UINT32))
+        {
+            nMapped++;
+            if(!setPhysical.insert(nAddr).second)
+            {
+                nFaults++;
+            }
+        }
+    }
+    std::cout << "Mapping check (mapped pages / faults)        :" << nMapped << " / " << nFaults << std::endl;
+    return nFaults;
+}
+
+UINT32 FtlHost::takeSlot( void )
+{
+    while(_lstFreeSlots.empty())
+    {
+        _ftl.UpdateWithoutIdleCycles();
+    }
+    UINT32 nSlot = _lstFreeSlots.front();
+    _lstFreeSlots.pop_front();
+    return nSlot;
+}
+
+void FtlHost::pattern( UINT8 *pData, UINT32 nLpn, UINT32 nVersion )
+{
+    UINT32 *pWord = (UINT32 *)pData;
+    for(UINT32 nIdx = 0; nIdx < _nPgSize / sizeof(UINT32); nIdx++)
+    {
+        pWord[nIdx] = (nVersion == 0) ? 0 : ((nLpn * 2654435761U) ^ (nVersion << 16) ^ nIdx);
+    }
+}
+
+// over-set a device parameter for an FTL case, and return the former value.
+UINT32 OverSetParam( INI_DEVICE_VALUE eValue, UINT32 nValue )
+{
+    UINT32 nFormer = NFS_GET_PARAM(eValue);
+    for(int i = 0; gParamTypes[i].szTypeIniName[0] != '\0'; i++)
+    {
+        if(gParamTypes[i].bIsEnv == FALSE && gParamTypes[i].eDeviceValue == eValue)
+        {
+            ParamManager::SetParam(eValue, i, nValue);
+            break;
+        }
+    }
+    return nFormer;
+}
+
+// nNumsOp host operations; three writes to a read, and a trim of up to four pages in 16 operations.
+// nHotPercent of them go to the first nHotLpns logical pages.
+// The host is idle after every quarter of the logical space, so that the FTL can do its idle time work.
+void FtlWorkload( FtlHost &host, UINT32 nNumsOp, UINT32 nHotLpns, UINT32 nHotPercent )
+{
+    UINT32 nNumsLpn = host.Ftl().GetNumsLogicalPages();
+    UINT32 nBurst   = (nNumsLpn >= 4) ? nNumsLpn / 4 : 1;
+    for(UINT32 nOp = 0; nOp < nNumsOp; nOp++)
+    {
+        if(nOp % nBurst == 0)
+        {
+            host.Drain();
+        }
+
+        UINT32 nLpn = ((UINT32)(rand() % 100) < nHotPercent) ? rand() % nHotLpns : rand() % nNumsLpn;
+        UINT32 nMix = rand() % 16;
+        if(nMix == 0)
+        {
+            UINT32 nNumsPage = 1 + rand() % 4;
+            host.Trim(nLpn, (nNumsLpn - nLpn < nNumsPage) ? nNumsLpn - nLpn : nNumsPage);
+        }
+        else if(nMix % 4 != 0)
+        {
+            host.Write(nLpn);
+        }
+        else
+        {
+            host.Read(nLpn);
+        }
+    }
+}
+
+// the case passes if no page reads back wrong, fails, or is mapped wrong in either workload, 
+// and its own statistic moves over them.
+bool FtlTest( FtlCase &stCase, NandDeviceConfig &stDevConfig, UINT32 nPasses )
+{
+    const char  *szWorkloads[] = { "random", "hot/cold" };
+    UINT32      nFormer[2];
+    UINT64      nCounter = 0;
+    bool        bPassed = true;
+    for(UINT32 nParam = 0; nParam < 2; nParam++)
+    {
+        if(stCase.eParams[nParam] != INI_DEVICE_MAX)
+        {
+            nFormer[nParam] = OverSetParam(stCase.eParams[nParam], stCase.nValues[nParam]);
+        }
+    }
+
+    for(UINT32 nWorkload = 0; nWorkload < 2; nWorkload++)
+    {
+        FtlHost host(stDevConfig);
+        UINT32  nNumsLpn    = host.Ftl().GetNumsLogicalPages();
+        UINT32  nHotLpns    = (nWorkload == 0 || nNumsLpn < 10) ? nNumsLpn : nNumsLpn / 10;
+
+        std::cout << "********************************************************" << std::endl;
+        std::cout << "FTL Test [" << stCase.szCase << "] workload : " << szWorkloads[nWorkload] << std::endl;
+        if(nWorkload == 0) host.Ftl().ReportConfiguration();
+
+        // the logical space is filled first, and then read back a page at a time once the workload is over.
+        srand(nWorkload + 1);
+        for(UINT32 nLpn = 0; nLpn < nNumsLpn; nLpn++)
+        {
+            host.Write(nLpn);
+        }
+        FtlWorkload(host, nPasses * nNumsLpn, nHotLpns, (nWorkload == 0) ? 0 : 90);
+        host.Drain();
+        for(UINT32 nLpn = 0; nLpn < nNumsLpn; nLpn++)
+        {
+            host.Read(nLpn);
+            host.Sync();
+        }
+        host.Drain();
+        host.ReportStatistics();
+
+        bool bWorkloadPassed = (host.CheckMapping() == 0 && host.GetMismatched() == 0 && host.Ftl().GetFailedPages() == 0);
+        if(stCase.pCounter != NULL)
+        {
+            nCounter += (host.Ftl().*stCase.pCounter)();
+        }
+        std::cout << "FTL Test [" << stCase.szCase << "] workload " << szWorkloads[nWorkload] << " : " << (bWorkloadPassed ? "PASSED" : "FAILED") << std::endl;
+        bPassed = bPassed && bWorkloadPassed;
+    }
+
+    if(stCase.pCounter != NULL)
+    {
+        std::cout << "FTL Test [" << stCase.szCase << "] " << stCase.szCounter << " : " << nCounter << std::endl;
+        if(nCounter == 0)
+        {
+            std::cout << "ERROR: the case never exercised its feature" << std::endl;
+            bPassed = false;
+        }
+    }
+
+    for(UINT32 nParam = 0; nParam < 2; nParam++)
+    {
+        if(stCase.eParams[nParam] != INI_DEVICE_MAX)
+        {
+            OverSetParam(stCase.eParams[nParam], nFormer[nParam]);
+        }
+    }
+    return bPassed;
+}
+
+bool FtlTests( NandDeviceConfig &stDevConfig, UINT32 nPasses )
+{
+    UINT32  nNumsPhysicalPgs = stDevConfig._nNumsBlk * stDevConfig._nNumsPgPerBlk * stDevConfig._nNumsPlane * stDevConfig._nNumsDie;
+    FtlCase vctCases[] = {
+        { "page mapping",           { INI_DEVICE_MAX, INI_DEVICE_MAX },     { 0, 0 },   NULL,                               "" },
+        { "cost-benefit GC",        { IFV_GC_POLICY, INI_DEVICE_MAX },      { 1, 0 },   &NandFtl::GetGcCopybackPages,       "GC copyback pages" },
+        // the hot/cold workload spreads the erase counts of the dies soon.
+        { "static wear leveling",   { IFV_WL_THRESHOLD, INI_DEVICE_MAX },   { 2, 0 },   &NandFtl::GetWlMigrations,          "WL migrations" },
+        // about an eighth of the page map is cached, so that most random pages miss it.
+        { "demand-paged mapping",   { IFV_MAP_CACHE_ENTRIES, INI_DEVICE_MAX }, { nNumsPhysicalPgs / 8, 0 }, &NandFtl::GetMapMisses, "map cache misses" },
+        // reads of the buffered pages are checked against the DRAM copy.
+        { "write buffer",           { IFV_WRITE_BUFFER_PAGES, INI_DEVICE_MAX }, { 64, 0 }, &NandFtl::GetBufferReadHits, "buffer read hits" },
+        // the read-back of the logical space is a sequential stream.
+        { "read-ahead",             { IFV_PREFETCH_PAGES, INI_DEVICE_MAX }, { 64, 0 },  &NandFtl::GetPrefetchHits,          "prefetch hits" },
+        { "superblock",             { IFV_SUPERBLOCK, INI_DEVICE_MAX },     { 1, 0 },   &NandFtl::GetSuperblocksOpened,     "superblocks opened" },
+        // the FTL tells hot pages from cold ones by their update counts.
+        { "write streams",          { IFV_WRITE_STREAMS, INI_DEVICE_MAX },  { 2, 0 },   &NandFtl::GetHotStreamPages,        "host pages of the hot streams" },
+        // the old pages of trimmed logical pages are marked stale in the planes as well.
+        { "stale trim",             { IFV_TRIM_STALE, INI_DEVICE_MAX },     { 1, 0 },   &NandFtl::GetTrimStalePages,        "flash pages marked stale" },
+        // GC victims wait in the pool for the idle time between the bursts of the workloads.
+        // A quarter of spare pages leaves room between the GC watermarks of a small device.
+        { "pre-erase",              { IFV_PRE_ERASE_TARGET, IFV_OVERPROVISION }, { 6, 25 }, &NandFtl::GetIdleErases,  "erases in idle windows" },
+    };
+    bool bPassed = true;
+    for(UINT32 nCase = 0; nCase < sizeof(vctCases) / sizeof(vctCases[0]); nCase++)
+    {
+        bPassed = FtlTest(vctCases[nCase], stDevConfig, nPasses) && bPassed;
+    }
+    return bPassed;
+}
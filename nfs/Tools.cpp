@@ -24,6 +24,7 @@
 #include "TypeSystem.h"
 #include "Tools.h"
 #include "ParamManager.h"
+#include <memory.h>
 
 namespace NANDFlashSim {
     namespace tool 
@@ -63,8 +64,10 @@ namespace NANDFlashSim {
             stDevConfig._nNumsDie       = NFS_GET_PARAM(ISV_NUMS_DIE);
             stDevConfig._nNumsIoPins    = NFS_GET_PARAM(ISV_NUMS_IOPINS);
             stDevConfig._nNumsPgPerBlk  = NFS_GET_PARAM(ISV_NUMS_PAGES);
+            stDevConfig._nNumsSlcPgPerBlk = NFS_GET_PARAM(IBV_SLC_NUMS_PAGES);
             stDevConfig._nNumsPlane     = NFS_GET_PARAM(ISV_NUMS_PLANE);
             stDevConfig._nPgSize        = NFS_GET_PARAM(ISV_NUMS_PGSIZE);
+            stDevConfig._nSpareSize     = NFS_GET_PARAM(ISV_NUMS_SPARESIZE);
 
             stDevConfig._bits._pgsize    = GetBits(stDevConfig._nPgSize);
             stDevConfig._bits._blk       = GetBits(stDevConfig._nNumsBlk);
@@ -73,6 +76,157 @@ namespace NANDFlashSim {
             stDevConfig._bits._plane     = GetBits(stDevConfig._nNumsPlane);
             stDevConfig._bits._lun       = GetBits(stDevConfig._nNumsLun);
         }
+
+        /************************************************************************/
+        /* LZ codec                                                             */
+        /************************************************************************/
+        // A compressed stream is a list of sequences. Each sequence has a token 
+        // (literal length in the high nibble, match length - LZ_MIN_MATCH in the low 
+        // nibble, 15 means that length bytes follow), literals, and a 16-bit match 
+        // offset. The last sequence only carries literals.
+        #define LZ_MIN_MATCH        (4)
+        #define LZ_HASH_BITS        (12)
+        #define LZ_MAX_OFFSET       (0xFFFF)
+
+        static inline UINT32 lzRead32(const UINT8 *p)
+        {
+            return (UINT32)p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+        }
+
+        static inline void lzPutLength(std::vector<UINT8> &vctDst, UINT32 nLen)
+        {
+            while(nLen >= 255)
+            {
+                vctDst.push_back(255);
+                nLen -= 255;
+            }
+            vctDst.push_back((UINT8)nLen);
+        }
+
+        static void lzPutSequence(std::vector<UINT8> &vctDst, const UINT8 *pLiteral, UINT32 nLiteralLen, UINT32 nOffset, UINT32 nMatchLen)
+        {
+            UINT32 nMatchCode = (nMatchLen != 0) ? nMatchLen - LZ_MIN_MATCH : 0;
+            vctDst.push_back((UINT8)(((nLiteralLen < 15) ? nLiteralLen : 15) << 4 | ((nMatchCode < 15) ? nMatchCode : 15)));
+            if(nLiteralLen >= 15)
+            {
+                lzPutLength(vctDst, nLiteralLen - 15);
+            }
+            vctDst.insert(vctDst.end(), pLiteral, pLiteral + nLiteralLen);
+
+            if(nMatchLen != 0)
+            {
+                vctDst.push_back((UINT8)(nOffset & 0xFF));
+                vctDst.push_back((UINT8)(nOffset >> 8));
+                if(nMatchCode >= 15)
+                {
+                    lzPutLength(vctDst, nMatchCode - 15);
+                }
+            }
+        }
+
+        void LzCompress(const UINT8 *pSrc, UINT32 nSrcLen, std::vector<UINT8> &vctDst)
+        {
+            UINT32  vctHash[1 << LZ_HASH_BITS];
+            UINT32  nPos    = 0;
+            UINT32  nAnchor = 0;
+
+            vctDst.clear();
+            memset(vctHash, 0xFF, sizeof(vctHash));
+
+            while(nPos + LZ_MIN_MATCH <= nSrcLen)
+            {
+                UINT32  nSeq    = lzRead32(pSrc + nPos);
+                UINT32  nHash   = (nSeq * 2654435761U) >> (32 - LZ_HASH_BITS);
+                UINT32  nRef    = vctHash[nHash];
+                vctHash[nHash]  = nPos;
+
+                if(nRef != NULL_SIG(UINT32) && nPos - nRef <= LZ_MAX_OFFSET && lzRead32(pSrc + nRef) == nSeq)
+                {
+                    UINT32 nMatchLen = LZ_MIN_MATCH;
+                    while(nPos + nMatchLen < nSrcLen && pSrc[nRef + nMatchLen] == pSrc[nPos + nMatchLen])
+                    {
+                        nMatchLen++;
+                    }
+
+                    lzPutSequence(vctDst, pSrc + nAnchor, nPos - nAnchor, nPos - nRef, nMatchLen);
+                    nPos    += nMatchLen;
+                    nAnchor = nPos;
+                }
+                else
+                {
+                    nPos++;
+                }
+            }
+            lzPutSequence(vctDst, pSrc + nAnchor, nSrcLen - nAnchor, 0, 0);
+        }
+
+        static inline bool lzGetLength(const UINT8 *pSrc, UINT32 nSrcLen, UINT32 &nIn, UINT32 &nLen)
+        {
+            UINT8 nByte;
+            do
+            {
+                if(nIn >= nSrcLen)
+                {
+                    return false;
+                }
+                nByte   = pSrc[nIn++];
+                nLen    += nByte;
+            } while(nByte == 255);
+            return true;
+        }
+
+        bool LzDecompress(const UINT8 *pSrc, UINT32 nSrcLen, UINT8 *pDst, UINT32 nDstLen)
+        {
+            UINT32  nIn     = 0;
+            UINT32  nOut    = 0;
+
+            while(nIn < nSrcLen)
+            {
+                UINT8   nToken      = pSrc[nIn++];
+                UINT32  nLiteralLen = nToken >> 4;
+                if(nLiteralLen == 15 && lzGetLength(pSrc, nSrcLen, nIn, nLiteralLen) == false)
+                {
+                    return false;
+                }
+                if(nLiteralLen > nSrcLen - nIn || nLiteralLen > nDstLen - nOut)
+                {
+                    return false;
+                }
+                memcpy(pDst + nOut, pSrc + nIn, nLiteralLen);
+                nIn     += nLiteralLen;
+                nOut    += nLiteralLen;
+
+                if(nIn == nSrcLen)
+                {
+                    // the last sequence
+                    break;
+                }
+
+                if(nIn + 2 > nSrcLen)
+                {
+                    return false;
+                }
+                UINT32  nOffset     = pSrc[nIn] | (pSrc[nIn + 1] << 8);
+                UINT32  nMatchLen   = nToken & 0xF;
+                nIn += 2;
+                if(nMatchLen == 15 && lzGetLength(pSrc, nSrcLen, nIn, nMatchLen) == false)
+                {
+                    return false;
+                }
+                nMatchLen += LZ_MIN_MATCH;
+
+                if(nOffset == 0 || nOffset > nOut || nMatchLen > nDstLen - nOut)
+                {
+                    return false;
+                }
+                // source and destination can overlap (e.g., runs), so copy byte by byte.
+                for(UINT32 nIdx = 0; nIdx < nMatchLen; nIdx++, nOut++)
+                {
+                    pDst[nOut] = pDst[nOut - nOffset];
+                }
+            }
+            return (nOut == nDstLen);
+        }
     }
 }
 
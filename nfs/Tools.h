@@ -36,6 +36,7 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <set>
 #include <iostream>
 #include <fstream>
 
@@ -46,5 +47,9 @@ namespace NANDFlashSim{
     namespace tool {
         unsigned short GetBits(unsigned int nNums);
         void LoadDeviceConfig(NandDeviceConfig  &stDevConfig);
+
+        // small LZ77 codec (byte-oriented, LZ4-like sequences) for the in-memory plane store.
+        void LzCompress(const UINT8 *pSrc, UINT32 nSrcLen, std::vector<UINT8> &vctDst);
+        bool LzDecompress(const UINT8 *pSrc, UINT32 nSrcLen, UINT8 *pDst, UINT32 nDstLen);
     }
 }
\ No newline at end of file
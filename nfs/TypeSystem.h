@@ -114,8 +114,11 @@ typedef UINT32                          NV_RET;
 
 
 // querying the page size from device configuration structure.
-#define         NAND_PLANE_SIZE(_stDevConfig)               (_stDevConfig._nPgSize * _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsBlk)
-#define         NAND_BLOCK_SIZE(_stDevConfig)               (_stDevConfig._nPgSize * _stDevConfig._nNumsPgPerBlk)
+// A physical page consists of the data area followed by the spare (OOB) area,
+// and the column address covers both of them.
+#define         NAND_FULL_PAGE_SIZE(_stDevConfig)           (_stDevConfig._nPgSize + _stDevConfig._nSpareSize)
+#define         NAND_PLANE_SIZE(_stDevConfig)               (NAND_FULL_PAGE_SIZE(_stDevConfig) * _stDevConfig._nNumsPgPerBlk * _stDevConfig._nNumsBlk)
+#define         NAND_BLOCK_SIZE(_stDevConfig)               (NAND_FULL_PAGE_SIZE(_stDevConfig) * _stDevConfig._nNumsPgPerBlk)
 
 // Parsing an address residing in the row address register fully depends on the bit configuration macro (BITS_XXX).
 // There is nothing for you to change this macro for parsing address registers.
@@ -132,7 +135,7 @@ typedef UINT32                          NV_RET;
 #define         NAND_COMPOSE_ROW_RIGSTER(_nDie, _nPlane, _nPbn, _nPpo)  (((ADDRESS_MASK(BITS_NAND_DIE_ADDR) & _nDie) << (BITS_NAND_PAGE_ADDR + BITS_NAND_PLANE_ADDR + BITS_NAND_BLOCK_ADDR)) |\
                                                                         ((ADDRESS_MASK(BITS_NAND_BLOCK_ADDR) & _nPbn) << (BITS_NAND_PAGE_ADDR + BITS_NAND_PLANE_ADDR)) |\
                                                                         ((ADDRESS_MASK(BITS_NAND_PLANE_ADDR) & _nPlane) << BITS_NAND_PAGE_ADDR) |\
-                                                                        ((1 << BITS_NAND_PAGE_ADDR) - 1) & _nPpo)
+                                                                        (((1 << BITS_NAND_PAGE_ADDR) - 1) & _nPpo))
 
 
 
@@ -163,6 +166,7 @@ typedef UINT32                          NV_RET;
 #define         NAND_FLASH_ERROR                    NV_RETURN_VAL(NAND_ERROR, NAND_FLASH,0x0)
 #define         NAND_FLASH_ERROR_BUSY               NV_RETURN_VAL(NAND_ERROR, NAND_FLASH,0x1)
 #define         NAND_FLASH_ERROR_UNSUPPORTED        NV_RETURN_VAL(NAND_ERROR, NAND_FLASH,0x2) 
+#define         NAND_FLASH_ERROR_CHECKPOINT         NV_RETURN_VAL(NAND_ERROR, NAND_FLASH,0x4)
 
 #define         NAND_PLANE                          (0x8)
 #define         NAND_PLANE_ERROR                    NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x0)
@@ -170,11 +174,42 @@ typedef UINT32                          NV_RET;
 #define         NAND_PLANE_ERROR_NOP_VIOLOATION     NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x2)
 #define         NAND_PLANE_ERROR_WEAROUT            NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x4)
 #define         NAND_PLANE_ERROR_INODRDER_VIOLATION NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x8)
+#define         NAND_PLANE_ERROR_STORAGE            NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x10)
+#define         NAND_PLANE_ERROR_BLOCK_MODE         NV_RETURN_VAL(NAND_ERROR, NAND_PLANE,0x20)
+
+#define         NAND_FTL                            (0x10)
+#define         NAND_FTL_ERROR                      NV_RETURN_VAL(NAND_ERROR, NAND_FTL,0x0)
+#define         NAND_FTL_ERROR_ADDRESS              NV_RETURN_VAL(NAND_ERROR, NAND_FTL,0x1)
 
 
 
 namespace NANDFlashSim {
 
+/************************************************************************/
+/* INTERFACE TYPE                                                       */
+/************************************************************************/
+
+// identifiers for the data interface (SYS.INTERFACE_MODE)
+typedef enum {
+    NAND_IF_SDR,                                // asynchronous, one transfer per tRC/tWC
+    NAND_IF_NVDDR,
+    NAND_IF_NVDDR2,
+    NAND_IF_NVDDR3,
+    NAND_IF_TOGGLE,
+    NAND_IF_MAX
+} NAND_INTERFACE;
+
+/************************************************************************/
+/* BLOCK MODE                                                           */
+/************************************************************************/
+
+// cell mode of a block. The mode is chosen while the block is erased and is kept over erases.
+typedef enum {
+    NAND_BLOCK_NATIVE,                          // all bits of a cell (MLC/TLC), device timing and pages
+    NAND_BLOCK_SLC,                             // one bit of a cell, SLC.* timing and SLC.NUMS_PAGES pages
+    NAND_BLOCK_MODE_MAX
+} NAND_BLOCK_MODE;
+
 /************************************************************************/
 /* IO TYPE                                                              */
 /************************************************************************/
@@ -195,6 +230,8 @@ typedef enum {
     NAND_OP_INTERNAL_DATAMOVEMENT_MULTIPLANE,
     NAND_OP_BLOCK_ERASE,
     NAND_OP_BLOCK_ERASE_MULTIPLANE,
+    NAND_OP_READ_SPARE,
+    NAND_OP_READ_MULTIPLANE_CACHE,
     NAND_OP_NOT_DETERMINED
 } NAND_TRANS_OP;
 
@@ -314,7 +351,7 @@ typedef enum {
 struct Transaction {
     NAND_TRANS_OP   _nTransOp;
     UINT32          _nHostTransId;          
-    UINT8           *_pData;
+    UINT8           *_pData;               // indexed by column address (data area followed by spare area).
     UINT32          *_pStatusData;
     UINT32          _nAddr;                // physical address. 
     UINT32          _nDestAddr;            // for internal data move data model
@@ -387,7 +424,9 @@ struct NandStagePacket
 
 typedef struct {
     UINT32  _nPgSize;
+    UINT32  _nSpareSize;
     UINT32  _nNumsPgPerBlk;
+    UINT32  _nNumsSlcPgPerBlk;          // usable pages of a block in SLC mode
     UINT32  _nNumsBlk;
     UINT32  _nNumsPlane;
     UINT32  _nNumsDie;